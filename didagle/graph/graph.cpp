@@ -2,15 +2,17 @@
 // All rights reserved.
 #include "didagle/graph/graph.h"
 
+#include <ctype.h>
 #include <sys/time.h>
 
 #include <iostream>
 #include <memory>
-#include <regex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <utility>
 
+#include "didagle/graph/graph_optimizer.h"
 #include "didagle/graph/vertex.h"
 #include "didagle/log/log.h"
 
@@ -48,18 +50,81 @@ Vertex* Graph::FindVertexById(const std::string& id) {
   }
   return found->second;
 }
-bool Graph::TestCircle() {
-  for (auto& pair : _nodes) {
-    Vertex* v = pair.second;
-    if (v->FindVertexInSuccessors(v)) {
-      DIDAGLE_ERROR("[{}]Found vertex:{} has circle", name, v->GetDotLable());
-      return true;
+int Graph::TopologicalSort(std::vector<Vertex*>& order, std::vector<Vertex*>& circle) const {
+  std::vector<Vertex*> all;
+  all.reserve(vertex.size() + _gen_vertex.size());
+  for (const auto& n : vertex) {
+    all.emplace_back(const_cast<Vertex*>(&n));
+  }
+  for (const auto& n : _gen_vertex) {
+    all.emplace_back(n.get());
+  }
+  std::unordered_map<const Vertex*, size_t> indegree;
+  indegree.reserve(all.size());
+  order.clear();
+  order.reserve(all.size());
+  for (Vertex* v : all) {
+    indegree[v] = v->_deps_idx.size();
+    if (v->_deps_idx.empty()) {
+      order.emplace_back(v);
     }
   }
-  return false;
+  for (size_t i = 0; i < order.size(); i++) {
+    for (Vertex* succeed : order[i]->_successor_vertex) {
+      if (0 == --indegree[succeed]) {
+        order.emplace_back(succeed);
+      }
+    }
+  }
+  if (order.size() == all.size()) {
+    return 0;
+  }
+  // every unsorted vertex has at least one unsorted dependency, walk them backward until a vertex repeats
+  Vertex* start = nullptr;
+  for (Vertex* v : all) {
+    if (indegree[v] > 0) {
+      start = v;
+      break;
+    }
+  }
+  std::unordered_map<const Vertex*, size_t> walked;
+  std::vector<Vertex*> path;
+  Vertex* current = start;
+  while (walked.find(current) == walked.end()) {
+    walked[current] = path.size();
+    path.emplace_back(current);
+    for (auto& pair : current->_deps_idx) {
+      if (indegree[pair.first] > 0) {
+        current = pair.first;
+        break;
+      }
+    }
+  }
+  circle.assign(path.rbegin(), path.rend() - walked[current]);
+  return -1;
+}
+bool Graph::TestCircle() {
+  std::vector<Vertex*> circle;
+  if (0 == TopologicalSort(_topo_order, circle)) {
+    return false;
+  }
+  std::string path;
+  for (Vertex* v : circle) {
+    path.append(v->GetDotLable()).append(" -> ");
+  }
+  path.append(circle[0]->GetDotLable());
+  DIDAGLE_ERROR("[{}]Found vertex circle:{}", name, path);
+  return true;
 }
 int Graph::Build() {
   VertexTable generated_cond_nodes;
+  _nodes.reserve(vertex.size());
+  _data_mapping_table.reserve(vertex.size());
+  VertexResumeOn graph_resume_on = V_RESUME_INLINE;
+  if (0 != parse_vertex_resume_on(resume_on, graph_resume_on)) {
+    DIDAGLE_ERROR("Invalid resume_on:{} of graph:{}", resume_on, name);
+    return -1;
+  }
 
   for (auto& n : vertex) {
     if (n.processor.empty() && !n.cond.empty()) {
@@ -83,6 +148,11 @@ int Graph::Build() {
       DIDAGLE_ERROR("Vertex:{} can NOT both config 'expect' & 'expect_config'", n.id);
       return -1;
     }
+    n._resume_on = graph_resume_on;
+    if (0 != parse_vertex_resume_on(n.resume_on, n._resume_on)) {
+      DIDAGLE_ERROR("Invalid resume_on:{} of vertex:{}", n.resume_on, n.id);
+      return -1;
+    }
     if (!n.expect_config.empty()) {
       if (!_cluster->ContainsConfigSetting(n.expect_config)) {
         DIDAGLE_ERROR("No config_setting with name:{} defined.", n.expect_config);
@@ -231,6 +301,33 @@ int Graph::DumpDot(std::string& s) {
 
 Graph::~Graph() {}
 
+// visit '$a' names in 'cond' until 'f' returns false, '$a.b' vars are always read from execute params, while
+// '$a' may be read from graph data
+template <typename Func>
+static void visit_data_referenced_names(const std::string& cond, Func&& f) {
+  size_t pos = cond.find('$');
+  while (pos != std::string::npos) {
+    size_t end = pos + 1;
+    bool multi_level = false;
+    while (end < cond.size() && (isalnum(static_cast<unsigned char>(cond[end])) || cond[end] == '_' ||
+                                 cond[end] == '.')) {
+      multi_level = multi_level || cond[end] == '.';
+      end++;
+    }
+    if (!multi_level && !f(std::string_view(cond).substr(pos + 1, end - pos - 1))) {
+      return;
+    }
+    pos = cond.find('$', end);
+  }
+}
+bool GraphCluster::IsDataReferencedCond(const std::string& cond) {
+  bool referenced = false;
+  visit_data_referenced_names(cond, [&referenced](std::string_view) {
+    referenced = true;
+    return false;
+  });
+  return referenced;
+}
 bool GraphCluster::ContainsConfigSetting(const std::string& name) {
   for (ConfigSetting& cfg : config_setting) {
     if (!name.empty() && name[0] == '!') {
@@ -291,6 +388,9 @@ int GraphCluster::Build() {
     }
   }
 
+  if (0 != inline_subgraphs(*this)) {
+    return -1;
+  }
   for (auto& f : graph) {
     // if (GetGraphManager()->GetGraphExecuteOptions().check_version &&
     //     !GetGraphManager()->GetGraphExecuteOptions().check_version(f.expect_version)) {
@@ -307,6 +407,32 @@ int GraphCluster::Build() {
       DIDAGLE_ERROR("Failed to build graph:{}", f.name);
       return -1;
     }
+    if (f.optimize && 0 != optimize_graph(f)) {
+      DIDAGLE_ERROR("Failed to optimize graph:{}", f.name);
+      return -1;
+    }
+  }
+  // lazy results are never set into graph data, config settings read as '$name' by expressions stay eager
+  std::set<std::string> data_referenced_names;
+  if (lazy_config_setting) {
+    auto collect = [&data_referenced_names](const std::string& cond) {
+      visit_data_referenced_names(cond, [&data_referenced_names](std::string_view name) {
+        data_referenced_names.emplace(name);
+        return true;
+      });
+    };
+    for (const auto& pair : _graphs) {
+      for (const auto& node : pair.second->_nodes) {
+        collect(node.second->cond);
+        collect(node.second->while_cond);
+        for (const auto& select : node.second->select_args) {
+          collect(select.match);
+        }
+      }
+    }
+    for (const ConfigSetting& cfg : config_setting) {
+      collect(cfg.cond);
+    }
   }
   for (ConfigSetting& cfg : config_setting) {
     if (cfg.processor.empty()) {
@@ -316,6 +442,14 @@ int GraphCluster::Build() {
         return -1;
       }
     }
+    cfg._lazy = lazy_config_setting && cfg.processor == default_expr_processor && !IsDataReferencedCond(cfg.cond) &&
+                data_referenced_names.count(cfg.name) == 0;
+  }
+  _trace_sampling = false;
+  for (auto& f : graph) {
+    if (f.GetTraceSampleRate() > 0 || f.GetTraceSlowThresholdMs() > 0) {
+      _trace_sampling = true;
+    }
   }
   if (strict_dsl) {
     // GraphClusterContext ctx;
@@ -332,6 +466,18 @@ int GraphCluster::Build() {
   _builded = true;
   return 0;
 }
+double Graph::GetTraceSampleRate() const {
+  if (trace_sample_rate >= 0 || nullptr == _cluster) {
+    return trace_sample_rate;
+  }
+  return _cluster->trace_sample_rate;
+}
+int64_t Graph::GetTraceSlowThresholdMs() const {
+  if (trace_slow_threshold_ms >= 0 || nullptr == _cluster) {
+    return trace_slow_threshold_ms;
+  }
+  return _cluster->trace_slow_threshold_ms;
+}
 int GraphCluster::DumpDot(std::string& s) {
   s.append("digraph G {\n");
   s.append("    rankdir=LR;\n");
@@ -342,6 +488,20 @@ int GraphCluster::DumpDot(std::string& s) {
 
   return 0;
 }
+int GraphCluster::DumpOptimizeReport(std::string& s) {
+  for (auto& f : graph) {
+    if (!f.optimize && f._optimize_actions.empty()) {
+      continue;
+    }
+    s.append("--- graph:").append(f.name).append(" vertexs:").append(std::to_string(f._nodes.size()));
+    s.append(" changes:").append(std::to_string(f._optimize_actions.size())).append("\n");
+    for (const auto& action : f._optimize_actions) {
+      s.append(action.removed ? "- [" : "~ [").append(action.pass).append("] ").append(action.vertex);
+      s.append(": ").append(action.detail).append("\n");
+    }
+  }
+  return 0;
+}
 Graph* GraphCluster::FindGraphByName(const std::string& name) {
   auto found = _graphs.find(name);
   if (found != _graphs.end()) {
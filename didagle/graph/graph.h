@@ -24,6 +24,13 @@
 namespace didagle {
 
 struct GraphCluster;
+struct GraphOptimizeAction {
+  std::string pass;
+  std::string vertex;
+  // vertex is removed, or modified otherwise
+  bool removed = false;
+  std::string detail;
+};
 struct Graph {
   std::string name;
   std::vector<Vertex> vertex;
@@ -31,16 +38,30 @@ struct Graph {
   bool gen_while_subgraph = false;
   bool early_exit_graph_if_failed = false;
   int priority = -1;
+  // event tracking sampling, negative values inherit the settings of cluster
+  double trace_sample_rate = -1;
+  int64_t trace_slow_threshold_ms = -1;
+  // run optimizer passes after build, see 'optimize_graph'
+  bool optimize = false;
+  // inline subgraph vertexs of current cluster before build, see 'inline_subgraphs'
+  bool inline_subgraph = false;
+  // default 'Vertex::resume_on' of vertexs, 'inline' if empty
+  std::string resume_on;
 
   typedef std::unordered_map<std::string, Vertex*> VertexTable;
   std::vector<std::shared_ptr<Vertex>> _gen_vertex;
   VertexTable _nodes;
   VertexTable _data_mapping_table;
+  // all vertexs in topological order, built in 'Build'
+  std::vector<Vertex*> _topo_order;
+  // changes made by optimizer passes
+  std::vector<GraphOptimizeAction> _optimize_actions;
   int64_t _idx = 0;
   GraphCluster* _cluster = nullptr;
   bool _is_gen_while_graph = false;
 
-  KCFG_TOML_DEFINE_FIELDS(name, vertex, priority, vertex_skip_as_error, gen_while_subgraph, early_exit_graph_if_failed)
+  KCFG_TOML_DEFINE_FIELDS(name, vertex, priority, vertex_skip_as_error, gen_while_subgraph, early_exit_graph_if_failed,
+                          trace_sample_rate, trace_slow_threshold_ms, optimize, inline_subgraph, resume_on)
   std::string generateNodeId();
   Vertex* geneatedCondVertex(const std::string& cond);
   Vertex* FindVertexByData(const std::string& data);
@@ -49,6 +70,13 @@ struct Graph {
   int Build();
   int DumpDot(std::string& s);
   bool TestCircle();
+  /**
+   * @brief sort all vertexs by Kahn's algorithm in O(V+E), return -1 and fill one dependency circle(ordered from
+   * dependency to successor) if the graph is not a DAG.
+   */
+  int TopologicalSort(std::vector<Vertex*>& order, std::vector<Vertex*>& circle) const;
+  double GetTraceSampleRate() const;
+  int64_t GetTraceSlowThresholdMs() const;
   ~Graph();
 };
 
@@ -60,6 +88,13 @@ struct GraphCluster {
   bool strict_dsl = true;
   std::string default_expr_processor;
   int64_t default_context_pool_size = 64;
+  // evaluate config settings which only depend on execute params lazily on first reference by 'expect_config' or
+  // select match, settings read as '$name' by expressions of the cluster are still evaluated at graph start
+  bool lazy_config_setting = false;
+  // ratio of requests with event tracking enabled, in [0, 1]
+  double trace_sample_rate = 0;
+  // keep events of unsampled requests slower than this, 0 to disable
+  int64_t trace_slow_threshold_ms = 0;
   std::vector<Graph> graph;
   std::vector<ConfigSetting> config_setting;
 
@@ -67,13 +102,20 @@ struct GraphCluster {
   typedef std::map<std::string, Graph*> GraphTable;
   GraphTable _graphs;
   bool _builded = false;
+  // any graph has event tracking sampling enabled
+  bool _trace_sampling = false;
 
-  KCFG_TOML_DEFINE_FIELDS(name, desc, strict_dsl, default_expr_processor, default_context_pool_size, graph,
-                          config_setting)
+  KCFG_TOML_DEFINE_FIELDS(name, desc, strict_dsl, default_expr_processor, default_context_pool_size,
+                          lazy_config_setting, trace_sample_rate, trace_slow_threshold_ms, graph, config_setting)
 
   int Build();
   bool ContainsConfigSetting(const std::string& name);
+  static bool IsDataReferencedCond(const std::string& cond);
   int DumpDot(std::string& s);
+  /**
+   * @brief dump changes of optimizer passes on all graphs as a diff like text.
+   */
+  int DumpOptimizeReport(std::string& s);
   Graph* FindGraphByName(const std::string& name);
   bool Exists(const std::string& graph);
   ~GraphCluster();
@@ -0,0 +1,464 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include "didagle/graph/graph_optimizer.h"
+#include <ctype.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "didagle/log/log.h"
+
+namespace didagle {
+namespace {
+static constexpr std::string_view kInlineJoinProcessor = "didagle_noop";
+
+void add_action(Graph& graph, const char* pass, const Vertex* v, bool removed, std::string detail) {
+  GraphOptimizeAction action;
+  action.pass = pass;
+  action.vertex = v->id;
+  action.removed = removed;
+  action.detail = std::move(detail);
+  graph._optimize_actions.emplace_back(std::move(action));
+}
+
+// remove a vertex which is not depended by any other vertex
+void remove_vertex(Graph& graph, Vertex* v, const char* pass, std::string detail) {
+  for (auto& pair : v->_deps_idx) {
+    pair.first->_successor_vertex.erase(v);
+  }
+  v->_deps_idx.clear();
+  v->_deps_expected_results.clear();
+  v->_disable = true;
+  graph._nodes.erase(v->id);
+  for (const auto& data : v->output) {
+    auto found = graph._data_mapping_table.find(data.id);
+    if (found != graph._data_mapping_table.end() && found->second == v) {
+      graph._data_mapping_table.erase(found);
+    }
+  }
+  add_action(graph, pass, v, true, std::move(detail));
+}
+
+// condition vertex which only produces a result, vertexs gated by their own 'expect'/'expect_config' are excluded
+// since the gate is neither in the dedup key nor carried over to successors when folded
+bool is_pure_cond_vertex(const Vertex& v) {
+  return !v.cond.empty() && v.graph.empty() && v.output.empty() && v.select_args.empty() && v.args.Size() == 0 &&
+         !v.side_effect && v.expect.empty() && v.expect_config.empty();
+}
+
+// match '$name' or '!$name'
+bool parse_config_cond(std::string_view cond, std::string& name, bool& negative) {
+  auto trim = [](std::string_view s) {
+    while (!s.empty() && isspace(static_cast<unsigned char>(s.front()))) {
+      s.remove_prefix(1);
+    }
+    while (!s.empty() && isspace(static_cast<unsigned char>(s.back()))) {
+      s.remove_suffix(1);
+    }
+    return s;
+  };
+  cond = trim(cond);
+  negative = !cond.empty() && cond[0] == '!';
+  if (negative) {
+    cond = trim(cond.substr(1));
+  }
+  if (cond.size() < 2 || cond[0] != '$') {
+    return false;
+  }
+  cond.remove_prefix(1);
+  for (char c : cond) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      return false;
+    }
+  }
+  name.assign(cond.data(), cond.size());
+  return true;
+}
+
+VertexResult get_dependency_expected(Vertex* v, Vertex* dep) {
+  int idx = v->GetDependencyIndex(dep);
+  return idx < 0 ? V_RESULT_INVALID : v->_deps_expected_results[idx];
+}
+
+void fold_config_conds(Graph& graph) {
+  GraphCluster* cluster = graph._cluster;
+  for (Vertex* v : graph._topo_order) {
+    if (v->_disable || !is_pure_cond_vertex(*v) || v->processor != cluster->default_expr_processor ||
+        v->_successor_vertex.empty()) {
+      continue;
+    }
+    std::string name;
+    bool negative = false;
+    if (!parse_config_cond(v->cond, name, negative) || !cluster->ContainsConfigSetting(name) ||
+        graph._data_mapping_table.count(name) > 0) {
+      continue;
+    }
+    // successors must be gated by the same dependencies as the condition vertex
+    bool foldable = true;
+    for (Vertex* successor : v->_successor_vertex) {
+      if (!successor->expect_config.empty()) {
+        foldable = false;
+        break;
+      }
+      for (auto& pair : v->_deps_idx) {
+        if (get_dependency_expected(successor, pair.first) != v->_deps_expected_results[pair.second]) {
+          foldable = false;
+          break;
+        }
+      }
+      if (!foldable) {
+        break;
+      }
+    }
+    if (!foldable) {
+      continue;
+    }
+    std::vector<Vertex*> successors(v->_successor_vertex.begin(), v->_successor_vertex.end());
+    for (Vertex* successor : successors) {
+      VertexResult expected = get_dependency_expected(successor, v);
+      if (V_RESULT_OK == expected) {
+        successor->expect_config = negative ? "!" + name : name;
+      } else if (V_RESULT_ERR == expected) {
+        successor->expect_config = negative ? name : "!" + name;
+      }
+      successor->RemoveDependency(v);
+      add_action(graph, "config_fold", successor, false,
+                 fmt::format("dependency on '{}' -> expect_config='{}'", v->cond, successor->expect_config));
+    }
+    remove_vertex(graph, v, "config_fold", fmt::format("cond '{}' folded into successors", v->cond));
+  }
+}
+
+void dedup_conds(Graph& graph) {
+  std::unordered_map<std::string, Vertex*> conds;
+  for (Vertex* v : graph._topo_order) {
+    if (v->_disable || !is_pure_cond_vertex(*v)) {
+      continue;
+    }
+    std::vector<std::pair<uintptr_t, int>> deps;
+    for (auto& pair : v->_deps_idx) {
+      deps.emplace_back(reinterpret_cast<uintptr_t>(pair.first), v->_deps_expected_results[pair.second]);
+    }
+    std::sort(deps.begin(), deps.end());
+    std::string key = v->processor;
+    key.append(1, '\0').append(v->cond);
+    for (const auto& dep : deps) {
+      key.append(1, '\0').append(std::to_string(dep.first)).append(":").append(std::to_string(dep.second));
+    }
+    auto [found, inserted] = conds.emplace(std::move(key), v);
+    if (inserted) {
+      continue;
+    }
+    Vertex* keep = found->second;
+    bool mergeable = true;
+    for (Vertex* successor : v->_successor_vertex) {
+      VertexResult keep_expected = get_dependency_expected(successor, keep);
+      if (V_RESULT_INVALID != keep_expected && keep_expected != get_dependency_expected(successor, v)) {
+        mergeable = false;
+        break;
+      }
+    }
+    if (!mergeable) {
+      continue;
+    }
+    std::vector<Vertex*> successors(v->_successor_vertex.begin(), v->_successor_vertex.end());
+    for (Vertex* successor : successors) {
+      if (successor->GetDependencyIndex(keep) >= 0) {
+        successor->RemoveDependency(v);
+      } else {
+        successor->ReplaceDependency(v, keep);
+      }
+      add_action(graph, "cond_dedup", successor, false, fmt::format("dependency on '{}' -> '{}'", v->id, keep->id));
+    }
+    remove_vertex(graph, v, "cond_dedup", fmt::format("same cond '{}' as '{}'", v->cond, keep->id));
+  }
+}
+
+void remove_dead_vertexs(Graph& graph) {
+  // declared outputs may be read by the caller or a parent graph after execution, vertexs with outputs are roots
+  for (auto it = graph._topo_order.rbegin(); it != graph._topo_order.rend(); ++it) {
+    Vertex* v = *it;
+    if (v->_disable || !v->_successor_vertex.empty() || !v->output.empty() || v->side_effect ||
+        !v->graph.empty() || !v->while_cond.empty() || v->early_exit_graph_if_failed ||
+        !v->ignore_processor_execute_error) {
+      continue;
+    }
+    remove_vertex(graph, v, "dead_vertex", "no outputs & no successors");
+  }
+}
+std::string get_data_id(const GraphData& data) { return data.id.empty() ? data.field : data.id; }
+
+// the id assigned by 'Graph::Build' if not configured
+std::string get_dsl_vertex_id(const GraphCluster& cluster, const Vertex& v) {
+  if (!v.id.empty()) {
+    return v.id;
+  }
+  if (!v.processor.empty()) {
+    return v.processor;
+  }
+  if (!v.cond.empty()) {
+    return cluster.default_expr_processor;
+  }
+  return "";
+}
+
+const Graph* find_dsl_graph(const GraphCluster& cluster, const std::string& name) {
+  const Graph* found = nullptr;
+  for (const auto& g : cluster.graph) {
+    if (g.name == name && (nullptr == found || g.priority > found->priority)) {
+      found = &g;
+    }
+  }
+  return found;
+}
+
+bool is_inlinable_vertex(const GraphCluster& cluster, const Vertex& v) {
+  return !v.graph.empty() && v.while_cond.empty() && !v.id.empty() &&
+         (v.cluster.empty() || v.cluster == "." || v.cluster == cluster._name) && v.args.Size() == 0 &&
+         v.select_args.empty() && v.input.empty() && v.output.empty();
+}
+
+bool is_inlinable_graph(const Graph& parent, const Graph& sub) {
+  if (sub._is_gen_while_graph || sub.early_exit_graph_if_failed || sub.vertex.empty() ||
+      sub.vertex_skip_as_error != parent.vertex_skip_as_error) {
+    return false;
+  }
+  for (const auto& v : sub.vertex) {
+    if (v.early_exit_graph_if_failed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// expressions may refer data by name
+void collect_cond_texts(const Vertex& v, std::string& texts) {
+  texts.append(v.cond).append("\n").append(v.expect).append("\n").append(v.expect_config).append("\n");
+  texts.append(v.while_cond).append("\n");
+  for (const auto& select : v.select_args) {
+    texts.append(select.match).append("\n");
+  }
+}
+
+void collect_inputs(const Vertex& v, std::set<std::string>& consumed) {
+  for (const auto& data : v.input) {
+    consumed.insert(get_data_id(data));
+    consumed.insert(data.aggregate.begin(), data.aggregate.end());
+    if (!data.move_from_when_skipped.empty()) {
+      consumed.insert(data.move_from_when_skipped);
+    }
+  }
+}
+
+bool rename_inlined_vertexs(const GraphCluster& cluster, const std::string& prefix,
+                            const std::set<std::string>& produced, const std::set<std::string>& consumed,
+                            const std::string& texts, std::vector<Vertex>& inner) {
+  std::string inner_texts;
+  for (const auto& v : inner) {
+    collect_cond_texts(v, inner_texts);
+  }
+  std::unordered_map<std::string, std::string> data_names;
+  for (const auto& v : inner) {
+    for (const auto& data : v.output) {
+      std::string id = get_data_id(data);
+      if (produced.count(id) == 0) {
+        continue;
+      }
+      if (consumed.count(id) > 0 || texts.find(id) != std::string::npos ||
+          inner_texts.find(id) != std::string::npos) {
+        DIDAGLE_DEBUG("Can NOT rename data:{} of inlined vertexs:{}", id, prefix);
+        return false;
+      }
+      data_names[id] = prefix + id;
+    }
+  }
+  std::unordered_map<std::string, std::string> ids;
+  for (size_t i = 0; i < inner.size(); i++) {
+    Vertex& v = inner[i];
+    std::string id = get_dsl_vertex_id(cluster, v);
+    v.id = prefix + (id.empty() ? "__vertex_" + std::to_string(i) : id);
+    if (!id.empty()) {
+      ids[id] = v.id;
+    }
+  }
+  auto rename_ids = [&ids](std::set<std::string>& names) {
+    std::set<std::string> renamed;
+    for (const auto& name : names) {
+      auto found = ids.find(name);
+      renamed.insert(found == ids.end() ? name : found->second);
+    }
+    names.swap(renamed);
+  };
+  auto rename_data = [&data_names](std::string& name) {
+    auto found = data_names.find(name);
+    if (found != data_names.end()) {
+      name = found->second;
+    }
+  };
+  for (auto& v : inner) {
+    for (auto* names : {&v.successor, &v.successor_on_ok, &v.successor_on_err, &v.consequent, &v.alternative,
+                        &v.deps, &v.deps_on_ok, &v.deps_on_err, &v.expect_deps}) {
+      rename_ids(*names);
+    }
+    for (auto* datas : {&v.input, &v.output}) {
+      for (auto& data : *datas) {
+        std::string id = get_data_id(data);
+        rename_data(id);
+        if (id != get_data_id(data)) {
+          data.id = id;
+        }
+        for (auto& aggregate_id : data.aggregate) {
+          rename_data(aggregate_id);
+        }
+        rename_data(data.move_from_when_skipped);
+      }
+    }
+    v.is_start = false;
+  }
+  return true;
+}
+
+void expand_subgraphs(const GraphCluster& cluster, const Graph& g, std::set<std::string>& visiting,
+                      std::vector<Vertex>& vertexs, std::vector<GraphOptimizeAction>* actions) {
+  // inputs & outputs declared by processor metas are needed to check data conflicts
+  std::vector<Vertex> sources = g.vertex;
+  for (auto& v : sources) {
+    v.FillInputOutput();
+  }
+  std::set<std::string> produced;
+  std::set<std::string> consumed;
+  std::string texts;
+  for (const auto& v : sources) {
+    for (const auto& data : v.output) {
+      produced.insert(get_data_id(data));
+    }
+    collect_inputs(v, consumed);
+    collect_cond_texts(v, texts);
+  }
+  // inlined vertex id -> id of its enter vertex
+  std::map<std::string, std::string> entries;
+  for (auto& v : sources) {
+    const Graph* sub = is_inlinable_vertex(cluster, v) ? find_dsl_graph(cluster, v.graph) : nullptr;
+    if (nullptr == sub || visiting.count(sub->name) > 0 || !is_inlinable_graph(g, *sub)) {
+      vertexs.emplace_back(std::move(v));
+      continue;
+    }
+    std::vector<Vertex> inner;
+    visiting.insert(sub->name);
+    expand_subgraphs(cluster, *sub, visiting, inner, nullptr);
+    visiting.erase(sub->name);
+    if (!rename_inlined_vertexs(cluster, v.id + "__", produced, consumed, texts, inner)) {
+      vertexs.emplace_back(std::move(v));
+      continue;
+    }
+    std::set<std::string> inner_produced;
+    for (const auto& inlined : inner) {
+      for (const auto& data : inlined.output) {
+        inner_produced.insert(get_data_id(data));
+      }
+    }
+    for (const auto& inlined : inner) {
+      // extern data read by inlined vertexs must not be renamed later
+      std::set<std::string> inputs;
+      collect_inputs(inlined, inputs);
+      for (const auto& id : inputs) {
+        if (inner_produced.count(id) == 0) {
+          consumed.insert(id);
+        }
+      }
+    }
+    produced.insert(inner_produced.begin(), inner_produced.end());
+
+    Vertex enter;
+    enter.id = v.id + "__ENTER__";
+    enter.processor = kInlineJoinProcessor;
+    enter.is_start = v.is_start;
+    enter.expect = v.expect;
+    enter.expect_deps = v.expect_deps;
+    enter.expect_config = v.expect_config;
+    enter.deps = v.deps;
+    enter.deps_on_ok = v.deps_on_ok;
+    enter.deps_on_err = v.deps_on_err;
+
+    Vertex join = v;
+    join.processor = kInlineJoinProcessor;
+    join.cluster.clear();
+    join.graph.clear();
+    join.is_start = false;
+    join.expect.clear();
+    join.expect_deps.clear();
+    join.expect_config.clear();
+    join.deps.clear();
+    join.deps_on_err.clear();
+    join.deps_on_ok = {enter.id};
+    for (auto& inlined : inner) {
+      if (inlined.resume_on.empty()) {
+        inlined.resume_on = sub->resume_on;
+      }
+      inlined.deps_on_ok.insert(enter.id);
+      join.deps.insert(inlined.id);
+    }
+    if (nullptr != actions) {
+      GraphOptimizeAction action;
+      action.pass = "inline_subgraph";
+      action.vertex = v.id;
+      action.detail = fmt::format("inlined graph '{}' with {} vertexs", sub->name, inner.size());
+      actions->emplace_back(std::move(action));
+    }
+    entries[v.id] = enter.id;
+    vertexs.emplace_back(std::move(enter));
+    std::move(inner.begin(), inner.end(), std::back_inserter(vertexs));
+    vertexs.emplace_back(std::move(join));
+  }
+  // edges declared by predecessors('successor'/'if'/'else') must start the inlined vertexs instead of the join
+  for (auto& v : vertexs) {
+    for (const auto& [id, enter_id] : entries) {
+      if (v.id == id || v.id.rfind(id + "__", 0) == 0) {
+        continue;
+      }
+      for (auto* names :
+           {&v.successor, &v.successor_on_ok, &v.successor_on_err, &v.consequent, &v.alternative}) {
+        if (names->erase(id) > 0) {
+          names->insert(enter_id);
+        }
+      }
+    }
+  }
+}
+}  // namespace
+
+int optimize_graph(Graph& graph) {
+  if (nullptr == graph._cluster || graph._topo_order.empty()) {
+    DIDAGLE_ERROR("Graph:{} must be built before optimized.", graph.name);
+    return -1;
+  }
+  fold_config_conds(graph);
+  dedup_conds(graph);
+  remove_dead_vertexs(graph);
+  graph._topo_order.erase(
+      std::remove_if(graph._topo_order.begin(), graph._topo_order.end(), [](const Vertex* v) { return v->_disable; }),
+      graph._topo_order.end());
+  return 0;
+}
+
+int inline_subgraphs(GraphCluster& cluster) {
+  for (auto& g : cluster.graph) {
+    if (!g.inline_subgraph) {
+      continue;
+    }
+    std::set<std::string> visiting = {g.name};
+    std::vector<Vertex> vertexs;
+    expand_subgraphs(cluster, g, visiting, vertexs, &g._optimize_actions);
+    g.vertex = std::move(vertexs);
+  }
+  return 0;
+}
+
+}  // namespace didagle
@@ -0,0 +1,35 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#pragma once
+
+#include "didagle/graph/graph.h"
+
+namespace didagle {
+
+/**
+ * @brief Optimize a built graph in place, enabled by 'optimize = true' in graph dsl. Passes run in order:
+ *  - config_fold: a condition vertex evaluating only a config_setting('$name' or '!$name') is replaced by
+ *    'expect_config' on its successors, if they already share all dependencies of the condition vertex.
+ *  - cond_dedup: condition vertexs with the same processor, cond & dependencies are merged into one.
+ *  - dead_vertex: vertexs declaring no output that nothing depends on are removed unless marked 'side_effect'
+ *    or running a subgraph, vertexs with outputs are kept since outputs may be read after execution.
+ * Removed vertexs are marked '_disable' & dropped from '_nodes', every change is appended into
+ * 'Graph::_optimize_actions'.
+ */
+int optimize_graph(Graph& graph);
+
+/**
+ * @brief Inline subgraph vertexs into graphs with 'inline_subgraph = true' before build, nested subgraphs are
+ * inlined recursively. A subgraph vertex 'x' running graph 'g' of current cluster is replaced by:
+ *  - 'x__ENTER__': a noop vertex with all dependencies & expects of 'x';
+ *  - copies of vertexs in 'g' with ids prefixed by 'x__', each depending on 'x__ENTER__' with ok result;
+ *  - 'x': a noop vertex depending on all copies, successors of 'x' are kept unchanged.
+ * 'successor'/'if'/'else' edges of other vertexs naming 'x' are retargeted to 'x__ENTER__'.
+ * Copies share the data context of the graph, so extern inputs & outputs of the subgraph become ordinary data
+ * dependencies, output data conflicting with the graph is renamed with the same prefix if only read inside
+ * the subgraph. Subgraph vertexs with args/select_args/input/output, in other clusters, or running graphs with
+ * early exit or different 'vertex_skip_as_error' are kept as runtime subgraphs.
+ */
+int inline_subgraphs(GraphCluster& cluster);
+
+}  // namespace didagle
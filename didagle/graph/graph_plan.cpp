@@ -0,0 +1,679 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include "didagle/graph/graph_plan.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "didagle/log/log.h"
+
+namespace didagle {
+namespace {
+constexpr char kPlanMagic[8] = {'D', 'I', 'D', 'A', 'G', 'P', 'L', 'N'};
+constexpr uint32_t kPlanAlign = 8;
+
+enum PlanSection {
+  PLAN_STRING = 0,
+  PLAN_STRING_BLOB,
+  PLAN_CLUSTER,
+  PLAN_CONFIG,
+  PLAN_GRAPH,
+  PLAN_VERTEX,
+  PLAN_EDGE,
+  PLAN_DATA,
+  PLAN_AGGREGATE,
+  PLAN_SELECT,
+  PLAN_PARAMS,
+  PLAN_SECTION_NUM,
+};
+
+// 'count' is the number of records, or bytes for blob sections
+struct PlanSectionRange {
+  uint64_t offset;
+  uint64_t count;
+};
+struct PlanHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_size;
+  uint64_t size;
+  // FNV-1a of all bytes after the header
+  uint64_t checksum;
+  PlanSectionRange sections[PLAN_SECTION_NUM];
+};
+struct PlanRange {
+  uint32_t begin;
+  uint32_t count;
+};
+struct PlanString {
+  uint64_t offset;
+  uint32_t len;
+  uint32_t reserved;
+};
+
+enum PlanClusterFlag {
+  PLAN_CLUSTER_STRICT_DSL = 1,
+  PLAN_CLUSTER_LAZY_CONFIG_SETTING = 2,
+};
+// flag bits known by this version, any other bit means the plan is written by a newer compiler
+constexpr uint32_t kPlanClusterFlagMask = PLAN_CLUSTER_STRICT_DSL | PLAN_CLUSTER_LAZY_CONFIG_SETTING;
+struct PlanCluster {
+  uint32_t name;
+  uint32_t key;
+  uint32_t desc;
+  uint32_t default_expr_processor;
+  uint32_t flags;
+  uint32_t reserved;
+  int64_t default_context_pool_size;
+  double trace_sample_rate;
+  int64_t trace_slow_threshold_ms;
+  PlanRange graphs;
+  PlanRange configs;
+};
+struct PlanConfig {
+  uint32_t name;
+  uint32_t cond;
+  uint32_t processor;
+  uint32_t reserved;
+};
+
+enum PlanGraphFlag {
+  PLAN_GRAPH_VERTEX_SKIP_AS_ERROR = 1,
+  PLAN_GRAPH_GEN_WHILE_SUBGRAPH = 2,
+  PLAN_GRAPH_EARLY_EXIT_IF_FAILED = 4,
+  PLAN_GRAPH_OPTIMIZE = 8,
+  PLAN_GRAPH_INLINE_SUBGRAPH = 16,
+};
+constexpr uint32_t kPlanGraphFlagMask = PLAN_GRAPH_VERTEX_SKIP_AS_ERROR | PLAN_GRAPH_GEN_WHILE_SUBGRAPH |
+                                        PLAN_GRAPH_EARLY_EXIT_IF_FAILED | PLAN_GRAPH_OPTIMIZE |
+                                        PLAN_GRAPH_INLINE_SUBGRAPH;
+struct PlanGraph {
+  uint32_t name;
+  uint32_t flags;
+  int32_t priority;
+  uint32_t resume_on;
+  double trace_sample_rate;
+  int64_t trace_slow_threshold_ms;
+  PlanRange vertexs;
+};
+
+// edges are the declared dependency/successor ids of vertex, grouped by vertex(CSR)
+enum PlanEdgeKind {
+  PLAN_EDGE_EXPECT_DEPS = 0,
+  PLAN_EDGE_SUCCESSOR,
+  PLAN_EDGE_SUCCESSOR_ON_OK,
+  PLAN_EDGE_SUCCESSOR_ON_ERR,
+  PLAN_EDGE_CONSEQUENT,
+  PLAN_EDGE_ALTERNATIVE,
+  PLAN_EDGE_DEPS,
+  PLAN_EDGE_DEPS_ON_OK,
+  PLAN_EDGE_DEPS_ON_ERR,
+  PLAN_EDGE_KIND_NUM,
+};
+struct PlanEdge {
+  uint32_t kind;
+  uint32_t target;
+};
+
+enum PlanVertexFlag {
+  PLAN_VERTEX_START = 1,
+  PLAN_VERTEX_WHILE_ASYNC = 2,
+  PLAN_VERTEX_IGNORE_EXECUTE_ERROR = 4,
+  PLAN_VERTEX_EARLY_EXIT_IF_FAILED = 8,
+  PLAN_VERTEX_SIDE_EFFECT = 16,
+};
+constexpr uint32_t kPlanVertexFlagMask = PLAN_VERTEX_START | PLAN_VERTEX_WHILE_ASYNC |
+                                         PLAN_VERTEX_IGNORE_EXECUTE_ERROR | PLAN_VERTEX_EARLY_EXIT_IF_FAILED |
+                                         PLAN_VERTEX_SIDE_EFFECT;
+struct PlanVertex {
+  uint32_t id;
+  uint32_t processor;
+  uint32_t cond;
+  uint32_t expect;
+  uint32_t expect_config;
+  uint32_t cluster;
+  uint32_t graph;
+  uint32_t while_cond;
+  uint32_t flags;
+  uint32_t resume_on;
+  PlanRange edges;
+  PlanRange inputs;
+  PlanRange outputs;
+  PlanRange selects;
+  // offset in params blob
+  uint64_t args;
+};
+
+enum PlanDataFlag {
+  PLAN_DATA_REQUIRED = 1,
+  PLAN_DATA_MOVE = 2,
+  PLAN_DATA_EXTERN = 4,
+  PLAN_DATA_IN_OUT = 8,
+};
+constexpr uint32_t kPlanDataFlagMask = PLAN_DATA_REQUIRED | PLAN_DATA_MOVE | PLAN_DATA_EXTERN | PLAN_DATA_IN_OUT;
+struct PlanData {
+  uint32_t id;
+  uint32_t field;
+  uint32_t move_from_when_skipped;
+  uint32_t flags;
+  PlanRange aggregate;
+};
+struct PlanSelect {
+  uint32_t match;
+  uint32_t inherit_default;
+  uint64_t args;
+};
+
+uint64_t plan_checksum(const char* data, size_t len) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::set<std::string>* get_vertex_edges(Vertex& v, uint32_t kind) {
+  switch (kind) {
+    case PLAN_EDGE_EXPECT_DEPS:
+      return &v.expect_deps;
+    case PLAN_EDGE_SUCCESSOR:
+      return &v.successor;
+    case PLAN_EDGE_SUCCESSOR_ON_OK:
+      return &v.successor_on_ok;
+    case PLAN_EDGE_SUCCESSOR_ON_ERR:
+      return &v.successor_on_err;
+    case PLAN_EDGE_CONSEQUENT:
+      return &v.consequent;
+    case PLAN_EDGE_ALTERNATIVE:
+      return &v.alternative;
+    case PLAN_EDGE_DEPS:
+      return &v.deps;
+    case PLAN_EDGE_DEPS_ON_OK:
+      return &v.deps_on_ok;
+    case PLAN_EDGE_DEPS_ON_ERR:
+      return &v.deps_on_err;
+    default:
+      return nullptr;
+  }
+}
+
+class PlanWriter {
+ public:
+  int AddCluster(const GraphCluster& cluster) {
+    if (cluster._builded) {
+      DIDAGLE_ERROR("Can NOT write built cluster:{} into graph plan.", cluster._name);
+      return -1;
+    }
+    PlanCluster c = {};
+    c.name = Intern(cluster.name);
+    c.key = Intern(cluster._name.empty() ? cluster.name : cluster._name);
+    c.desc = Intern(cluster.desc);
+    c.default_expr_processor = Intern(cluster.default_expr_processor);
+    c.flags = (cluster.strict_dsl ? PLAN_CLUSTER_STRICT_DSL : 0) |
+              (cluster.lazy_config_setting ? PLAN_CLUSTER_LAZY_CONFIG_SETTING : 0);
+    c.default_context_pool_size = cluster.default_context_pool_size;
+    c.trace_sample_rate = cluster.trace_sample_rate;
+    c.trace_slow_threshold_ms = cluster.trace_slow_threshold_ms;
+    c.graphs = {static_cast<uint32_t>(_graphs.size()), static_cast<uint32_t>(cluster.graph.size())};
+    c.configs = {static_cast<uint32_t>(_configs.size()), static_cast<uint32_t>(cluster.config_setting.size())};
+    for (const ConfigSetting& cfg : cluster.config_setting) {
+      _configs.emplace_back(PlanConfig{Intern(cfg.name), Intern(cfg.cond), Intern(cfg.processor), 0});
+    }
+    for (const Graph& graph : cluster.graph) {
+      AddGraph(graph);
+    }
+    _clusters.emplace_back(c);
+    return 0;
+  }
+
+  void Write(std::string& buf) {
+    PlanHeader header = {};
+    memcpy(header.magic, kPlanMagic, sizeof(kPlanMagic));
+    header.version = kGraphPlanVersion;
+    header.header_size = sizeof(PlanHeader);
+    buf.assign(sizeof(PlanHeader), '\0');
+
+    std::vector<PlanString> strings;
+    std::string blob;
+    strings.reserve(_strings.size());
+    for (const std::string* s : _strings) {
+      strings.emplace_back(PlanString{blob.size(), static_cast<uint32_t>(s->size()), 0});
+      blob.append(*s);
+    }
+    AppendSection(buf, header, PLAN_STRING, strings);
+    AppendBlob(buf, header, PLAN_STRING_BLOB, blob);
+    AppendSection(buf, header, PLAN_CLUSTER, _clusters);
+    AppendSection(buf, header, PLAN_CONFIG, _configs);
+    AppendSection(buf, header, PLAN_GRAPH, _graphs);
+    AppendSection(buf, header, PLAN_VERTEX, _vertexs);
+    AppendSection(buf, header, PLAN_EDGE, _edges);
+    AppendSection(buf, header, PLAN_DATA, _datas);
+    AppendSection(buf, header, PLAN_AGGREGATE, _aggregates);
+    AppendSection(buf, header, PLAN_SELECT, _selects);
+    AppendBlob(buf, header, PLAN_PARAMS, _params);
+
+    header.size = buf.size();
+    header.checksum = plan_checksum(buf.data() + sizeof(PlanHeader), buf.size() - sizeof(PlanHeader));
+    memcpy(&buf[0], &header, sizeof(header));
+  }
+
+ private:
+  uint32_t Intern(const std::string& s) {
+    auto found = _string_ids.find(s);
+    if (found != _string_ids.end()) {
+      return found->second;
+    }
+    uint32_t id = static_cast<uint32_t>(_strings.size());
+    auto result = _string_ids.emplace(s, id);
+    _strings.emplace_back(&result.first->first);
+    return id;
+  }
+  uint64_t AddParams(const Params& params) {
+    uint64_t offset = _params.size();
+    params.AppendBinary(_params);
+    return offset;
+  }
+  PlanRange AddDatas(const std::vector<GraphData>& datas) {
+    PlanRange range = {static_cast<uint32_t>(_datas.size()), static_cast<uint32_t>(datas.size())};
+    for (const GraphData& data : datas) {
+      PlanData d = {};
+      d.id = Intern(data.id);
+      d.field = Intern(data.field);
+      d.move_from_when_skipped = Intern(data.move_from_when_skipped);
+      d.flags = (data.required ? PLAN_DATA_REQUIRED : 0) | (data.move ? PLAN_DATA_MOVE : 0) |
+                (data.is_extern ? PLAN_DATA_EXTERN : 0) | (data._is_in_out ? PLAN_DATA_IN_OUT : 0);
+      d.aggregate = {static_cast<uint32_t>(_aggregates.size()), static_cast<uint32_t>(data.aggregate.size())};
+      for (const std::string& id : data.aggregate) {
+        _aggregates.emplace_back(Intern(id));
+      }
+      _datas.emplace_back(d);
+    }
+    return range;
+  }
+  void AddGraph(const Graph& graph) {
+    PlanGraph g = {};
+    g.name = Intern(graph.name);
+    g.flags = (graph.vertex_skip_as_error ? PLAN_GRAPH_VERTEX_SKIP_AS_ERROR : 0) |
+              (graph.gen_while_subgraph ? PLAN_GRAPH_GEN_WHILE_SUBGRAPH : 0) |
+              (graph.early_exit_graph_if_failed ? PLAN_GRAPH_EARLY_EXIT_IF_FAILED : 0) |
+              (graph.optimize ? PLAN_GRAPH_OPTIMIZE : 0) | (graph.inline_subgraph ? PLAN_GRAPH_INLINE_SUBGRAPH : 0);
+    g.priority = graph.priority;
+    g.resume_on = Intern(graph.resume_on);
+    g.trace_sample_rate = graph.trace_sample_rate;
+    g.trace_slow_threshold_ms = graph.trace_slow_threshold_ms;
+    g.vertexs = {static_cast<uint32_t>(_vertexs.size()), static_cast<uint32_t>(graph.vertex.size())};
+    for (const Vertex& vertex : graph.vertex) {
+      AddVertex(vertex);
+    }
+    _graphs.emplace_back(g);
+  }
+  void AddVertex(const Vertex& vertex) {
+    PlanVertex v = {};
+    v.id = Intern(vertex.id);
+    v.processor = Intern(vertex.processor);
+    v.cond = Intern(vertex.cond);
+    v.expect = Intern(vertex.expect);
+    v.expect_config = Intern(vertex.expect_config);
+    v.cluster = Intern(vertex.cluster);
+    v.graph = Intern(vertex.graph);
+    v.while_cond = Intern(vertex.while_cond);
+    v.resume_on = Intern(vertex.resume_on);
+    v.flags = (vertex.is_start ? PLAN_VERTEX_START : 0) | (vertex.while_async ? PLAN_VERTEX_WHILE_ASYNC : 0) |
+              (vertex.ignore_processor_execute_error ? PLAN_VERTEX_IGNORE_EXECUTE_ERROR : 0) |
+              (vertex.early_exit_graph_if_failed ? PLAN_VERTEX_EARLY_EXIT_IF_FAILED : 0) |
+              (vertex.side_effect ? PLAN_VERTEX_SIDE_EFFECT : 0);
+    v.edges.begin = static_cast<uint32_t>(_edges.size());
+    for (uint32_t kind = 0; kind < PLAN_EDGE_KIND_NUM; kind++) {
+      for (const std::string& id : *get_vertex_edges(const_cast<Vertex&>(vertex), kind)) {
+        _edges.emplace_back(PlanEdge{kind, Intern(id)});
+      }
+    }
+    v.edges.count = static_cast<uint32_t>(_edges.size()) - v.edges.begin;
+    v.inputs = AddDatas(vertex.input);
+    v.outputs = AddDatas(vertex.output);
+    v.selects = {static_cast<uint32_t>(_selects.size()), static_cast<uint32_t>(vertex.select_args.size())};
+    for (const CondParams& select : vertex.select_args) {
+      _selects.emplace_back(PlanSelect{Intern(select.match), select.inherit_default ? 1u : 0u, AddParams(select.args)});
+    }
+    v.args = AddParams(vertex.args);
+    _vertexs.emplace_back(v);
+  }
+
+  static void Align(std::string& buf) {
+    buf.resize((buf.size() + kPlanAlign - 1) / kPlanAlign * kPlanAlign, '\0');
+  }
+  template <typename T>
+  static void AppendSection(std::string& buf, PlanHeader& header, PlanSection section, const std::vector<T>& records) {
+    Align(buf);
+    header.sections[section] = {buf.size(), records.size()};
+    buf.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+  }
+  static void AppendBlob(std::string& buf, PlanHeader& header, PlanSection section, const std::string& blob) {
+    Align(buf);
+    header.sections[section] = {buf.size(), blob.size()};
+    buf.append(blob);
+  }
+
+  std::unordered_map<std::string, uint32_t> _string_ids;
+  std::vector<const std::string*> _strings;
+  std::vector<PlanCluster> _clusters;
+  std::vector<PlanConfig> _configs;
+  std::vector<PlanGraph> _graphs;
+  std::vector<PlanVertex> _vertexs;
+  std::vector<PlanEdge> _edges;
+  std::vector<PlanData> _datas;
+  std::vector<uint32_t> _aggregates;
+  std::vector<PlanSelect> _selects;
+  std::string _params;
+};
+
+constexpr size_t kPlanRecordSize[PLAN_SECTION_NUM] = {
+    sizeof(PlanString), 1, sizeof(PlanCluster), sizeof(PlanConfig), sizeof(PlanGraph), sizeof(PlanVertex),
+    sizeof(PlanEdge), sizeof(PlanData), sizeof(uint32_t), sizeof(PlanSelect), 1,
+};
+}  // namespace
+
+int write_graph_plan(const std::vector<const GraphCluster*>& clusters, std::string& buf) {
+  PlanWriter writer;
+  for (const GraphCluster* cluster : clusters) {
+    if (0 != writer.AddCluster(*cluster)) {
+      return -1;
+    }
+  }
+  writer.Write(buf);
+  return 0;
+}
+int write_graph_plan_file(const std::vector<const GraphCluster*>& clusters, const std::string& file) {
+  std::string buf;
+  if (0 != write_graph_plan(clusters, buf)) {
+    return -1;
+  }
+  // write into a temp file then rename, so that running processes never map a partial plan
+  std::string tmp = file + ".tmp";
+  FILE* fp = fopen(tmp.c_str(), "wb");
+  if (nullptr == fp) {
+    DIDAGLE_ERROR("Failed to open graph plan file:{}", tmp);
+    return -1;
+  }
+  size_t n = fwrite(buf.data(), 1, buf.size(), fp);
+  int rc = fclose(fp);
+  if (n != buf.size() || 0 != rc || 0 != rename(tmp.c_str(), file.c_str())) {
+    DIDAGLE_ERROR("Failed to write graph plan file:{}", file);
+    unlink(tmp.c_str());
+    return -1;
+  }
+  return 0;
+}
+
+std::unique_ptr<GraphPlan> GraphPlan::Load(const std::string& file) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    DIDAGLE_ERROR("Failed to open graph plan file:{}", file);
+    return nullptr;
+  }
+  struct stat st;
+  if (0 != fstat(fd, &st) || st.st_size <= 0) {
+    DIDAGLE_ERROR("Invalid graph plan file:{}", file);
+    close(fd);
+    return nullptr;
+  }
+  void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (MAP_FAILED == addr) {
+    DIDAGLE_ERROR("Failed to mmap graph plan file:{}", file);
+    return nullptr;
+  }
+  std::unique_ptr<GraphPlan> plan(new GraphPlan);
+  plan->_mmap = addr;
+  plan->_data = static_cast<const char*>(addr);
+  plan->_size = st.st_size;
+  if (0 != plan->Verify()) {
+    DIDAGLE_ERROR("Invalid graph plan file:{}", file);
+    return nullptr;
+  }
+  return plan;
+}
+std::unique_ptr<GraphPlan> GraphPlan::LoadBuffer(std::string_view content) {
+  std::unique_ptr<GraphPlan> plan(new GraphPlan);
+  // std::string storage is aligned enough for all plan records
+  plan->_buffer.assign(content.data(), content.size());
+  plan->_data = plan->_buffer.data();
+  plan->_size = plan->_buffer.size();
+  if (0 != plan->Verify()) {
+    return nullptr;
+  }
+  return plan;
+}
+GraphPlan::~GraphPlan() {
+  if (nullptr != _mmap) {
+    munmap(_mmap, _size);
+  }
+}
+
+int GraphPlan::Verify() {
+  if (_size < sizeof(PlanHeader)) {
+    DIDAGLE_ERROR("Too small graph plan size:{}", _size);
+    return -1;
+  }
+  const PlanHeader* header = reinterpret_cast<const PlanHeader*>(_data);
+  if (0 != memcmp(header->magic, kPlanMagic, sizeof(kPlanMagic))) {
+    DIDAGLE_ERROR("Invalid graph plan magic.");
+    return -1;
+  }
+  if (header->version != kGraphPlanVersion || header->header_size != sizeof(PlanHeader)) {
+    DIDAGLE_ERROR("Mismatch graph plan version:{}, expected:{}", header->version, kGraphPlanVersion);
+    return -1;
+  }
+  if (header->size != _size) {
+    DIDAGLE_ERROR("Truncated graph plan with size:{}, expected:{}", _size, header->size);
+    return -1;
+  }
+  if (header->checksum != plan_checksum(_data + sizeof(PlanHeader), _size - sizeof(PlanHeader))) {
+    DIDAGLE_ERROR("Mismatch graph plan checksum.");
+    return -1;
+  }
+  for (int i = 0; i < PLAN_SECTION_NUM; i++) {
+    const PlanSectionRange& range = header->sections[i];
+    if (range.offset < sizeof(PlanHeader) || range.offset % kPlanAlign != 0 || range.offset > _size ||
+        range.count > (_size - range.offset) / kPlanRecordSize[i]) {
+      DIDAGLE_ERROR("Invalid graph plan section:{}", i);
+      return -1;
+    }
+  }
+  const PlanString* strings = GetSection<PlanString>(PLAN_STRING);
+  uint64_t blob_size = header->sections[PLAN_STRING_BLOB].count;
+  for (uint64_t i = 0; i < header->sections[PLAN_STRING].count; i++) {
+    if (strings[i].offset > blob_size || strings[i].len > blob_size - strings[i].offset) {
+      DIDAGLE_ERROR("Invalid graph plan string:{}", i);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+template <typename T>
+const T* GraphPlan::GetSection(int section) const {
+  const PlanHeader* header = reinterpret_cast<const PlanHeader*>(_data);
+  return reinterpret_cast<const T*>(_data + header->sections[section].offset);
+}
+
+std::string_view GraphPlan::GetString(uint32_t id) const {
+  const PlanHeader* header = reinterpret_cast<const PlanHeader*>(_data);
+  if (id >= header->sections[PLAN_STRING].count) {
+    return {};
+  }
+  const PlanString& s = GetSection<PlanString>(PLAN_STRING)[id];
+  return std::string_view(GetSection<char>(PLAN_STRING_BLOB) + s.offset, s.len);
+}
+
+uint64_t GraphPlan::GetChecksum() const { return reinterpret_cast<const PlanHeader*>(_data)->checksum; }
+size_t GraphPlan::GetClusterCount() const {
+  const PlanHeader* header = reinterpret_cast<const PlanHeader*>(_data);
+  return header->sections[PLAN_CLUSTER].count;
+}
+std::string_view GraphPlan::GetClusterName(size_t idx) const {
+  if (idx >= GetClusterCount()) {
+    return {};
+  }
+  return GetString(GetSection<PlanCluster>(PLAN_CLUSTER)[idx].key);
+}
+
+int GraphPlan::ReadCluster(size_t idx, GraphCluster& cluster) const {
+  const PlanHeader* header = reinterpret_cast<const PlanHeader*>(_data);
+  auto in_section = [header](PlanSection section, const PlanRange& range) {
+    return static_cast<uint64_t>(range.begin) + range.count <= header->sections[section].count;
+  };
+  auto read_params = [this, header](uint64_t offset, Params& params) {
+    uint64_t blob_size = header->sections[PLAN_PARAMS].count;
+    if (offset >= blob_size) {
+      return false;
+    }
+    std::string_view buf(GetSection<char>(PLAN_PARAMS) + offset, blob_size - offset);
+    return params.ParseFromBinary(buf);
+  };
+  auto read_datas = [this, header, &in_section](const PlanRange& range, std::vector<GraphData>& datas) {
+    if (!in_section(PLAN_DATA, range)) {
+      return false;
+    }
+    datas.resize(range.count);
+    for (uint32_t i = 0; i < range.count; i++) {
+      const PlanData& d = GetSection<PlanData>(PLAN_DATA)[range.begin + i];
+      if (0 != (d.flags & ~kPlanDataFlagMask)) {
+        DIDAGLE_ERROR("Unknown graph plan data flags:{}", d.flags);
+        return false;
+      }
+      GraphData& data = datas[i];
+      data.id = GetString(d.id);
+      data.field = GetString(d.field);
+      data.move_from_when_skipped = GetString(d.move_from_when_skipped);
+      data.required = (d.flags & PLAN_DATA_REQUIRED) != 0;
+      data.move = (d.flags & PLAN_DATA_MOVE) != 0;
+      data.is_extern = (d.flags & PLAN_DATA_EXTERN) != 0;
+      data._is_in_out = (d.flags & PLAN_DATA_IN_OUT) != 0;
+      if (!in_section(PLAN_AGGREGATE, d.aggregate)) {
+        return false;
+      }
+      const uint32_t* aggregates = GetSection<uint32_t>(PLAN_AGGREGATE) + d.aggregate.begin;
+      for (uint32_t j = 0; j < d.aggregate.count; j++) {
+        data.aggregate.emplace_back(GetString(aggregates[j]));
+      }
+    }
+    return true;
+  };
+
+  if (idx >= GetClusterCount()) {
+    return -1;
+  }
+  const PlanCluster& c = GetSection<PlanCluster>(PLAN_CLUSTER)[idx];
+  if (!in_section(PLAN_GRAPH, c.graphs) || !in_section(PLAN_CONFIG, c.configs)) {
+    DIDAGLE_ERROR("Invalid graph plan cluster:{}", idx);
+    return -1;
+  }
+  if (0 != (c.flags & ~kPlanClusterFlagMask)) {
+    DIDAGLE_ERROR("Unknown graph plan cluster flags:{}", c.flags);
+    return -1;
+  }
+  cluster.name = GetString(c.name);
+  cluster._name = GetString(c.key);
+  cluster.desc = GetString(c.desc);
+  cluster.default_expr_processor = GetString(c.default_expr_processor);
+  cluster.strict_dsl = (c.flags & PLAN_CLUSTER_STRICT_DSL) != 0;
+  cluster.lazy_config_setting = (c.flags & PLAN_CLUSTER_LAZY_CONFIG_SETTING) != 0;
+  cluster.default_context_pool_size = c.default_context_pool_size;
+  cluster.trace_sample_rate = c.trace_sample_rate;
+  cluster.trace_slow_threshold_ms = c.trace_slow_threshold_ms;
+  cluster.config_setting.resize(c.configs.count);
+  for (uint32_t i = 0; i < c.configs.count; i++) {
+    const PlanConfig& cfg = GetSection<PlanConfig>(PLAN_CONFIG)[c.configs.begin + i];
+    cluster.config_setting[i].name = GetString(cfg.name);
+    cluster.config_setting[i].cond = GetString(cfg.cond);
+    cluster.config_setting[i].processor = GetString(cfg.processor);
+  }
+  cluster.graph.resize(c.graphs.count);
+  for (uint32_t i = 0; i < c.graphs.count; i++) {
+    const PlanGraph& g = GetSection<PlanGraph>(PLAN_GRAPH)[c.graphs.begin + i];
+    Graph& graph = cluster.graph[i];
+    graph.name = GetString(g.name);
+    if (0 != (g.flags & ~kPlanGraphFlagMask)) {
+      DIDAGLE_ERROR("Unknown graph plan flags:{} in graph:{}", g.flags, graph.name);
+      return -1;
+    }
+    graph.vertex_skip_as_error = (g.flags & PLAN_GRAPH_VERTEX_SKIP_AS_ERROR) != 0;
+    graph.gen_while_subgraph = (g.flags & PLAN_GRAPH_GEN_WHILE_SUBGRAPH) != 0;
+    graph.early_exit_graph_if_failed = (g.flags & PLAN_GRAPH_EARLY_EXIT_IF_FAILED) != 0;
+    graph.optimize = (g.flags & PLAN_GRAPH_OPTIMIZE) != 0;
+    graph.inline_subgraph = (g.flags & PLAN_GRAPH_INLINE_SUBGRAPH) != 0;
+    graph.priority = g.priority;
+    graph.resume_on = GetString(g.resume_on);
+    graph.trace_sample_rate = g.trace_sample_rate;
+    graph.trace_slow_threshold_ms = g.trace_slow_threshold_ms;
+    if (!in_section(PLAN_VERTEX, g.vertexs)) {
+      DIDAGLE_ERROR("Invalid graph plan graph:{}", graph.name);
+      return -1;
+    }
+    graph.vertex.resize(g.vertexs.count);
+    for (uint32_t j = 0; j < g.vertexs.count; j++) {
+      const PlanVertex& v = GetSection<PlanVertex>(PLAN_VERTEX)[g.vertexs.begin + j];
+      Vertex& vertex = graph.vertex[j];
+      vertex.id = GetString(v.id);
+      vertex.processor = GetString(v.processor);
+      vertex.cond = GetString(v.cond);
+      vertex.expect = GetString(v.expect);
+      vertex.expect_config = GetString(v.expect_config);
+      vertex.cluster = GetString(v.cluster);
+      vertex.graph = GetString(v.graph);
+      vertex.while_cond = GetString(v.while_cond);
+      vertex.resume_on = GetString(v.resume_on);
+      if (0 != (v.flags & ~kPlanVertexFlagMask)) {
+        DIDAGLE_ERROR("Unknown graph plan flags:{} in vertex:{}", v.flags, vertex.id);
+        return -1;
+      }
+      vertex.is_start = (v.flags & PLAN_VERTEX_START) != 0;
+      vertex.while_async = (v.flags & PLAN_VERTEX_WHILE_ASYNC) != 0;
+      vertex.ignore_processor_execute_error = (v.flags & PLAN_VERTEX_IGNORE_EXECUTE_ERROR) != 0;
+      vertex.early_exit_graph_if_failed = (v.flags & PLAN_VERTEX_EARLY_EXIT_IF_FAILED) != 0;
+      vertex.side_effect = (v.flags & PLAN_VERTEX_SIDE_EFFECT) != 0;
+      if (!in_section(PLAN_EDGE, v.edges) || !in_section(PLAN_SELECT, v.selects)) {
+        DIDAGLE_ERROR("Invalid graph plan vertex:{} in graph:{}", vertex.id, graph.name);
+        return -1;
+      }
+      const PlanEdge* edges = GetSection<PlanEdge>(PLAN_EDGE) + v.edges.begin;
+      for (uint32_t k = 0; k < v.edges.count; k++) {
+        std::set<std::string>* ids = get_vertex_edges(vertex, edges[k].kind);
+        if (nullptr == ids) {
+          DIDAGLE_ERROR("Invalid graph plan edge kind:{}", edges[k].kind);
+          return -1;
+        }
+        ids->emplace_hint(ids->end(), GetString(edges[k].target));
+      }
+      vertex.select_args.resize(v.selects.count);
+      for (uint32_t k = 0; k < v.selects.count; k++) {
+        const PlanSelect& select = GetSection<PlanSelect>(PLAN_SELECT)[v.selects.begin + k];
+        vertex.select_args[k].match = GetString(select.match);
+        vertex.select_args[k].inherit_default = select.inherit_default != 0;
+        if (!read_params(select.args, vertex.select_args[k].args)) {
+          DIDAGLE_ERROR("Invalid graph plan select args in vertex:{}", vertex.id);
+          return -1;
+        }
+      }
+      if (!read_params(v.args, vertex.args) || !read_datas(v.inputs, vertex.input) ||
+          !read_datas(v.outputs, vertex.output)) {
+        DIDAGLE_ERROR("Invalid graph plan args/input/output in vertex:{}", vertex.id);
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+}  // namespace didagle
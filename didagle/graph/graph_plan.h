@@ -0,0 +1,71 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "didagle/graph/graph.h"
+
+namespace didagle {
+
+/**
+ * @brief Binary graph plan: parsed DSL clusters stored as fixed size record tables(clusters, graphs, vertexs,
+ * CSR vertex edges, data, select args, config settings) over one interned string table, with params trees as
+ * binary blobs. A plan is written by the offline compiler from already validated DSLs, and loaded by mmap without
+ * any TOML parsing. Only the parsing is skipped: clusters decoded from a plan are still built(with optimizer passes)
+ * & pre-warmed like DSL files.
+ * The layout is in host byte order & guarded by magic/version/checksum, rebuild the plan after upgrading didagle.
+ * Bump the version on any change of record layout or flag bits, unknown flag bits are rejected on read.
+ *   1: initial layout
+ *   2: graph 'optimize'/'inline_subgraph' & vertex 'side_effect' flags, graph/vertex 'resume_on'
+ */
+constexpr uint32_t kGraphPlanVersion = 2;
+
+/**
+ * @brief Encode clusters into a graph plan, clusters must NOT be built yet(as parsed from DSL).
+ */
+int write_graph_plan(const std::vector<const GraphCluster*>& clusters, std::string& buf);
+int write_graph_plan_file(const std::vector<const GraphCluster*>& clusters, const std::string& file);
+
+class GraphPlan {
+ public:
+  /**
+   * @brief mmap & verify a plan file, nullptr if the file is not a valid plan of current version.
+   */
+  static std::unique_ptr<GraphPlan> Load(const std::string& file);
+  /**
+   * @brief verify a plan in memory, the content is copied.
+   */
+  static std::unique_ptr<GraphPlan> LoadBuffer(std::string_view content);
+
+  /**
+   * @brief checksum of the plan content, unchanged plans have the same checksum.
+   */
+  uint64_t GetChecksum() const;
+  size_t GetClusterCount() const;
+  std::string_view GetClusterName(size_t idx) const;
+  /**
+   * @brief decode cluster at 'idx' into 'cluster' which is ready to build.
+   */
+  int ReadCluster(size_t idx, GraphCluster& cluster) const;
+  ~GraphPlan();
+
+ private:
+  GraphPlan() = default;
+  int Verify();
+  std::string_view GetString(uint32_t id) const;
+  template <typename T>
+  const T* GetSection(int section) const;
+
+  const char* _data = nullptr;
+  size_t _size = 0;
+  void* _mmap = nullptr;
+  std::string _buffer;
+};
+
+}  // namespace didagle
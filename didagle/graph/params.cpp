@@ -27,13 +27,118 @@
  *THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <boost/algorithm/string.hpp>
+#include <string.h>
+#include <mutex>
+#include <shared_mutex>
 
 #include "didagle/graph/params.h"
+#include "folly/SharedMutex.h"
 #include "kcfg_toml.h"
 
 namespace didagle {
 
+namespace {
+struct ParamsKeyRegistry {
+  folly::SharedMutex mutex;
+  folly::F14FastMap<std::string, uint32_t> ids;
+};
+ParamsKeyRegistry& GetParamsKeyRegistry() {
+  static ParamsKeyRegistry registry;
+  return registry;
+}
+}  // namespace
+
+ParamsKey::ParamsKey(const ParamsString& n) : id(Params::InternKey(n)), name(n) {}
+
+uint32_t Params::InternKey(const ParamsString& name) {
+  ParamsKeyRegistry& registry = GetParamsKeyRegistry();
+  std::string key(name.data(), name.size());
+  {
+    std::shared_lock<folly::SharedMutex> guard(registry.mutex);
+    auto found = registry.ids.find(key);
+    if (found != registry.ids.end()) {
+      return found->second;
+    }
+  }
+  std::unique_lock<folly::SharedMutex> guard(registry.mutex);
+  auto result = registry.ids.emplace(std::move(key), static_cast<uint32_t>(registry.ids.size()));
+  return result.first->second;
+}
+
 Params::Params(bool invalid_) : iv(0), dv(0), bv(false), invalid(invalid_), parent(nullptr) {}
+Params::Params(const Params& other)
+    : _param_type(other._param_type),
+      str(other.str),
+      iv(other.iv),
+      dv(other.dv),
+      bv(other.bv),
+      invalid(other.invalid),
+      params(other.params),
+      param_array(other.param_array),
+      parent(other.parent),
+      layer(other.layer) {
+  // members are already compiled by their own copy constructors
+  if (other._key_index) {
+    BuildKeyIndex();
+  }
+}
+Params& Params::operator=(const Params& other) {
+  if (this == &other) {
+    return *this;
+  }
+  _param_type = other._param_type;
+  str = other.str;
+  iv = other.iv;
+  dv = other.dv;
+  bv = other.bv;
+  invalid = other.invalid;
+  params = other.params;
+  param_array = other.param_array;
+  parent = other.parent;
+  layer = other.layer;
+  _key_index.reset();
+  if (other._key_index) {
+    BuildKeyIndex();
+  }
+  return *this;
+}
+void Params::BuildKeyIndex() {
+  auto index = std::make_unique<ParamsKeyIndex>();
+  std::vector<std::pair<uint32_t, const Params*>> entries;
+  entries.reserve(params.size());
+  uint32_t min_id = UINT32_MAX;
+  uint32_t max_id = 0;
+  for (const auto& kv : params) {
+    uint32_t id = InternKey(kv.first);
+    entries.emplace_back(id, &kv.second);
+    min_id = std::min(min_id, id);
+    max_id = std::max(max_id, id);
+  }
+  if (!entries.empty() && (max_id - min_id) < entries.size() * 4 + 16) {
+    index->base = min_id;
+    index->slots.resize(max_id - min_id + 1, nullptr);
+    for (const auto& entry : entries) {
+      index->slots[entry.first - min_id] = entry.second;
+    }
+  } else {
+    std::sort(entries.begin(), entries.end());
+    index->sparse = std::move(entries);
+  }
+  _key_index = std::move(index);
+}
+void Params::Compile() {
+  for (auto& kv : params) {
+    kv.second.Compile();
+  }
+  for (auto& item : param_array) {
+    item.Compile();
+  }
+  if (_param_type == PARAM_OBJECT || !params.empty()) {
+    BuildKeyIndex();
+  } else {
+    _key_index.reset();
+  }
+}
 void Params::SetParent(const Params* p) {
   if (nullptr == p) {
     parent = nullptr;
@@ -51,47 +156,53 @@ void Params::SetParent(const Params* p) {
     const_cast<Params*>(parent)->SetParent(p);
   }
 }
-bool Params::Valid() const { return !invalid; }
+bool Params::Valid() const { return !Self().invalid; }
 bool Params::IsBool() const {
-  if (invalid) {
+  const Params& self = Self();
+  if (self.invalid) {
     return false;
   }
-  return _param_type == PARAM_BOOL;
+  return self._param_type == PARAM_BOOL;
 }
 bool Params::IsString() const {
-  if (invalid) {
+  const Params& self = Self();
+  if (self.invalid) {
     return false;
   }
-  return _param_type == PARAM_STRING;
+  return self._param_type == PARAM_STRING;
 }
 bool Params::IsDouble() const {
-  if (invalid) {
+  const Params& self = Self();
+  if (self.invalid) {
     return false;
   }
-  return _param_type == PARAM_DOUBLE;
+  return self._param_type == PARAM_DOUBLE;
 }
 bool Params::IsInt() const {
-  if (invalid) {
+  const Params& self = Self();
+  if (self.invalid) {
     return false;
   }
-  return _param_type == PARAM_INT;
+  return self._param_type == PARAM_INT;
 }
 bool Params::IsObject() const {
-  if (invalid) {
+  const Params& self = Self();
+  if (self.invalid) {
     return false;
   }
-  return _param_type == PARAM_OBJECT;
+  return self._param_type == PARAM_OBJECT;
 }
 bool Params::IsArray() const {
-  if (invalid) {
+  const Params& self = Self();
+  if (self.invalid) {
     return false;
   }
-  return _param_type == PARAM_ARRAY;
+  return self._param_type == PARAM_ARRAY;
 }
-const ParamsString& Params::String() const { return str; }
-int64_t Params::Int() const { return iv; }
-bool Params::Bool() const { return bv; }
-double Params::Double() const { return dv; }
+const ParamsString& Params::String() const { return Self().str; }
+int64_t Params::Int() const { return Self().iv; }
+bool Params::Bool() const { return Self().bv; }
+double Params::Double() const { return Self().dv; }
 void Params::SetString(const ParamsString& v) {
   str = v;
   _param_type = PARAM_STRING;
@@ -109,12 +220,13 @@ void Params::SetBool(bool v) {
   _param_type = PARAM_BOOL;
 }
 size_t Params::Size() const {
-  if (params.size() > 0) {
-    return params.size();
+  const Params& self = Self();
+  if (self.params.size() > 0) {
+    return self.params.size();
   }
-  return param_array.size();
+  return self.param_array.size();
 }
-const Params::ParamValueTable& Params::Members() const { return params; }
+const Params::ParamValueTable& Params::Members() const { return Self().params; }
 
 void Params::BuildFromString(const std::string& v) {
   if (invalid) {
@@ -149,8 +261,9 @@ void Params::BuildFromString(const std::string& v) {
   str = v;
 }
 const Params& Params::Get(const ParamsString& name) const {
-  ParamValueTable::const_iterator it = params.find(name);
-  if (it != params.end()) {
+  const Params& self = Self();
+  ParamValueTable::const_iterator it = self.params.find(name);
+  if (it != self.params.end()) {
     return it->second;
   }
   if (nullptr != parent) {
@@ -159,6 +272,25 @@ const Params& Params::Get(const ParamsString& name) const {
   static Params default_value(true);
   return default_value;
 }
+const Params& Params::Get(const ParamsKey& key) const {
+  const Params& self = Self();
+  if (self._key_index) {
+    const Params* found = self._key_index->Find(key.id);
+    if (nullptr != found) {
+      return *found;
+    }
+  } else {
+    ParamValueTable::const_iterator it = self.params.find(key.name);
+    if (it != self.params.end()) {
+      return it->second;
+    }
+  }
+  if (nullptr != parent) {
+    return parent->Get(key);
+  }
+  static Params default_value(true);
+  return default_value;
+}
 const Params& Params::operator[](const ParamsString& name) const { return Get(name); }
 Params& Params::operator[](const ParamsString& name) {
   const Params& p = Get(name);
@@ -166,11 +298,13 @@ Params& Params::operator[](const ParamsString& name) {
     return const_cast<Params&>(p);
   }
   _param_type = PARAM_OBJECT;
+  ResetKeyIndex();
   return params[name];
 }
 const Params& Params::operator[](size_t idx) const {
-  if (param_array.size() > idx) {
-    return param_array[idx];
+  const Params& self = Self();
+  if (self.param_array.size() > idx) {
+    return self.param_array[idx];
   }
   static Params default_value(true);
   return default_value;
@@ -182,31 +316,37 @@ Params& Params::Add() {
 }
 Params& Params::Put(const ParamsString& name, const char* value) {
   _param_type = PARAM_OBJECT;
+  ResetKeyIndex();
   params[name].SetString(value);
   return *this;
 }
 Params& Params::Put(const ParamsString& name, const ParamsString& value) {
   _param_type = PARAM_OBJECT;
+  ResetKeyIndex();
   params[name].SetString(value);
   return *this;
 }
 Params& Params::Put(const ParamsString& name, int64_t value) {
   _param_type = PARAM_OBJECT;
+  ResetKeyIndex();
   params[name].SetInt(value);
   return *this;
 }
 Params& Params::Put(const ParamsString& name, double value) {
   _param_type = PARAM_OBJECT;
+  ResetKeyIndex();
   params[name].SetDouble(value);
   return *this;
 }
 Params& Params::Put(const ParamsString& name, bool value) {
   _param_type = PARAM_OBJECT;
+  ResetKeyIndex();
   params[name].SetBool(value);
   return *this;
 }
 Params& Params::Put(const ParamsString& name, Params&& p) {
   _param_type = PARAM_OBJECT;
+  ResetKeyIndex();
   params[name] = std::move(p);
   return *this;
 }
@@ -219,7 +359,7 @@ Params& Params::operator[](size_t idx) {
   return param_array[idx];
 }
 bool Params::Contains(const ParamsString& name) const {
-  if (params.count(name) > 0) {
+  if (Self().params.count(name) > 0) {
     return true;
   }
   if (nullptr != parent) {
@@ -229,10 +369,11 @@ bool Params::Contains(const ParamsString& name) const {
 }
 void Params::Insert(const Params& other) {
   _param_type = PARAM_OBJECT;
+  ResetKeyIndex();
   for (auto& kv : other.Members()) {
     params[kv.first] = kv.second;
   }
-  for (auto& kv : other.param_array) {
+  for (auto& kv : other.Self().param_array) {
     param_array.push_back(kv);
   }
 }
@@ -246,6 +387,7 @@ void Params::ParseFromString(const std::string& v) {
       boost::algorithm::trim(kv[0]);
       boost::algorithm::trim(kv[1]);
       _param_type = PARAM_OBJECT;
+      ResetKeyIndex();
       params[kv[0]].BuildFromString(kv[1]);
     }
   }
@@ -261,14 +403,123 @@ const Params& Params::GetVar(const ParamsString& name) const {
     } else {
       auto part = var_name.substr(0, pos);
       var_params = &(var_params->Get(part));
-      var_name = var_name.substr(pos);
+      var_name = var_name.substr(pos + 1);
     }
   }
   return *var_params;
 }
 
+namespace {
+template <typename T>
+void append_binary_value(std::string& buf, T v) {
+  buf.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+void append_binary_string(std::string& buf, std::string_view v) {
+  append_binary_value(buf, static_cast<uint32_t>(v.size()));
+  buf.append(v.data(), v.size());
+}
+template <typename T>
+bool read_binary_value(std::string_view& buf, T& v) {
+  if (buf.size() < sizeof(v)) {
+    return false;
+  }
+  memcpy(&v, buf.data(), sizeof(v));
+  buf.remove_prefix(sizeof(v));
+  return true;
+}
+bool read_binary_string(std::string_view& buf, std::string_view& v) {
+  uint32_t len = 0;
+  if (!read_binary_value(buf, len) || buf.size() < len) {
+    return false;
+  }
+  v = buf.substr(0, len);
+  buf.remove_prefix(len);
+  return true;
+}
+}  // namespace
+
+void Params::AppendBinary(std::string& buf) const {
+  append_binary_value(buf, static_cast<uint8_t>(_param_type));
+  append_binary_value(buf, static_cast<uint8_t>(invalid));
+  switch (_param_type) {
+    case PARAM_OBJECT: {
+      append_binary_value(buf, static_cast<uint32_t>(params.size()));
+      for (const auto& kv : params) {
+        append_binary_string(buf, std::string_view(kv.first.data(), kv.first.size()));
+        kv.second.AppendBinary(buf);
+      }
+      break;
+    }
+    case PARAM_ARRAY: {
+      append_binary_value(buf, static_cast<uint32_t>(param_array.size()));
+      for (const auto& item : param_array) {
+        item.AppendBinary(buf);
+      }
+      break;
+    }
+    default: {
+      append_binary_string(buf, std::string_view(str.data(), str.size()));
+      append_binary_value(buf, iv);
+      append_binary_value(buf, dv);
+      append_binary_value(buf, static_cast<uint8_t>(bv));
+      break;
+    }
+  }
+}
+bool Params::ParseFromBinary(std::string_view& buf) {
+  uint8_t type = 0;
+  uint8_t invalid_flag = 0;
+  if (!read_binary_value(buf, type) || !read_binary_value(buf, invalid_flag) || type > PARAM_ARRAY) {
+    return false;
+  }
+  ResetKeyIndex();
+  _param_type = static_cast<ParamValueType>(type);
+  invalid = invalid_flag != 0;
+  switch (_param_type) {
+    case PARAM_OBJECT: {
+      uint32_t n = 0;
+      if (!read_binary_value(buf, n)) {
+        return false;
+      }
+      for (uint32_t i = 0; i < n; i++) {
+        std::string_view key;
+        if (!read_binary_string(buf, key) || !params[ParamsString(key.data(), key.size())].ParseFromBinary(buf)) {
+          return false;
+        }
+      }
+      break;
+    }
+    case PARAM_ARRAY: {
+      uint32_t n = 0;
+      if (!read_binary_value(buf, n) || n > buf.size()) {
+        return false;
+      }
+      param_array.resize(n);
+      for (uint32_t i = 0; i < n; i++) {
+        if (!param_array[i].ParseFromBinary(buf)) {
+          return false;
+        }
+      }
+      break;
+    }
+    default: {
+      std::string_view v;
+      uint8_t b = 0;
+      if (!read_binary_string(buf, v) || !read_binary_value(buf, iv) || !read_binary_value(buf, dv) ||
+          !read_binary_value(buf, b)) {
+        return false;
+      }
+      str.assign(v.data(), v.size());
+      bv = b != 0;
+      break;
+    }
+  }
+  return true;
+}
+
 bool GraphParams::ParseFromToml(const kcfg::TomlValue& doc) {
   if (doc.is_table()) {
+    ResetKeyIndex();
     for (const auto& kv : doc.as_table()) {
       const std::string& name = kv.first;
       const auto& value = kv.second;
@@ -29,10 +29,12 @@
 
 #pragma once
 #include <stdint.h>
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "folly/FBString.h"
 #include "folly/FBVector.h"
@@ -43,6 +45,40 @@ namespace didagle {
 typedef folly::fbstring ParamsString;
 class Params;
 using ParamsPtr = std::shared_ptr<Params>;
+
+/**
+ * @brief A params member name bound to a process wide interned id.
+ * Construct once(e.g. as a static) and use it for repeated lookups on compiled params.
+ */
+struct ParamsKey {
+  uint32_t id = 0;
+  ParamsString name;
+  explicit ParamsKey(const ParamsString& n);
+};
+
+/**
+ * @brief Member index of a compiled object node, maps interned key id to member.
+ * Dense slots are used when the key ids are close enough, otherwise a sorted array.
+ */
+struct ParamsKeyIndex {
+  uint32_t base = 0;
+  std::vector<const Params*> slots;
+  std::vector<std::pair<uint32_t, const Params*>> sparse;
+
+  const Params* Find(uint32_t id) const {
+    if (!slots.empty()) {
+      uint32_t offset = id - base;
+      return offset < slots.size() ? slots[offset] : nullptr;
+    }
+    auto it = std::lower_bound(sparse.begin(), sparse.end(), id,
+                               [](const std::pair<uint32_t, const Params*>& v, uint32_t k) { return v.first < k; });
+    if (it != sparse.end() && it->first == id) {
+      return it->second;
+    }
+    return nullptr;
+  }
+};
+
 class Params {
  public:
   using ParamValueTable = folly::F14NodeMap<ParamsString, Params>;
@@ -69,12 +105,33 @@ class Params {
   ParamValueArray param_array;
 
   const Params* parent = nullptr;
+  // values & members are read from 'layer' if set, see SetOverlay
+  const Params* layer = nullptr;
+  // built by Compile(), dropped on any member insertion
+  std::unique_ptr<ParamsKeyIndex> _key_index;
+
+  void BuildKeyIndex();
+  void ResetKeyIndex() { _key_index.reset(); }
 
  public:
   explicit Params(bool invalid_ = false);
+  Params(const Params& other);
+  Params(Params&& other) = default;
+  Params& operator=(const Params& other);
+  Params& operator=(Params&& other) = default;
+  static uint32_t InternKey(const ParamsString& name);
   static ParamsPtr New() { return std::make_shared<Params>(); }
   static ParamsPtr New(Params&& params) { return std::make_shared<Params>(std::move(params)); }
   void SetParent(const Params* p);
+  /**
+   * @brief Make this params a view of 'layer_params' whose missing members are looked up in 'parent_params'.
+   * Neither params is modified, so a shared params tree could be layered by multiple views concurrently.
+   */
+  void SetOverlay(const Params* layer_params, const Params* parent_params) {
+    layer = layer_params;
+    parent = parent_params;
+  }
+  const Params& Self() const { return nullptr == layer ? *this : layer->Self(); }
   bool Valid() const;
   bool IsBool() const;
   bool IsString() const;
@@ -100,6 +157,8 @@ class Params {
 
   Params& Add();
   const Params& Get(const ParamsString& name) const;
+  const Params& Get(const ParamsKey& key) const;
+  const Params& operator[](const ParamsKey& key) const { return Get(key); }
   Params& Put(const ParamsString& name, const char* value);
   Params& Put(const ParamsString& name, const ParamsString& value);
   Params& Put(const ParamsString& name, int64_t value);
@@ -107,10 +166,26 @@ class Params {
   Params& Put(const ParamsString& name, bool value);
   Params& Put(const ParamsString& name, Params&& p);
   bool Contains(const ParamsString& name) const;
+  bool Contains(const ParamsKey& key) const { return Get(key).Valid(); }
   void Insert(const Params& other);
   void BuildFromString(const std::string& v);
   void ParseFromString(const std::string& v);
   const Params& GetVar(const ParamsString& name) const;
+
+  /**
+   * @brief Build key indexes for this node and all descendants, so that lookups by
+   * ParamsKey are an indexed load instead of a string hash.
+   * Copies of a compiled params are compiled as well.
+   */
+  void Compile();
+  bool IsCompiled() const { return _key_index != nullptr; }
+
+  /**
+   * @brief Compact binary encoding of the whole params tree, used by compiled graph plans.
+   * 'ParseFromBinary' consumes the encoded bytes from the front of 'buf'.
+   */
+  void AppendBinary(std::string& buf) const;
+  bool ParseFromBinary(std::string_view& buf);
 };
 
 struct GraphData {
@@ -131,6 +206,8 @@ struct ConfigSetting {
   std::string name;
   std::string cond;
   std::string processor;
+  // evaluated on first reference instead of graph start
+  bool _lazy = false;
   KCFG_TOML_DEFINE_FIELDS(name, cond, processor)
 };
 
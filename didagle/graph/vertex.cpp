@@ -1,29 +1,49 @@
 // Copyright (c) 2020, Tencent Inc.
 // All rights reserved.
 #include "didagle/graph/vertex.h"
-#include <regex>
 #include <set>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "didagle/graph/graph.h"
 #include "didagle/log/log.h"
 #include "didagle/processor/processor.h"
 
 namespace didagle {
+int parse_vertex_resume_on(const std::string& s, VertexResumeOn& resume_on) {
+  if (s.empty()) {
+    return 0;
+  }
+  if (s == "inline") {
+    resume_on = V_RESUME_INLINE;
+  } else if (s == "graph") {
+    resume_on = V_RESUME_GRAPH;
+  } else if (s == "cpu") {
+    resume_on = V_RESUME_CPU;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
 Vertex::Vertex() {
   // Params empty(true);
   // args = empty;
 }
 bool Vertex::FindVertexInSuccessors(Vertex* v) const {
-  if (_successor_vertex.empty()) {
-    return false;
-  }
-  if (_successor_vertex.count(v) > 0) {
-    return true;
-  }
-  for (Vertex* succeed : _successor_vertex) {
-    if (succeed->FindVertexInSuccessors(v)) {
-      return true;
+  std::unordered_set<const Vertex*> visited;
+  std::vector<const Vertex*> stack{this};
+  while (!stack.empty()) {
+    const Vertex* current = stack.back();
+    stack.pop_back();
+    for (Vertex* succeed : current->_successor_vertex) {
+      if (succeed == v) {
+        return true;
+      }
+      if (visited.insert(succeed).second) {
+        stack.emplace_back(succeed);
+      }
     }
   }
   return false;
@@ -32,12 +52,12 @@ int Vertex::FillInputOutput() {
   if (processor.empty()) {
     return 0;
   }
-  auto p = ProcessorFactory::GetProcessor(processor);
-  if (nullptr == p) {
+  auto meta = ProcessorFactory::GetProcessorMeta(processor);
+  if (!meta) {
     DIDAGLE_ERROR("No processor found for {}", processor);
     return -1;
   }
-  for (const auto& input_id : p->GetInputIds()) {
+  for (const auto& input_id : meta->input) {
     bool match = false;
     GraphData* matched_input = nullptr;
     for (auto& in : input) {
@@ -65,7 +85,7 @@ int Vertex::FillInputOutput() {
       }
     }
   }
-  for (const auto& output_id : p->GetOutputIds()) {
+  for (const auto& output_id : meta->output) {
     bool match = false;
     for (const auto& out : output) {
       if (out.field == output_id.name) {
@@ -80,7 +100,6 @@ int Vertex::FillInputOutput() {
       output.push_back(field);
     }
   }
-  delete p;
   return 0;
 }
 void Vertex::SetGeneratedId(const std::string& v) {
@@ -106,7 +125,15 @@ bool Vertex::Verify() {
 std::string Vertex::GetDotId() const { return _graph->name + "_" + id; }
 std::string Vertex::GetDotLable() const {
   if (!cond.empty()) {
-    return std::regex_replace(cond, std::regex("\""), "\\\"");
+    std::string s;
+    s.reserve(cond.size());
+    for (char c : cond) {
+      if (c == '"') {
+        s.push_back('\\');
+      }
+      s.push_back(c);
+    }
+    return s;
     // return cond;
   }
   if (!processor.empty()) {
@@ -144,10 +171,12 @@ int Vertex::DumpDotDefine(std::string& s) {
 }
 int Vertex::DumpDotEdge(std::string& s) {
   if (!expect_config.empty()) {
-    std::string expect_config_id = _graph->name + "_" + std::regex_replace(expect_config, std::regex("!"), "");
-    // std::string expect_config_name =
-    //     _graph->name + "_" + std::regex_replace(expect_config,
-    //     std::regex("!"), "NOT_");
+    std::string expect_config_id = _graph->name + "_";
+    for (char c : expect_config) {
+      if (c != '!') {
+        expect_config_id.push_back(c);
+      }
+    }
     s.append("    ").append(expect_config_id).append(" -> ").append(GetDotId());
     if (expect_config[0] == '!') {
       s.append(" [style=dashed color=red label=\"err\"];\n");
@@ -193,6 +222,32 @@ void Vertex::Depend(Vertex* v, VertexResult expected) {
     _deps_expected_results[idx] = expected;
   }
 }
+void Vertex::RemoveDependency(Vertex* v) {
+  auto found = _deps_idx.find(v);
+  if (found == _deps_idx.end()) {
+    return;
+  }
+  int idx = found->second;
+  _deps_idx.erase(found);
+  for (auto& pair : _deps_idx) {
+    if (pair.second > idx) {
+      pair.second--;
+    }
+  }
+  _deps_expected_results.erase(_deps_expected_results.begin() + idx);
+  v->_successor_vertex.erase(this);
+}
+void Vertex::ReplaceDependency(Vertex* from, Vertex* to) {
+  auto found = _deps_idx.find(from);
+  if (found == _deps_idx.end() || _deps_idx.count(to) > 0) {
+    return;
+  }
+  int idx = found->second;
+  _deps_idx.erase(found);
+  _deps_idx[to] = idx;
+  from->_successor_vertex.erase(this);
+  to->_successor_vertex.insert(this);
+}
 int Vertex::BuildSuccessors(const std::set<std::string>& sucessor, VertexResult expected) {
   for (const std::string& id : sucessor) {
     Vertex* successor_vertex = _graph->FindVertexById(id);
@@ -225,7 +280,9 @@ int Vertex::Build() {
     DIDAGLE_ERROR("'processor'& 'graph' is empty in {}", GetDotLable());
     return -1;
   }
+  args.Compile();
   for (auto& select : select_args) {
+    select.args.Compile();
     if (select.IsCondExpr()) {
       continue;
     }
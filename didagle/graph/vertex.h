@@ -32,6 +32,17 @@ enum VertexErrCode {
   V_CODE_SKIP = 3,
 };
 
+// where an async(future) processor continues once its future is fulfilled
+enum VertexResumeOn {
+  V_RESUME_INLINE = 0,
+  V_RESUME_GRAPH = 1,
+  V_RESUME_CPU = 2,
+};
+/**
+ * @brief parse 'inline'/'graph'/'cpu', -1 if invalid. 'resume_on' is unchanged if 's' is empty.
+ */
+int parse_vertex_resume_on(const std::string& s, VertexResumeOn& resume_on);
+
 struct Graph;
 struct Vertex {
   std::string id;
@@ -69,6 +80,12 @@ struct Vertex {
 
   bool ignore_processor_execute_error = true;
   bool early_exit_graph_if_failed = false;
+  // kept by graph optimizer even if nothing depends on it
+  bool side_effect = false;
+  // where successors of an async(future) processor run: 'inline' on the thread fulfilling the future, 'graph' on
+  // 'async_executor', 'cpu' on 'cpu_executor'. inherits 'Graph::resume_on' if empty. the coroutine engine always
+  // resumes on 'coro_executor'
+  std::string resume_on;
 
   std::unordered_set<Vertex*> _successor_vertex;
   std::vector<VertexResult> _deps_expected_results;
@@ -78,6 +95,7 @@ struct Vertex {
   bool _is_id_generated = false;
   bool _is_cond_processor = false;
   bool _disable = false;
+  VertexResumeOn _resume_on = V_RESUME_INLINE;
 
   KCFG_TOML_DEFINE_FIELD_MAPPING(({"consequent", "if"}, {"alternative", "else"}, {"is_start", "start"},
                                   {"while_cond", "while"}, {"while_async", "async"}))
@@ -85,7 +103,7 @@ struct Vertex {
   KCFG_TOML_DEFINE_FIELDS(id, processor, args, cond, expect, expect_deps, expect_config, is_start, select_args, cluster,
                           graph, while_cond, while_async, successor, successor_on_ok, successor_on_err, consequent,
                           alternative, deps, deps_on_ok, deps_on_err, input, output, ignore_processor_execute_error,
-                          early_exit_graph_if_failed)
+                          early_exit_graph_if_failed, side_effect, resume_on)
   Vertex();
   bool IsDepsEmpty() const {
     return expect.empty() && expect_config.empty() && deps.empty() && deps_on_ok.empty() && deps_on_err.empty();
@@ -99,6 +117,14 @@ struct Vertex {
   bool IsDepsEmpty();
   bool Verify();
   void Depend(Vertex* v, VertexResult expected);
+  /**
+   * @brief unlink built dependency on 'v', indexes of the remaining dependencies are compacted.
+   */
+  void RemoveDependency(Vertex* v);
+  /**
+   * @brief let built dependency on 'from' point to 'to' with the same index & expected result.
+   */
+  void ReplaceDependency(Vertex* from, Vertex* to);
   int BuildDeps(const std::set<std::string>& dependency, VertexResult expected);
   int BuildSuccessors(const std::set<std::string>& sucessor, VertexResult expected);
   int Build();
@@ -0,0 +1,41 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include "didagle/log/async_logger.h"
+#include <utility>
+
+namespace didagle {
+AsyncLogger::AsyncLogger(std::shared_ptr<Logger> sink, size_t max_pending)
+    : _sink(std::move(sink)), _max_pending(max_pending) {
+  _thread = std::thread([this]() {
+    while (true) {
+      Entry entry;
+      _queue.dequeue(entry);
+      if (entry.stop) {
+        return;
+      }
+      _pending.fetch_sub(1, std::memory_order_relaxed);
+      _sink->Log(entry.loc, entry.level, entry.msg);
+    }
+  });
+}
+bool AsyncLogger::ShouldLog(spdlog::level::level_enum log_level) { return _sink->ShouldLog(log_level); }
+void AsyncLogger::Log(spdlog::source_loc loc, spdlog::level::level_enum lvl, std::string_view msg) {
+  if (_pending.fetch_add(1, std::memory_order_relaxed) >= _max_pending) {
+    _pending.fetch_sub(1, std::memory_order_relaxed);
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Entry entry;
+  entry.loc = loc;
+  entry.level = lvl;
+  entry.msg = msg;
+  _queue.enqueue(std::move(entry));
+}
+AsyncLogger::~AsyncLogger() {
+  // messages enqueued before are written before the stop entry
+  Entry entry;
+  entry.stop = true;
+  _queue.enqueue(std::move(entry));
+  _thread.join();
+}
+}  // namespace didagle
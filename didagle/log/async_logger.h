@@ -0,0 +1,43 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "folly/concurrency/UnboundedQueue.h"
+
+#include "didagle/log/log.h"
+
+namespace didagle {
+
+/**
+ * @brief Logger which formats messages on the calling thread and writes them to 'sink' from a background thread,
+ * messages are dropped if there are more than 'max_pending' messages waiting.
+ */
+class AsyncLogger : public Logger {
+ public:
+  explicit AsyncLogger(std::shared_ptr<Logger> sink, size_t max_pending = 100000);
+  bool ShouldLog(spdlog::level::level_enum log_level) override;
+  void Log(spdlog::source_loc loc, spdlog::level::level_enum lvl, std::string_view msg) override;
+  inline uint64_t GetDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+  ~AsyncLogger();
+
+ private:
+  struct Entry {
+    spdlog::source_loc loc;
+    spdlog::level::level_enum level = spdlog::level::off;
+    std::string msg;
+    bool stop = false;
+  };
+  std::shared_ptr<Logger> _sink;
+  size_t _max_pending = 0;
+  std::atomic<size_t> _pending{0};
+  std::atomic<uint64_t> _dropped{0};
+  folly::UMPSCQueue<Entry, true> _queue;
+  std::thread _thread;
+};
+
+}  // namespace didagle
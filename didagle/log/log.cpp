@@ -28,10 +28,12 @@
  */
 #include "didagle/log/log.h"
 #include <memory>
+#include <utility>
 #include "spdlog/spdlog.h"
 
 namespace didagle {
 static std::shared_ptr<Logger> g_logger;
+std::atomic<int> Logger::_level{spdlog::level::trace};
 Logger& Logger::GetDidagleLogger() {
   if (g_logger) {
     return *g_logger;
@@ -61,4 +63,5 @@ void Spdlogger::Log(spdlog::source_loc loc, spdlog::level::level_enum lvl, std::
   }
   logger->log(loc, lvl, msg);
 }
+
 }  // namespace didagle
@@ -14,15 +14,33 @@
 
 #include "fmt/ostream.h"  // do NOT put this line before spdlog
 
+/**
+ * @brief Compile time minimum log level(SPDLOG_LEVEL_*), statements below it are removed entirely,
+ * e.g. '-DDIDAGLE_MIN_LOG_LEVEL=SPDLOG_LEVEL_INFO' to strip all 'DIDAGLE_DEBUG'.
+ */
+#ifndef DIDAGLE_MIN_LOG_LEVEL
+#define DIDAGLE_MIN_LOG_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
 namespace didagle {
 
 class Logger {
  private:
+  static std::atomic<int> _level;
+
  public:
   virtual bool ShouldLog(spdlog::level::level_enum log_level) = 0;
   virtual void Log(spdlog::source_loc loc, spdlog::level::level_enum lvl, std::string_view msg) = 0;
   static Logger& GetDidagleLogger();
   static void SetLogger(std::shared_ptr<Logger> logger);
+  /**
+   * @brief Runtime level checked before the logger is touched & arguments are evaluated, default 'trace' which leaves
+   * filtering to 'ShouldLog' of the installed logger.
+   */
+  static void SetLevel(spdlog::level::level_enum log_level) { _level.store(log_level, std::memory_order_relaxed); }
+  static inline bool IsEnabled(spdlog::level::level_enum log_level) {
+    return log_level >= _level.load(std::memory_order_relaxed);
+  }
   virtual ~Logger() {}
 };
 
@@ -37,19 +55,44 @@ class Spdlogger : public Logger {
 
 #define DIDAGLE_LOG(level, ...)                                                                                   \
   do {                                                                                                            \
-    if (didagle::Logger::GetDidagleLogger().ShouldLog(level)) {                                                   \
+    if (static_cast<int>(level) >= DIDAGLE_MIN_LOG_LEVEL && didagle::Logger::IsEnabled(level) &&                 \
+        didagle::Logger::GetDidagleLogger().ShouldLog(level)) {                                                   \
       std::string s = fmt::format(__VA_ARGS__);                                                                   \
       didagle::Logger::GetDidagleLogger().Log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level, s); \
     }                                                                                                             \
   } while (0)
 
+// arguments are still type checked while never evaluated
+#define DIDAGLE_LOG_DISABLED(...)         \
+  do {                                    \
+    if (false) {                          \
+      (void)fmt::format(__VA_ARGS__);     \
+    }                                     \
+  } while (0)
+
+#if DIDAGLE_MIN_LOG_LEVEL <= SPDLOG_LEVEL_ERROR
 #define DIDAGLE_ERROR(...) DIDAGLE_LOG(spdlog::level::err, __VA_ARGS__)
+#else
+#define DIDAGLE_ERROR(...) DIDAGLE_LOG_DISABLED(__VA_ARGS__)
+#endif
 
+#if DIDAGLE_MIN_LOG_LEVEL <= SPDLOG_LEVEL_WARN
 #define DIDAGLE_WARN(...) DIDAGLE_LOG(spdlog::level::warn, __VA_ARGS__)
+#else
+#define DIDAGLE_WARN(...) DIDAGLE_LOG_DISABLED(__VA_ARGS__)
+#endif
 
+#if DIDAGLE_MIN_LOG_LEVEL <= SPDLOG_LEVEL_INFO
 #define DIDAGLE_INFO(...) DIDAGLE_LOG(spdlog::level::info, __VA_ARGS__)
+#else
+#define DIDAGLE_INFO(...) DIDAGLE_LOG_DISABLED(__VA_ARGS__)
+#endif
 
+#if DIDAGLE_MIN_LOG_LEVEL <= SPDLOG_LEVEL_DEBUG
 #define DIDAGLE_DEBUG(...) DIDAGLE_LOG(spdlog::level::debug, __VA_ARGS__)
+#else
+#define DIDAGLE_DEBUG(...) DIDAGLE_LOG_DISABLED(__VA_ARGS__)
+#endif
 
 #define DIDAGLE_LOG_EVERY_N(level, n, ...)                                \
   do {                                                                    \
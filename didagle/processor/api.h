@@ -5,11 +5,14 @@
 #pragma once
 
 #include <fmt/core.h>
+#include <array>
 #include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -28,6 +31,7 @@
 
 #include "folly/FBVector.h"
 #include "folly/Likely.h"
+#include "folly/SharedMutex.h"
 #include "folly/container/F14Map.h"
 #include "folly/container/F14Set.h"
 #include "folly/futures/Future.h"
@@ -88,6 +92,67 @@ struct DataValue {
   }
 };
 
+/**
+ * @brief Thread-safe side table for data entries created while the graph is executing.
+ *
+ * The main data table is only mutated before execution, entries published with unregistered names afterwards go here.
+ * Entries are heap nodes never erased during the life of the table, 'Clear' only resets their values like 'Reset'
+ * does with the main table, so the pointers from 'Find' stay valid after the shard lock is released. Only the atomic
+ * 'val' of such a pointer could be accessed without the lock.
+ */
+class DynamicDataTable {
+ public:
+  inline bool Empty() const { return 0 == _size.load(std::memory_order_acquire); }
+  template <typename F>
+  inline bool Visit(const DIObjectKeyView &key, F &&f) const {
+    if (FOLLY_LIKELY(Empty())) {
+      return false;
+    }
+    const Shard &shard = GetShard(key);
+    std::shared_lock<folly::SharedMutex> guard(shard.mutex);
+    auto found = shard.table.find(key);
+    if (found == shard.table.end()) {
+      return false;
+    }
+    f(*(found->second));
+    return true;
+  }
+  template <typename F>
+  inline void Update(const DIObjectKeyView &key, F &&f) {
+    Shard &shard = GetShard(key);
+    std::unique_lock<folly::SharedMutex> guard(shard.mutex);
+    auto found = shard.table.find(key);
+    if (found == shard.table.end()) {
+      auto dv = std::make_unique<DataValue>();
+      dv->name = std::make_shared<std::string>(key.name.data(), key.name.size());
+      DIObjectKeyView new_key = {*(dv->name), key.id};
+      found = shard.table.emplace(new_key, std::move(dv)).first;
+      _size.fetch_add(1, std::memory_order_release);
+    }
+    f(*(found->second));
+  }
+  DataValue *Find(const DIObjectKeyView &key);
+  /**
+   * @brief reset values of all entries, the entries are kept.
+   */
+  void Clear();
+
+ private:
+  static constexpr size_t kShardNum = 16;
+  using Table = folly::F14FastMap<DIObjectKeyView, std::unique_ptr<DataValue>, DIObjectKeyViewHash, DIObjectKeyViewEqual>;
+  struct Shard {
+    mutable folly::SharedMutex mutex;
+    Table table;
+  };
+  inline const Shard &GetShard(const DIObjectKeyView &key) const {
+    return _shards[DIObjectKeyViewHash()(key) % kShardNum];
+  }
+  inline Shard &GetShard(const DIObjectKeyView &key) { return _shards[DIObjectKeyViewHash()(key) % kShardNum]; }
+  std::array<Shard, kShardNum> _shards;
+  // number of entries ever created
+  std::atomic<size_t> _size{0};
+};
+
 struct GraphDataGetOptions {
   unsigned int with_parent : 1;
   unsigned int with_di_container : 1;
@@ -116,7 +181,10 @@ class GraphDataContext {
   using DataArray = folly::fbvector<DataValue *>;
   DataTable _data_table;
   DataArray _data_array;
+  std::unique_ptr<DynamicDataTable> _dynamic_data;
   const GraphDataContext *_parent = nullptr;
+  // see 'GetDataVersion'
+  std::atomic<uint64_t> _data_version{0};
   std::unique_ptr<DAGEventTracker> _event_tracker;
   std::vector<const GraphDataContext *> _executed_childrens;
   google::protobuf::Arena *arena_ = nullptr;
@@ -155,22 +223,91 @@ class GraphDataContext {
     return nullptr;
   }
 
+  template <typename T>
+  static inline typename DIObjectTypeHelper<T>::read_type ReadDataValue(const DataValue &dv) {
+    using GetValueType = typename DIObjectTypeHelper<T>::read_type;
+    if constexpr (std::is_pointer<GetValueType>::value) {
+      return static_cast<GetValueType>(dv.val.load());
+      // NOCC:readability/braces(工具误报:大括号是存在的)
+    } else if constexpr (is_shared_ptr<GetValueType>::value) {
+      return std::static_pointer_cast<typename GetValueType::element_type>(dv._sval);
+    } else {
+      GetValueType *val = static_cast<GetValueType *>(dv.val.load());
+      if (nullptr != val) {
+        return *val;
+      }
+      GetValueType r = {};
+      return r;
+    }
+  }
+  template <typename T>
+  static inline void WriteDataValue(DataValue &dv, const T &v) {
+    using RT = typename std::remove_const<typename std::remove_pointer<T>::type>::type;
+    if constexpr (is_shared_ptr<T>::value) {
+      dv._sval = v;
+      dv.val = dv._sval.get();
+      // NOCC:readability/braces(工具误报:大括号是存在的)
+    } else if constexpr (is_shared_ptr<RT>::value && std::is_pointer_v<T>) {
+      dv._sval = *v;
+      dv.val = dv._sval.get();
+    } else {
+      dv.val.store(const_cast<void *>(static_cast<const void *>(v)));
+    }
+  }
+
  public:
   static GraphDataContextPtr New() {
     GraphDataContextPtr p(new GraphDataContext);
     return p;
   }
   ~GraphDataContext();
-  void SetParent(const GraphDataContext *p) { _parent = p; }
+  void SetParent(const GraphDataContext *p) {
+    _parent = p;
+    BumpDataVersion();
+  }
   const GraphDataContext *GetParent() { return _parent; }
   void ReserveChildCapacity(size_t n);
   void SetChild(const GraphDataContext *c, size_t idx);
   void SetReleaseClosure(DoneClosure &&f);
 
+  /**
+   * @brief Version bumped whenever a data name may resolve to another entry, i.e. an entry is created or gets its
+   * first value, a value is moved in or an executed child is attached. Versions of parents are included.
+   * Replacing the value of an entry does not bump it, cached entries should read 'val' on every access.
+   */
+  inline uint64_t GetDataVersion() const {
+    uint64_t version = _data_version.load(std::memory_order_acquire);
+    return nullptr == _parent ? version : version + _parent->GetDataVersion();
+  }
+  inline void BumpDataVersion() { _data_version.fetch_add(1, std::memory_order_release); }
+  /**
+   * @brief Entry of data looked up in the same order as 'Get' except the DI container, nullptr if not found.
+   * Entries of main & dynamic tables are never erased during the life of the context, while their values could be
+   * replaced, moved or reset.
+   */
+  template <typename T>
+  const DataValue *GetDataEntry(const std::string_view &name) {
+    DIObjectKeyView key = {name, DIContainer::GetTypeId<T>()};
+    return GetValue(key);
+  }
+
   uint32_t RegisterData(const DIObjectKey &id);
+  /**
+   * @brief slot index of a registered data entry, -1 if there is no such entry.
+   */
+  int32_t FindDataIdx(const DIObjectKeyView &key) const;
   int Move(const DIObjectKey &from, const DIObjectKey &to);
 
-  void DisableEntryCreation() { _disable_entry_creation = true; }
+  /**
+   * @brief disable data entry creation in the main table since the graph is executing while the creation is not
+   * thread-safe, entries with unregistered names are published into the concurrent dynamic table instead.
+   */
+  void DisableEntryCreation() {
+    _disable_entry_creation = true;
+    if (!_dynamic_data) {
+      _dynamic_data = std::make_unique<DynamicDataTable>();
+    }
+  }
 
   inline DAGEventTracker *GetEventTracker() const {
     if (_event_tracker) {
@@ -182,6 +319,7 @@ class GraphDataContext {
     return nullptr;
   }
   bool EnableEventTracker();
+  void DisableEventTracker() { _event_tracker.reset(); }
 
   void SetArena(google::protobuf::Arena *arena);
   void SetArena(std::unique_ptr<google::protobuf::Arena> &&arena);
@@ -228,27 +366,22 @@ class GraphDataContext {
     // auto found = _data_table.find(key);
     auto found = GetDataValue(key, idx);
     if (FOLLY_LIKELY(found != nullptr)) {
-      if constexpr (std::is_pointer<GetValueType>::value) {
-        GetValueType val = static_cast<GetValueType>(found->val.load());
-        if (nullptr != val) {
-          return val;
-        }
-        // NOCC:readability/braces(工具误报:大括号是存在的)
-      } else if constexpr (is_shared_ptr<GetValueType>::value) {
-        GetValueType val = std::static_pointer_cast<typename GetValueType::element_type>(found->_sval);
-        if (nullptr != val) {
-          return val;
-        }
-      } else {
-        GetValueType *val = static_cast<GetValueType *>(found->val.load());
-        if (nullptr != val) {
-          return *val;
-        }
+      r = ReadDataValue<T>(*found);
+      if (r) {
+        return r;
       }
       if (nullptr != exist_entry) {
         *exist_entry = true;
       }
       // return r;
+    } else if (FOLLY_UNLIKELY(nullptr != _dynamic_data)) {
+      bool dynamic_found = _dynamic_data->Visit(key, [&r](const DataValue &dv) { r = ReadDataValue<T>(dv); });
+      if (r) {
+        return r;
+      }
+      if (dynamic_found && nullptr != exist_entry) {
+        *exist_entry = true;
+      }
     }
     auto empty_execludes = std::make_unique<ExcludeGraphDataContextSet>();
     ExcludeGraphDataContextSet *new_excludes = excludes;
@@ -301,6 +434,9 @@ class GraphDataContext {
     DIObjectKeyView key = {name, id};
     // auto found = _data_table.find(key);
     auto found = GetDataValue(key, idx);
+    if (found == nullptr && nullptr != _dynamic_data && !_dynamic_data->Empty()) {
+      found = _dynamic_data->Find(key);
+    }
     if (found != nullptr) {
       if constexpr (std::is_pointer<MoveValueType>::value) {
         void *empty = nullptr;
@@ -355,39 +491,27 @@ class GraphDataContext {
     // auto found = _data_table.find(key);
     auto found = GetDataValue(key, idx);
     if (found != nullptr) {
-      if constexpr (is_shared_ptr<T>::value) {
-        found->_sval = v;
-        found->val = found->_sval.get();
-        // NOCC:readability/braces(工具误报:大括号是存在的)
-      } else if constexpr (is_shared_ptr<RT>::value && std::is_pointer_v<T>) {
-        found->_sval = *v;
-        found->val = found->_sval.get();
-      } else if constexpr (std::is_pointer_v<T>) {
-        found->val.store(const_cast<void *>(static_cast<const void *>(v)));
-      } else {
-        found->val.store(const_cast<void *>(static_cast<const void *>(v)));
+      bool first_value = nullptr == found->val.load(std::memory_order_relaxed);
+      WriteDataValue(*found, v);
+      if (first_value) {
+        BumpDataVersion();
       }
       return true;
     } else {
       if (_disable_entry_creation) {
-        return false;
+        if (nullptr == _dynamic_data) {
+          return false;
+        }
+        _dynamic_data->Update(key, [&v](DataValue &dv) { WriteDataValue(dv, v); });
+        BumpDataVersion();
+        return true;
       }
       auto dv = std::make_unique<DataValue>();
-      if constexpr (is_shared_ptr<T>::value) {
-        dv->_sval = v;
-        dv->val = dv->_sval.get();
-        // NOCC:readability/braces(工具误报:大括号是存在的)
-      } else if constexpr (is_shared_ptr<RT>::value && std::is_pointer_v<T>) {
-        dv->_sval = *v;
-        dv->val = dv->_sval.get();
-      } else if constexpr (std::is_pointer_v<T>) {
-        dv->val.store(const_cast<void *>(static_cast<const void *>(v)));
-      } else {
-        dv->val.store(const_cast<void *>(static_cast<const void *>(v)));
-      }
+      WriteDataValue(*dv, v);
       dv->name.reset(new std::string(name.data(), name.size()));
       DIObjectKeyView key = {*(dv->name), id};
       _data_table.emplace(key, std::move(dv));
+      BumpDataVersion();
       return true;
     }
   }
@@ -450,7 +574,14 @@ class Processor {
   // FieldInjectFuncTable _field_inject_table;
   // FieldEmitFuncTable _field_emit_table;
   std::vector<ResetFunc> _reset_funcs;
+  std::vector<ResetFunc> _params_reset_funcs;
   std::vector<PrepareFunc> _prepare_funcs;
+  // key of the params last applied by '_params_settings'
+  const Params *_applied_params = nullptr;
+  uint64_t _applied_params_version = 0;
+  uint64_t _params_version = 0;
+  bool _params_version_valid = false;
+  bool _keep_params_on_reset = false;
   GraphDataContext *_data_ctx = nullptr;
   std::string id_;
 
@@ -481,7 +612,9 @@ class Processor {
     return _output_ids.size();
   }
   size_t AddResetFunc(ResetFunc &&f);
+  size_t AddParamResetFunc(ResetFunc &&f);
   size_t AddPrepareFunc(PrepareFunc &&f);
+  void ApplyParams(const Params &args);
 
   GraphDataContext &GetDataContext() { return *_data_ctx; }
   google::protobuf::Arena *GetArena() { return _data_ctx->GetArena(); }
@@ -521,6 +654,21 @@ class Processor {
   int Setup(const Params &args);
   int Prepare(const Params &args);
   void Reset();
+  /**
+   * @brief Mark the params of next execution as identified by (params address, version),
+   * the 'GRAPH_PARAMS_*' setters would be skipped if the key equals to the last applied one.
+   * Without it, params are always reset to default & applied.
+   */
+  inline void SetParamsVersion(uint64_t version) {
+    _params_version = version;
+    _params_version_valid = true;
+  }
+  /**
+   * @brief 'Reset' restores 'PARAMS_*' to defaults unless 'keep' is true, then the applied values are kept until
+   * the params key changes, so that the setters are skipped across pooled executions as well. Processors must
+   * not modify 'PARAMS_*' in execution if kept.
+   */
+  inline void KeepParamsOnReset(bool keep) { _keep_params_on_reset = keep; }
   int Execute(const Params &args);
 #if ISPINE_HAS_COROUTINES
   Awaitable<int> CoroExecute(const Params &args);
@@ -677,98 +825,106 @@ struct ProcessorRegister {
   didagle::ParamsString PARAMS_##name = val;                                                            \
   size_t __PARAMS_##name##_code =                                                                       \
       RegisterParam(BOOST_PP_STRINGIZE(name), "string", val, txt, [this](const didagle::Params &args) { \
-        const auto &arg = args[BOOST_PP_STRINGIZE(name)];                                               \
+        static const didagle::ParamsKey __key(BOOST_PP_STRINGIZE(name));                                \
+        const auto &arg = args[__key];                                                                  \
         if (arg.IsString()) {                                                                           \
           PARAMS_##name = arg.String();                                                                 \
         }                                                                                               \
       });                                                                                               \
-  size_t __reset_PARAMS_##name##_code = AddResetFunc([this]() { PARAMS_##name = val; });
+  size_t __reset_PARAMS_##name##_code = AddParamResetFunc([this]() { PARAMS_##name = val; });
 
 #define GRAPH_PARAMS_string_vector(name, val, txt)                                                                    \
   std::vector<didagle::ParamsString> PARAMS_##name;                                                                   \
   size_t __PARAMS_##name##_code = RegisterParam(                                                                      \
       BOOST_PP_STRINGIZE(name), "vector<string>", BOOST_PP_STRINGIZE(val), txt, [this](const didagle::Params &args) { \
-        if (args.Contains(BOOST_PP_STRINGIZE(name))) {                                                                \
+        static const didagle::ParamsKey __key(BOOST_PP_STRINGIZE(name));                                              \
+        const auto &member = args[__key];                                                                             \
+        if (member.Valid()) {                                                                                         \
           PARAMS_##name.clear();                                                                                      \
-          const auto &member = args[BOOST_PP_STRINGIZE(name)];                                                        \
           for (size_t i = 0; i < member.Size(); i++) {                                                                \
             PARAMS_##name.emplace_back(member[i].String());                                                           \
           }                                                                                                           \
         }                                                                                                             \
       });                                                                                                             \
-  size_t __reset_PARAMS_##name##_code = AddResetFunc([this]() { PARAMS_##name = BOOST_PP_REMOVE_PARENS(val); });
+  size_t __reset_PARAMS_##name##_code = AddParamResetFunc([this]() { PARAMS_##name = BOOST_PP_REMOVE_PARENS(val); });
 
 #define GRAPH_PARAMS_int(name, val, txt)                                                                   \
   int64_t PARAMS_##name = val;                                                                             \
   size_t __PARAMS_##name##_code = RegisterParam(                                                           \
       BOOST_PP_STRINGIZE(name), "int", BOOST_PP_STRINGIZE(val), txt, [this](const didagle::Params &args) { \
-        const auto &arg = args[BOOST_PP_STRINGIZE(name)];                                                  \
+        static const didagle::ParamsKey __key(BOOST_PP_STRINGIZE(name));                                   \
+        const auto &arg = args[__key];                                                                     \
         if (arg.IsInt()) {                                                                                 \
           PARAMS_##name = arg.Int();                                                                       \
         }                                                                                                  \
       });                                                                                                  \
-  size_t __reset_PARAMS_##name##_code = AddResetFunc([this]() { PARAMS_##name = val; });
+  size_t __reset_PARAMS_##name##_code = AddParamResetFunc([this]() { PARAMS_##name = val; });
 
 #define GRAPH_PARAMS_int_vector(name, val, txt)                                                                    \
   std::vector<int64_t> PARAMS_##name;                                                                              \
   size_t __PARAMS_##name##_code = RegisterParam(                                                                   \
       BOOST_PP_STRINGIZE(name), "vector<int>", BOOST_PP_STRINGIZE(val), txt, [this](const didagle::Params &args) { \
-        if (args.Contains(BOOST_PP_STRINGIZE(name))) {                                                             \
+        static const didagle::ParamsKey __key(BOOST_PP_STRINGIZE(name));                                           \
+        const auto &member = args[__key];                                                                          \
+        if (member.Valid()) {                                                                                      \
           PARAMS_##name.clear();                                                                                   \
-          const auto &member = args[BOOST_PP_STRINGIZE(name)];                                                     \
           for (size_t i = 0; i < member.Size(); i++) {                                                             \
             PARAMS_##name.emplace_back(member[i].Int());                                                           \
           }                                                                                                        \
         }                                                                                                          \
       });                                                                                                          \
-  size_t __reset_PARAMS_##name##_code = AddResetFunc([this]() { PARAMS_##name = BOOST_PP_REMOVE_PARENS(val); });
+  size_t __reset_PARAMS_##name##_code = AddParamResetFunc([this]() { PARAMS_##name = BOOST_PP_REMOVE_PARENS(val); });
 
 #define GRAPH_PARAMS_bool(name, val, txt)                                                                   \
   bool PARAMS_##name = val;                                                                                 \
   size_t __PARAMS_##name##_code = RegisterParam(                                                            \
       BOOST_PP_STRINGIZE(name), "bool", BOOST_PP_STRINGIZE(val), txt, [this](const didagle::Params &args) { \
-        const auto &arg = args[BOOST_PP_STRINGIZE(name)];                                                   \
+        static const didagle::ParamsKey __key(BOOST_PP_STRINGIZE(name));                                    \
+        const auto &arg = args[__key];                                                                      \
         if (arg.IsBool()) {                                                                                 \
           PARAMS_##name = arg.Bool();                                                                       \
         }                                                                                                   \
       });                                                                                                   \
-  size_t __reset_PARAMS_##name##_code = AddResetFunc([this]() { PARAMS_##name = val; });
+  size_t __reset_PARAMS_##name##_code = AddParamResetFunc([this]() { PARAMS_##name = val; });
 
 #define GRAPH_PARAMS_bool_vector(name, val, txt)                                                                   \
   std::vector<bool> PARAMS_##name;                                                                                 \
   size_t __PARAMS_##name##_code = RegisterParam(                                                                   \
       BOOST_PP_STRINGIZE(name), "vector<int>", BOOST_PP_STRINGIZE(val), txt, [this](const didagle::Params &args) { \
-        if (args.Contains(BOOST_PP_STRINGIZE(name))) {                                                             \
+        static const didagle::ParamsKey __key(BOOST_PP_STRINGIZE(name));                                           \
+        const auto &member = args[__key];                                                                          \
+        if (member.Valid()) {                                                                                      \
           PARAMS_##name.clear();                                                                                   \
-          const auto &member = args[BOOST_PP_STRINGIZE(name)];                                                     \
           for (size_t i = 0; i < member.Size(); i++) {                                                             \
             PARAMS_##name.emplace_back(member[i].Bool());                                                          \
           }                                                                                                        \
         }                                                                                                          \
       });                                                                                                          \
-  size_t __reset_PARAMS_##name##_code = AddResetFunc([this]() { PARAMS_##name = BOOST_PP_REMOVE_PARENS(val); });
+  size_t __reset_PARAMS_##name##_code = AddParamResetFunc([this]() { PARAMS_##name = BOOST_PP_REMOVE_PARENS(val); });
 
 #define GRAPH_PARAMS_double(name, val, txt)                                                                   \
   double PARAMS_##name = val;                                                                                 \
   size_t __PARAMS_##name##_code = RegisterParam(                                                              \
       BOOST_PP_STRINGIZE(name), "double", BOOST_PP_STRINGIZE(val), txt, [this](const didagle::Params &args) { \
-        const auto &arg = args[BOOST_PP_STRINGIZE(name)];                                                     \
+        static const didagle::ParamsKey __key(BOOST_PP_STRINGIZE(name));                                      \
+        const auto &arg = args[__key];                                                                        \
         if (arg.IsDouble()) {                                                                                 \
           PARAMS_##name = arg.Double();                                                                       \
         }                                                                                                     \
       });                                                                                                     \
-  size_t __reset_PARAMS_##name##_code = AddResetFunc([this]() { PARAMS_##name = val; });
+  size_t __reset_PARAMS_##name##_code = AddParamResetFunc([this]() { PARAMS_##name = val; });
 
 #define GRAPH_PARAMS_double_vector(name, val, txt)                                                                    \
   std::vector<double> PARAMS_##name;                                                                                  \
   size_t __PARAMS_##name##_code = RegisterParam(                                                                      \
       BOOST_PP_STRINGIZE(name), "vector<double>", BOOST_PP_STRINGIZE(val), txt, [this](const didagle::Params &args) { \
-        if (args.Contains(BOOST_PP_STRINGIZE(name))) {                                                                \
+        static const didagle::ParamsKey __key(BOOST_PP_STRINGIZE(name));                                              \
+        const auto &member = args[__key];                                                                             \
+        if (member.Valid()) {                                                                                         \
           PARAMS_##name.clear();                                                                                      \
-          const auto &member = args[BOOST_PP_STRINGIZE(name)];                                                        \
           for (size_t i = 0; i < member.Size(); i++) {                                                                \
             PARAMS_##name.emplace_back(member[i].Double());                                                           \
           }                                                                                                           \
         }                                                                                                             \
       });                                                                                                             \
-  size_t __reset_PARAMS_##name##_code = AddResetFunc([this]() { PARAMS_##name = BOOST_PP_REMOVE_PARENS(val); });
+  size_t __reset_PARAMS_##name##_code = AddParamResetFunc([this]() { PARAMS_##name = BOOST_PP_REMOVE_PARENS(val); });
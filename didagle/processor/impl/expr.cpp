@@ -5,6 +5,7 @@
 
 #include "didagle/log/log.h"
 #include "didagle/processor/api.h"
+#include "didagle/processor/impl/expr_program.h"
 #include "folly/String.h"
 #include "gflags/gflags.h"
 
@@ -13,12 +14,141 @@
 DEFINE_int32(miss_expr_param_log_every_n, 1000, "txt");
 
 GRAPH_OP_BEGIN(didagle_expr)
+// binding of a compiled expression variable, valid until next reset
+struct VarSlot {
+  didagle::ExprValue::Type type = didagle::ExprValue::EXPR_ERROR;
+  // params bound to the var
+  const didagle::Params* params = nullptr;
+  const didagle::Params* root = nullptr;
+  // data entry bound to the var, its value is loaded on every evaluation since it could be replaced
+  const didagle::DataValue* entry = nullptr;
+  // single name vars are resolved to data before params, rebind them once the data version changes
+  uint64_t data_version = 0;
+  bool valid = false;
+};
 std::string _cond;  // NOLINT
 ssexpr::SpiritExpression _expr;
+didagle::ExprProgram _program;
+std::vector<VarSlot> _var_slots;
+bool _compiled = false;
 
 std::string_view GetString(didagle::Processor::GetStringMode mode) const override { return _cond; }
 
+didagle::ExprValue ReadParams(size_t idx, const didagle::Params* p) {
+  if (p->IsInt()) {
+    return didagle::ExprValue::Int(p->Int());
+  } else if (p->IsDouble()) {
+    return didagle::ExprValue::Double(p->Double());
+  } else if (p->IsBool()) {
+    return didagle::ExprValue::Bool(p->Bool());
+  } else if (p->IsString()) {
+    return didagle::ExprValue::String(std::string_view(p->String().data(), p->String().size()));
+  } else if (p->Valid()) {
+    return didagle::ExprValue::Object(p);
+  }
+  DIDAGLE_WARN_EVERY_N(FLAGS_miss_expr_param_log_every_n, "Param:{} is not exist, use 'false' as param value.",
+                       _program.GetVars()[idx].name);
+  return didagle::ExprValue::Bool(false);
+}
+
+static didagle::ExprValue ReadData(didagle::ExprValue::Type type, const void* ptr) {
+  switch (type) {
+    case didagle::ExprValue::EXPR_BOOL: {
+      return didagle::ExprValue::Bool(*static_cast<const bool*>(ptr));
+    }
+    case didagle::ExprValue::EXPR_STRING: {
+      return didagle::ExprValue::String(*static_cast<const std::string*>(ptr));
+    }
+    case didagle::ExprValue::EXPR_INT: {
+      return didagle::ExprValue::Int(*static_cast<const int64_t*>(ptr));
+    }
+    default: {
+      return didagle::ExprValue::Double(*static_cast<const double*>(ptr));
+    }
+  }
+}
+
+template <typename T>
+const T* BindData(const std::string& name, didagle::ExprValue::Type type, VarSlot& slot) {
+  const T* v = GetDataContext().Get<T>(name);
+  if (nullptr == v) {
+    return nullptr;
+  }
+  const didagle::DataValue* entry = GetDataContext().GetDataEntry<T>(name);
+  // values from DI container or behind an empty entry are not cached
+  slot.entry = (nullptr != entry && entry->val.load(std::memory_order_acquire) == v) ? entry : nullptr;
+  slot.type = type;
+  slot.params = nullptr;
+  slot.valid = nullptr != slot.entry;
+  return v;
+}
+
+bool BindDataVar(const std::string& name, VarSlot& slot, didagle::ExprValue& value) {
+  if (const bool* bv = BindData<bool>(name, didagle::ExprValue::EXPR_BOOL, slot)) {
+    value = didagle::ExprValue::Bool(*bv);
+  } else if (const std::string* s = BindData<std::string>(name, didagle::ExprValue::EXPR_STRING, slot)) {
+    value = didagle::ExprValue::String(*s);
+  } else if (const int64_t* iv = BindData<int64_t>(name, didagle::ExprValue::EXPR_INT, slot)) {
+    value = didagle::ExprValue::Int(*iv);
+  } else if (const double* dv = BindData<double>(name, didagle::ExprValue::EXPR_DOUBLE, slot)) {
+    value = didagle::ExprValue::Double(*dv);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+didagle::ExprValue ResolveVar(size_t idx, const didagle::Params& root) {
+  VarSlot& slot = _var_slots[idx];
+  const auto& var = _program.GetVars()[idx];
+  bool single_name = var.path.size() == 1;
+  uint64_t data_version = single_name ? GetDataContext().GetDataVersion() : 0;
+  if (slot.valid && slot.data_version == data_version) {
+    if (nullptr != slot.entry) {
+      const void* ptr = slot.entry->val.load(std::memory_order_acquire);
+      if (nullptr != ptr) {
+        return ReadData(slot.type, ptr);
+      }
+    } else if (slot.root == &root) {
+      return ReadParams(idx, slot.params);
+    }
+  }
+  slot.data_version = data_version;
+  didagle::ExprValue value;
+  if (single_name && BindDataVar(var.path[0], slot, value)) {
+    return value;
+  }
+  const didagle::Params* p = &root;
+  for (const auto& key : var.keys) {
+    p = &((*p)[key]);
+  }
+  slot.type = didagle::ExprValue::EXPR_PARAMS;
+  slot.params = p;
+  slot.root = &root;
+  slot.entry = nullptr;
+  slot.valid = true;
+  return ReadParams(idx, p);
+}
+
+int OnReset() override {
+  for (auto& slot : _var_slots) {
+    slot.valid = false;
+  }
+  return 0;
+}
+
 int OnSetup(const Params& args) override {
+  _cond = args.String();
+  if (0 == _program.Compile(_cond)) {
+    _compiled = true;
+    _var_slots.resize(_program.GetVars().size());
+    DIDAGLE_DEBUG("expression:{}, compiled into {} codes", _cond, _program.Size());
+    return 0;
+  }
+  return SetupSpiritExpression();
+}
+
+int SetupSpiritExpression() {
   ssexpr::ExprOptions opt;
   opt.dynamic_var_access = [this](const void* root, const std::vector<std::string>& args) -> ssexpr::Value {
     if (args.size() == 1) {
@@ -143,7 +273,6 @@ int OnSetup(const Params& args) override {
     return r;
   };
 
-  _cond = args.String();
   int rc = _expr.Init(_cond, opt);
   if (0 != rc) {
     DIDAGLE_ERROR("expression:{}, init failed with rc:{}", _cond, rc);
@@ -153,6 +282,16 @@ int OnSetup(const Params& args) override {
   return rc;
 }
 int OnExecute(const didagle::Params& args) override {
+  if (_compiled) {
+    didagle::ExprValue v = _program.Eval([this, &args](size_t idx) { return ResolveVar(idx, args); });
+    if (v.type == didagle::ExprValue::EXPR_BOOL) {
+      DIDAGLE_DEBUG("cond:{} eval result:{}", _cond, v.bv);
+      return v.bv ? 0 : -1;
+    }
+    DIDAGLE_WARN_EVERY_N(FLAGS_miss_expr_param_log_every_n, "cond:{} eval failed with result type:{}", _cond,
+                         static_cast<int>(v.type));
+    return -1;
+  }
   auto eval_val = _expr.EvalDynamic(args);
   try {
     bool r = std::get<bool>(eval_val);
@@ -0,0 +1,650 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include "didagle/processor/impl/expr_program.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+namespace didagle {
+
+struct ExprProgram::Node {
+  enum Kind {
+    N_CONST = 0,
+    N_VAR,
+    N_UNARY,
+    N_BINARY,
+    N_AND,
+    N_OR,
+    N_TO_BOOL,
+    N_HAS_PARAM,
+    N_HAS_VALUE,
+  };
+  Kind kind = N_CONST;
+  OpCode op = OP_CONST;
+  ExprValue value;
+  uint32_t arg = 0;
+  int left = -1;
+  int right = -1;
+};
+
+class ExprProgram::Parser {
+ public:
+  Parser(std::string_view expr, ExprProgram& program, std::vector<Node>& nodes)
+      : _expr(expr), _program(program), _nodes(nodes) {}
+
+  int Parse() {
+    int root = ParseOr();
+    if (root < 0) {
+      return -1;
+    }
+    SkipSpace();
+    if (_pos != _expr.size()) {
+      return -1;
+    }
+    return root;
+  }
+
+ private:
+  std::string_view _expr;
+  size_t _pos = 0;
+  ExprProgram& _program;
+  std::vector<Node>& _nodes;
+
+  void SkipSpace() {
+    while (_pos < _expr.size() && isspace(static_cast<unsigned char>(_expr[_pos]))) {
+      _pos++;
+    }
+  }
+  bool Consume(std::string_view token) {
+    SkipSpace();
+    if (_expr.substr(_pos, token.size()) == token) {
+      _pos += token.size();
+      return true;
+    }
+    return false;
+  }
+  int NewNode(Node::Kind kind, OpCode op, int left, int right) {
+    Node node;
+    node.kind = kind;
+    node.op = op;
+    node.left = left;
+    node.right = right;
+    _nodes.emplace_back(node);
+    return static_cast<int>(_nodes.size() - 1);
+  }
+  int NewConst(const ExprValue& v) {
+    int idx = NewNode(Node::N_CONST, OP_CONST, -1, -1);
+    _nodes[idx].value = v;
+    return idx;
+  }
+
+  int ParseOr() {
+    int left = ParseAnd();
+    while (left >= 0 && Consume("||")) {
+      int right = ParseAnd();
+      if (right < 0) {
+        return -1;
+      }
+      left = NewNode(Node::N_OR, OP_OR_JMP, left, right);
+    }
+    return left;
+  }
+  int ParseAnd() {
+    int left = ParseEquality();
+    while (left >= 0 && Consume("&&")) {
+      int right = ParseEquality();
+      if (right < 0) {
+        return -1;
+      }
+      left = NewNode(Node::N_AND, OP_AND_JMP, left, right);
+    }
+    return left;
+  }
+  int ParseEquality() {
+    int left = ParseRelational();
+    while (left >= 0) {
+      OpCode op;
+      if (Consume("==")) {
+        op = OP_EQ;
+      } else if (Consume("!=")) {
+        op = OP_NE;
+      } else {
+        break;
+      }
+      int right = ParseRelational();
+      if (right < 0) {
+        return -1;
+      }
+      left = NewNode(Node::N_BINARY, op, left, right);
+    }
+    return left;
+  }
+  int ParseRelational() {
+    int left = ParseAdditive();
+    while (left >= 0) {
+      OpCode op;
+      if (Consume("<=")) {
+        op = OP_LE;
+      } else if (Consume(">=")) {
+        op = OP_GE;
+      } else if (Consume("<")) {
+        op = OP_LT;
+      } else if (Consume(">")) {
+        op = OP_GT;
+      } else {
+        break;
+      }
+      int right = ParseAdditive();
+      if (right < 0) {
+        return -1;
+      }
+      left = NewNode(Node::N_BINARY, op, left, right);
+    }
+    return left;
+  }
+  int ParseAdditive() {
+    int left = ParseMultiplicative();
+    while (left >= 0) {
+      OpCode op;
+      if (Consume("+")) {
+        op = OP_ADD;
+      } else if (Consume("-")) {
+        op = OP_SUB;
+      } else {
+        break;
+      }
+      int right = ParseMultiplicative();
+      if (right < 0) {
+        return -1;
+      }
+      left = NewNode(Node::N_BINARY, op, left, right);
+    }
+    return left;
+  }
+  int ParseMultiplicative() {
+    int left = ParseUnary();
+    while (left >= 0) {
+      OpCode op;
+      if (Consume("*")) {
+        op = OP_MUL;
+      } else if (Consume("/")) {
+        op = OP_DIV;
+      } else if (Consume("%")) {
+        op = OP_MOD;
+      } else {
+        break;
+      }
+      int right = ParseUnary();
+      if (right < 0) {
+        return -1;
+      }
+      left = NewNode(Node::N_BINARY, op, left, right);
+    }
+    return left;
+  }
+  int ParseUnary() {
+    if (Consume("!")) {
+      int operand = ParseUnary();
+      return operand < 0 ? -1 : NewNode(Node::N_UNARY, OP_NOT, operand, -1);
+    }
+    if (Consume("-")) {
+      int operand = ParseUnary();
+      return operand < 0 ? -1 : NewNode(Node::N_UNARY, OP_NEG, operand, -1);
+    }
+    return ParsePrimary();
+  }
+  int ParsePrimary() {
+    SkipSpace();
+    if (_pos >= _expr.size()) {
+      return -1;
+    }
+    char ch = _expr[_pos];
+    if (ch == '(') {
+      _pos++;
+      int node = ParseOr();
+      if (node < 0 || !Consume(")")) {
+        return -1;
+      }
+      return node;
+    }
+    if (ch == '$') {
+      return ParseVar();
+    }
+    if (ch == '"' || ch == '\'') {
+      return ParseString(ch);
+    }
+    if (isdigit(static_cast<unsigned char>(ch)) || ch == '.') {
+      return ParseNumber();
+    }
+    if (isalpha(static_cast<unsigned char>(ch)) || ch == '_') {
+      return ParseIdentifier();
+    }
+    return -1;
+  }
+  int ParseVar() {
+    _pos++;  // skip '$'
+    size_t start = _pos;
+    while (_pos < _expr.size() && (isalnum(static_cast<unsigned char>(_expr[_pos])) || _expr[_pos] == '_' ||
+                                   _expr[_pos] == '.')) {
+      _pos++;
+    }
+    ExprProgram::Var var;
+    var.name = std::string(_expr.substr(start, _pos - start));
+    size_t begin = 0;
+    while (begin <= var.name.size()) {
+      size_t end = var.name.find('.', begin);
+      if (end == std::string::npos) {
+        end = var.name.size();
+      }
+      if (end == begin) {
+        return -1;
+      }
+      var.path.emplace_back(var.name.substr(begin, end - begin));
+      var.keys.emplace_back(ParamsKey(var.path.back()));
+      begin = end + 1;
+    }
+    uint32_t var_idx = static_cast<uint32_t>(_program._vars.size());
+    for (size_t i = 0; i < _program._vars.size(); i++) {
+      if (_program._vars[i].name == var.name) {
+        var_idx = static_cast<uint32_t>(i);
+        break;
+      }
+    }
+    if (var_idx == _program._vars.size()) {
+      _program._vars.emplace_back(std::move(var));
+    }
+    int node = NewNode(Node::N_VAR, OP_VAR, -1, -1);
+    _nodes[node].arg = var_idx;
+    return node;
+  }
+  int ParseString(char quote) {
+    _pos++;
+    size_t start = _pos;
+    while (_pos < _expr.size() && _expr[_pos] != quote) {
+      if (_expr[_pos] == '\\') {
+        return -1;
+      }
+      _pos++;
+    }
+    if (_pos >= _expr.size()) {
+      return -1;
+    }
+    _program._strings.emplace_back(_expr.substr(start, _pos - start));
+    _pos++;
+    return NewConst(ExprValue::String(_program._strings.back()));
+  }
+  int ParseNumber() {
+    size_t start = _pos;
+    bool is_double = false;
+    while (_pos < _expr.size()) {
+      char ch = _expr[_pos];
+      if (isdigit(static_cast<unsigned char>(ch))) {
+        _pos++;
+      } else if (ch == '.' || ch == 'e' || ch == 'E') {
+        is_double = true;
+        _pos++;
+        if ((ch == 'e' || ch == 'E') && _pos < _expr.size() && (_expr[_pos] == '-' || _expr[_pos] == '+')) {
+          _pos++;
+        }
+      } else {
+        break;
+      }
+    }
+    std::string literal(_expr.substr(start, _pos - start));
+    char* end = nullptr;
+    errno = 0;
+    if (is_double) {
+      double v = strtod(literal.c_str(), &end);
+      if (errno != 0 || *end != '\0') {
+        return -1;
+      }
+      return NewConst(ExprValue::Double(v));
+    }
+    long long v = strtoll(literal.c_str(), &end, 10);
+    if (errno != 0 || *end != '\0') {
+      return -1;
+    }
+    return NewConst(ExprValue::Int(static_cast<int64_t>(v)));
+  }
+  int ParseIdentifier() {
+    size_t start = _pos;
+    while (_pos < _expr.size() && (isalnum(static_cast<unsigned char>(_expr[_pos])) || _expr[_pos] == '_')) {
+      _pos++;
+    }
+    std::string_view ident = _expr.substr(start, _pos - start);
+    if (ident == "true") {
+      return NewConst(ExprValue::Bool(true));
+    }
+    if (ident == "false") {
+      return NewConst(ExprValue::Bool(false));
+    }
+    if (ident != "has_param" && ident != "has_value") {
+      return -1;
+    }
+    if (!Consume("(")) {
+      return -1;
+    }
+    int first = ParseOr();
+    if (first < 0 || !Consume(",")) {
+      return -1;
+    }
+    int second = ParseOr();
+    if (second < 0 || !Consume(")")) {
+      return -1;
+    }
+    if (ident == "has_value") {
+      return NewNode(Node::N_HAS_VALUE, OP_HAS_VALUE, first, second);
+    }
+    // the param name must be a constant string, which is bound to a ParamsKey here
+    second = _program.Fold(_nodes, second);
+    if (_nodes[second].kind != Node::N_CONST || _nodes[second].value.type != ExprValue::EXPR_STRING) {
+      return -1;
+    }
+    int node = NewNode(Node::N_HAS_PARAM, OP_HAS_PARAM, first, -1);
+    _nodes[node].arg = static_cast<uint32_t>(_program._param_keys.size());
+    _program._param_keys.emplace_back(ParamsKey(ParamsString(_nodes[second].value.sv)));
+    return node;
+  }
+};
+
+ExprValue ExprProgram::ToBool(const ExprValue& v) {
+  switch (v.type) {
+    case ExprValue::EXPR_BOOL: {
+      return v;
+    }
+    case ExprValue::EXPR_INT: {
+      return ExprValue::Bool(v.iv != 0);
+    }
+    case ExprValue::EXPR_DOUBLE: {
+      return ExprValue::Bool(v.dv != 0);
+    }
+    default: {
+      return ExprValue();
+    }
+  }
+}
+
+ExprValue ExprProgram::Unary(OpCode op, const ExprValue& v) {
+  if (op == OP_NOT) {
+    ExprValue b = ToBool(v);
+    if (b.IsError()) {
+      return b;
+    }
+    return ExprValue::Bool(!b.bv);
+  }
+  if (v.type == ExprValue::EXPR_INT) {
+    return ExprValue::Int(-v.iv);
+  }
+  if (v.type == ExprValue::EXPR_DOUBLE) {
+    return ExprValue::Double(-v.dv);
+  }
+  return ExprValue();
+}
+
+namespace {
+template <typename T>
+ExprValue CompareValues(int op, const T& left, const T& right, int op_eq) {
+  switch (op - op_eq) {
+    case 0:
+      return ExprValue::Bool(left == right);
+    case 1:
+      return ExprValue::Bool(left != right);
+    case 2:
+      return ExprValue::Bool(left < right);
+    case 3:
+      return ExprValue::Bool(left <= right);
+    case 4:
+      return ExprValue::Bool(left > right);
+    case 5:
+      return ExprValue::Bool(left >= right);
+    default:
+      return ExprValue();
+  }
+}
+inline bool IsNumber(const ExprValue& v) {
+  return v.type == ExprValue::EXPR_INT || v.type == ExprValue::EXPR_DOUBLE;
+}
+inline double AsDouble(const ExprValue& v) {
+  return v.type == ExprValue::EXPR_INT ? static_cast<double>(v.iv) : v.dv;
+}
+}  // namespace
+
+ExprValue ExprProgram::Binary(OpCode op, const ExprValue& left, const ExprValue& right) {
+  if (left.IsError() || right.IsError()) {
+    return ExprValue();
+  }
+  if (op >= OP_EQ && op <= OP_GE) {
+    if (left.type == ExprValue::EXPR_INT && right.type == ExprValue::EXPR_INT) {
+      return CompareValues(op, left.iv, right.iv, OP_EQ);
+    }
+    if (IsNumber(left) && IsNumber(right)) {
+      return CompareValues(op, AsDouble(left), AsDouble(right), OP_EQ);
+    }
+    if (left.type == ExprValue::EXPR_STRING && right.type == ExprValue::EXPR_STRING) {
+      return CompareValues(op, left.sv, right.sv, OP_EQ);
+    }
+    if (left.type == ExprValue::EXPR_BOOL && right.type == ExprValue::EXPR_BOOL) {
+      return CompareValues(op, left.bv, right.bv, OP_EQ);
+    }
+    return ExprValue();
+  }
+  if (!IsNumber(left) || !IsNumber(right)) {
+    return ExprValue();
+  }
+  if (left.type == ExprValue::EXPR_INT && right.type == ExprValue::EXPR_INT) {
+    switch (op) {
+      case OP_ADD:
+        return ExprValue::Int(left.iv + right.iv);
+      case OP_SUB:
+        return ExprValue::Int(left.iv - right.iv);
+      case OP_MUL:
+        return ExprValue::Int(left.iv * right.iv);
+      case OP_DIV:
+        return right.iv == 0 ? ExprValue() : ExprValue::Int(left.iv / right.iv);
+      case OP_MOD:
+        return right.iv == 0 ? ExprValue() : ExprValue::Int(left.iv % right.iv);
+      default:
+        return ExprValue();
+    }
+  }
+  double l = AsDouble(left);
+  double r = AsDouble(right);
+  switch (op) {
+    case OP_ADD:
+      return ExprValue::Double(l + r);
+    case OP_SUB:
+      return ExprValue::Double(l - r);
+    case OP_MUL:
+      return ExprValue::Double(l * r);
+    case OP_DIV:
+      return r == 0 ? ExprValue() : ExprValue::Double(l / r);
+    case OP_MOD:
+      return r == 0 ? ExprValue() : ExprValue::Double(fmod(l, r));
+    default:
+      return ExprValue();
+  }
+}
+
+ExprValue ExprProgram::HasParam(const ExprValue& params, uint32_t key_idx) const {
+  if (params.type != ExprValue::EXPR_PARAMS || nullptr == params.pv) {
+    return ExprValue::Bool(false);
+  }
+  return ExprValue::Bool(params.pv->Contains(_param_keys[key_idx]));
+}
+
+ExprValue ExprProgram::HasValue(const ExprValue& params, const ExprValue& v) {
+  if (params.type != ExprValue::EXPR_PARAMS || nullptr == params.pv) {
+    return ExprValue::Bool(false);
+  }
+  const Params& array = *params.pv;
+  for (size_t i = 0; i < array.Size(); i++) {
+    const Params& p = array[i];
+    bool exist = false;
+    switch (v.type) {
+      case ExprValue::EXPR_INT: {
+        exist = (p.Int() == v.iv);
+        break;
+      }
+      case ExprValue::EXPR_STRING: {
+        exist = (std::string_view(p.String().data(), p.String().size()) == v.sv);
+        break;
+      }
+      case ExprValue::EXPR_DOUBLE: {
+        exist = (p.Double() == v.dv);
+        break;
+      }
+      case ExprValue::EXPR_BOOL: {
+        exist = (p.Bool() == v.bv);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    if (exist) {
+      return ExprValue::Bool(true);
+    }
+  }
+  return ExprValue::Bool(false);
+}
+
+uint32_t ExprProgram::AddConst(const ExprValue& v) {
+  _consts.emplace_back(v);
+  return static_cast<uint32_t>(_consts.size() - 1);
+}
+
+int ExprProgram::Fold(std::vector<Node>& nodes, int idx) {
+  Node& node = nodes[idx];
+  if (node.left >= 0) {
+    node.left = Fold(nodes, node.left);
+  }
+  if (node.right >= 0) {
+    node.right = Fold(nodes, node.right);
+  }
+  auto is_const = [&nodes](int i) { return i >= 0 && nodes[i].kind == Node::N_CONST; };
+  switch (node.kind) {
+    case Node::N_UNARY: {
+      if (is_const(node.left)) {
+        node.value = Unary(node.op, nodes[node.left].value);
+        node.kind = Node::N_CONST;
+      }
+      break;
+    }
+    case Node::N_TO_BOOL: {
+      if (is_const(node.left)) {
+        node.value = ToBool(nodes[node.left].value);
+        node.kind = Node::N_CONST;
+      }
+      break;
+    }
+    case Node::N_BINARY: {
+      if (is_const(node.left) && is_const(node.right)) {
+        node.value = Binary(node.op, nodes[node.left].value, nodes[node.right].value);
+        node.kind = Node::N_CONST;
+      }
+      break;
+    }
+    case Node::N_AND:
+    case Node::N_OR: {
+      if (is_const(node.left)) {
+        ExprValue v = ToBool(nodes[node.left].value);
+        if (v.IsError() || (node.kind == Node::N_AND) != v.bv) {
+          node.value = v;
+          node.kind = Node::N_CONST;
+        } else {
+          // result is decided by the right side only
+          node.kind = Node::N_TO_BOOL;
+          node.left = node.right;
+          node.right = -1;
+          return Fold(nodes, idx);
+        }
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+  if (node.kind == Node::N_CONST) {
+    node.left = -1;
+    node.right = -1;
+  }
+  return idx;
+}
+
+int ExprProgram::Emit(const std::vector<Node>& nodes, int idx, size_t depth, size_t& max_depth) {
+  const Node& node = nodes[idx];
+  max_depth = std::max(max_depth, depth + 1);
+  switch (node.kind) {
+    case Node::N_CONST: {
+      _codes.emplace_back(Code{OP_CONST, AddConst(node.value)});
+      break;
+    }
+    case Node::N_VAR: {
+      _codes.emplace_back(Code{OP_VAR, node.arg});
+      break;
+    }
+    case Node::N_UNARY: {
+      Emit(nodes, node.left, depth, max_depth);
+      _codes.emplace_back(Code{node.op, 0});
+      break;
+    }
+    case Node::N_TO_BOOL: {
+      Emit(nodes, node.left, depth, max_depth);
+      _codes.emplace_back(Code{OP_TO_BOOL, 0});
+      break;
+    }
+    case Node::N_HAS_PARAM: {
+      Emit(nodes, node.left, depth, max_depth);
+      _codes.emplace_back(Code{OP_HAS_PARAM, node.arg});
+      break;
+    }
+    case Node::N_BINARY:
+    case Node::N_HAS_VALUE: {
+      Emit(nodes, node.left, depth, max_depth);
+      Emit(nodes, node.right, depth + 1, max_depth);
+      _codes.emplace_back(Code{node.op, 0});
+      break;
+    }
+    case Node::N_AND:
+    case Node::N_OR: {
+      Emit(nodes, node.left, depth, max_depth);
+      size_t jmp = _codes.size();
+      _codes.emplace_back(Code{node.op, 0});
+      Emit(nodes, node.right, depth, max_depth);
+      _codes.emplace_back(Code{OP_TO_BOOL, 0});
+      _codes[jmp].arg = static_cast<uint32_t>(_codes.size());
+      break;
+    }
+    default: {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int ExprProgram::Compile(std::string_view expr) {
+  _codes.clear();
+  _consts.clear();
+  _param_keys.clear();
+  _strings.clear();
+  _vars.clear();
+  std::vector<Node> nodes;
+  Parser parser(expr, *this, nodes);
+  int root = parser.Parse();
+  if (root < 0) {
+    return -1;
+  }
+  root = Fold(nodes, root);
+  size_t max_depth = 0;
+  if (0 != Emit(nodes, root, 0, max_depth)) {
+    return -1;
+  }
+  _stack.resize(max_depth);
+  return 0;
+}
+
+}  // namespace didagle
@@ -0,0 +1,201 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#pragma once
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "didagle/graph/params.h"
+
+namespace didagle {
+
+struct ExprValue {
+  enum Type : uint8_t {
+    EXPR_ERROR = 0,
+    EXPR_BOOL,
+    EXPR_INT,
+    EXPR_DOUBLE,
+    EXPR_STRING,
+    EXPR_PARAMS,
+  };
+  Type type = EXPR_ERROR;
+  union {
+    bool bv;
+    int64_t iv;
+    double dv;
+    const Params* pv;
+  };
+  std::string_view sv;
+
+  ExprValue() : iv(0) {}
+  static ExprValue Bool(bool v) {
+    ExprValue r;
+    r.type = EXPR_BOOL;
+    r.bv = v;
+    return r;
+  }
+  static ExprValue Int(int64_t v) {
+    ExprValue r;
+    r.type = EXPR_INT;
+    r.iv = v;
+    return r;
+  }
+  static ExprValue Double(double v) {
+    ExprValue r;
+    r.type = EXPR_DOUBLE;
+    r.dv = v;
+    return r;
+  }
+  static ExprValue String(std::string_view v) {
+    ExprValue r;
+    r.type = EXPR_STRING;
+    r.sv = v;
+    return r;
+  }
+  static ExprValue Object(const Params* v) {
+    ExprValue r;
+    r.type = EXPR_PARAMS;
+    r.pv = v;
+    return r;
+  }
+  bool IsError() const { return type == EXPR_ERROR; }
+};
+
+/**
+ * @brief Condition expression compiled into a flat stack bytecode.
+ * Supports literals, '$a.b' variables, '! -', arithmetic, comparisons, '&& ||', parentheses,
+ * 'has_param' & 'has_value'; constant sub expressions are folded at compile time.
+ * 'Compile' fails on any other syntax so that caller could fallback to a generic evaluator.
+ * Evaluation does not allocate, variables are resolved by the caller via var index.
+ */
+class ExprProgram {
+ public:
+  struct Var {
+    std::string name;  // full name without '$'
+    std::vector<std::string> path;
+    std::vector<ParamsKey> keys;
+  };
+
+  int Compile(std::string_view expr);
+  const std::vector<Var>& GetVars() const { return _vars; }
+  size_t Size() const { return _codes.size(); }
+
+  /**
+   * @brief Evaluate with 'resolve(size_t var_idx) -> ExprValue'.
+   */
+  template <typename Resolver>
+  ExprValue Eval(Resolver&& resolve);
+
+ private:
+  enum OpCode : uint8_t {
+    OP_CONST = 0,
+    OP_VAR,
+    OP_NOT,
+    OP_NEG,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_EQ,
+    OP_NE,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+    OP_TO_BOOL,
+    // pop the top if it is true, otherwise keep it & jump
+    OP_AND_JMP,
+    // pop the top if it is false, otherwise keep it & jump
+    OP_OR_JMP,
+    OP_HAS_PARAM,
+    OP_HAS_VALUE,
+  };
+  struct Code {
+    OpCode op;
+    uint32_t arg = 0;
+  };
+  struct Node;
+  class Parser;
+
+  std::vector<Code> _codes;
+  std::vector<ExprValue> _consts;
+  std::vector<ParamsKey> _param_keys;
+  std::deque<std::string> _strings;
+  std::vector<Var> _vars;
+  std::vector<ExprValue> _stack;
+
+  static ExprValue Unary(OpCode op, const ExprValue& v);
+  static ExprValue Binary(OpCode op, const ExprValue& left, const ExprValue& right);
+  static ExprValue ToBool(const ExprValue& v);
+  static ExprValue HasValue(const ExprValue& params, const ExprValue& v);
+  ExprValue HasParam(const ExprValue& params, uint32_t key_idx) const;
+
+  uint32_t AddConst(const ExprValue& v);
+  int Fold(std::vector<Node>& nodes, int idx);
+  int Emit(const std::vector<Node>& nodes, int idx, size_t depth, size_t& max_depth);
+};
+
+template <typename Resolver>
+ExprValue ExprProgram::Eval(Resolver&& resolve) {
+  ExprValue* stack = _stack.data();
+  size_t top = 0;
+  const size_t n = _codes.size();
+  for (size_t pc = 0; pc < n; pc++) {
+    const Code& code = _codes[pc];
+    switch (code.op) {
+      case OP_CONST: {
+        stack[top++] = _consts[code.arg];
+        break;
+      }
+      case OP_VAR: {
+        stack[top++] = resolve(static_cast<size_t>(code.arg));
+        break;
+      }
+      case OP_NOT:
+      case OP_NEG: {
+        stack[top - 1] = Unary(code.op, stack[top - 1]);
+        break;
+      }
+      case OP_TO_BOOL: {
+        stack[top - 1] = ToBool(stack[top - 1]);
+        break;
+      }
+      case OP_AND_JMP:
+      case OP_OR_JMP: {
+        ExprValue v = ToBool(stack[top - 1]);
+        if (v.IsError() || (code.op == OP_AND_JMP) != v.bv) {
+          stack[top - 1] = v;
+          pc = code.arg - 1;
+        } else {
+          top--;
+        }
+        break;
+      }
+      case OP_HAS_PARAM: {
+        stack[top - 1] = HasParam(stack[top - 1], code.arg);
+        break;
+      }
+      case OP_HAS_VALUE: {
+        stack[top - 2] = HasValue(stack[top - 2], stack[top - 1]);
+        top--;
+        break;
+      }
+      default: {
+        stack[top - 2] = Binary(code.op, stack[top - 2], stack[top - 1]);
+        top--;
+        break;
+      }
+    }
+  }
+  if (top != 1) {
+    return ExprValue();
+  }
+  return stack[0];
+}
+
+}  // namespace didagle
@@ -3,6 +3,7 @@
 #include "didagle/processor/processor.h"
 #include <stdlib.h>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,6 +25,30 @@ CreatorTable &GetCreatorTable() {
   return *g_creator_table;
 }
 
+DataValue *DynamicDataTable::Find(const DIObjectKeyView &key) {
+  if (Empty()) {
+    return nullptr;
+  }
+  Shard &shard = GetShard(key);
+  std::shared_lock<folly::SharedMutex> guard(shard.mutex);
+  auto found = shard.table.find(key);
+  if (found == shard.table.end()) {
+    return nullptr;
+  }
+  return found->second.get();
+}
+void DynamicDataTable::Clear() {
+  if (Empty()) {
+    return;
+  }
+  for (auto &shard : _shards) {
+    std::unique_lock<folly::SharedMutex> guard(shard.mutex);
+    for (auto &entry : shard.table) {
+      entry.second->Reset();
+    }
+  }
+}
+
 bool GraphDataContext::EnableEventTracker() {
   if (!_event_tracker) {
     _event_tracker = std::make_unique<DAGEventTracker>();
@@ -61,6 +86,10 @@ void GraphDataContext::Reset() {
     _executed_childrens[i] = nullptr;
   }
   _disable_entry_creation = false;
+  if (_dynamic_data) {
+    _dynamic_data->Clear();
+  }
+  BumpDataVersion();
   if (user_ctx_destroy_) {
     user_ctx_destroy_(user_ctx_);
     user_ctx_ = nullptr;
@@ -88,6 +117,12 @@ DataValue *GraphDataContext::GetValue(const DIObjectKeyView &key, GraphDataGetOp
   if (found != _data_table.end()) {
     return found->second.get();
   }
+  if (nullptr != _dynamic_data) {
+    DataValue *dynamic_value = _dynamic_data->Find(key);
+    if (nullptr != dynamic_value) {
+      return dynamic_value;
+    }
+  }
   std::unique_ptr<ExcludeGraphDataContextSet> empty_execludes = std::make_unique<ExcludeGraphDataContextSet>();
   ExcludeGraphDataContextSet *new_excludes = excludes;
   if (nullptr == new_excludes) {
@@ -136,6 +171,7 @@ int GraphDataContext::Move(const DIObjectKey &from, const DIObjectKey &to) {
   to_value->_sval = from_value->_sval;
   from_value->val.store(nullptr);
   from_value->_sval.reset();
+  BumpDataVersion();
   return 0;
 }
 
@@ -149,6 +185,7 @@ void GraphDataContext::SetChild(const GraphDataContext *c, size_t idx) {
     return;
   }
   _executed_childrens[idx] = c;
+  BumpDataVersion();
 }
 uint32_t GraphDataContext::RegisterData(const DIObjectKey &id) {
   auto dv = std::make_unique<DataValue>();
@@ -165,6 +202,13 @@ uint32_t GraphDataContext::RegisterData(const DIObjectKey &id) {
     return found->second->_idx;
   }
 }
+int32_t GraphDataContext::FindDataIdx(const DIObjectKeyView &key) const {
+  auto found = _data_table.find(key);
+  if (found == _data_table.end()) {
+    return -1;
+  }
+  return static_cast<int32_t>(found->second->_idx);
+}
 
 ProcessorFactory g_processor_factory;
 Processor::~Processor() {}
@@ -180,35 +224,52 @@ void Processor::Reset() {
   for (auto &reset : _reset_funcs) {
     reset();
   }
+  if (!_keep_params_on_reset) {
+    for (auto &reset : _params_reset_funcs) {
+      reset();
+    }
+    _applied_params = nullptr;
+  }
   _data_ctx = nullptr;
 }
-int Processor::Execute(const Params &args) {
+void Processor::ApplyParams(const Params &args) {
+  bool cacheable = _params_version_valid;
+  _params_version_valid = false;
+  if (cacheable && _applied_params == &args && _applied_params_version == _params_version) {
+    return;
+  }
+  for (auto &reset : _params_reset_funcs) {
+    reset();
+  }
   for (auto &f : _params_settings) {
     f(args);
   }
+  if (cacheable) {
+    _applied_params = &args;
+    _applied_params_version = _params_version;
+  } else {
+    _applied_params = nullptr;
+  }
+}
+int Processor::Execute(const Params &args) {
+  ApplyParams(args);
   return OnExecute(args);
 }
 
 #if ISPINE_HAS_COROUTINES
 Awaitable<int> Processor::CoroExecute(const Params &args) {
-  for (auto &f : _params_settings) {
-    f(args);
-  }
+  ApplyParams(args);
   co_return co_await OnCoroExecute(args);
 }
 #endif
 
 folly::Future<int> Processor::FutureExecute(const Params &args) {
-  for (auto &f : _params_settings) {
-    f(args);
-  }
+  ApplyParams(args);
   return OnFutureExecute(args);
 }
 
 AdaptiveWait<int> Processor::AExecute(const Params &args) {
-  for (auto &f : _params_settings) {
-    f(args);
-  }
+  ApplyParams(args);
   co_return co_await OnAExecute(args);
 }
 
@@ -228,6 +289,10 @@ size_t Processor::AddResetFunc(ResetFunc &&f) {
   _reset_funcs.emplace_back(f);
   return _reset_funcs.size();
 }
+size_t Processor::AddParamResetFunc(ResetFunc &&f) {
+  _params_reset_funcs.emplace_back(f);
+  return _params_reset_funcs.size();
+}
 size_t Processor::AddPrepareFunc(PrepareFunc &&f) {
   _prepare_funcs.emplace_back(f);
   return _prepare_funcs.size();
@@ -249,6 +314,30 @@ Processor *ProcessorFactory::GetProcessor(const std::string &name) {
   }
   return nullptr;
 }
+std::shared_ptr<const ProcessorMeta> ProcessorFactory::GetProcessorMeta(const std::string &name) {
+  typedef std::unordered_map<std::string, std::shared_ptr<const ProcessorMeta>> MetaTable;
+  static std::mutex *meta_mutex = new std::mutex;
+  static MetaTable *meta_table = new MetaTable;
+  std::lock_guard<std::mutex> guard(*meta_mutex);
+  auto found = meta_table->find(name);
+  if (found != meta_table->end()) {
+    return found->second;
+  }
+  Processor *p = GetProcessor(name);
+  if (nullptr == p) {
+    return nullptr;
+  }
+  auto meta = std::make_shared<ProcessorMeta>();
+  meta->name = name;
+  meta->input = p->GetInputIds();
+  meta->output = p->GetOutputIds();
+  meta->params = p->GetParams();
+  meta->desc = p->Desc();
+  meta->isIOProcessor = p->isIOProcessor();
+  delete p;
+  meta_table->emplace(name, meta);
+  return meta;
+}
 void ProcessorFactory::GetAllMetas(std::vector<ProcessorMeta> &all_metas) {
   for (auto &pair : GetCreatorTable()) {
     ProcessorMeta meta;
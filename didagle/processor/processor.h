@@ -35,6 +35,10 @@ class ProcessorFactory {
     return Register(name, creator);
   }
   static Processor* GetProcessor(const std::string& name);
+  /**
+   * @brief meta of registered processor, created once & cached, nullptr if not registered.
+   */
+  static std::shared_ptr<const ProcessorMeta> GetProcessorMeta(const std::string& name);
   static void GetAllMetas(std::vector<ProcessorMeta>& metas);
   static int DumpAllMetas(const std::string& file = "all_processors.json");
 };
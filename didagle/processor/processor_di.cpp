@@ -3,11 +3,60 @@
 #include "didagle/processor/processor_di.h"
 #include <fmt/core.h>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include "didagle/log/log.h"
 
 namespace didagle {
+int32_t DataVarBindings::Register(std::string_view var, uint32_t type_id) {
+  for (size_t i = 0; i < _bindings.size(); i++) {
+    if (_bindings[i].var == var && _bindings[i].type_id == type_id) {
+      return static_cast<int32_t>(i);
+    }
+  }
+  Binding binding;
+  binding.var = std::string(var);
+  binding.type_id = type_id;
+  std::string_view rest = var;
+  while (true) {
+    auto pos = rest.find('.');
+    std::string_view part = rest.substr(0, pos);
+    binding.path.emplace_back(ParamsKey(ParamsString(part.data(), part.size())));
+    if (pos == std::string_view::npos) {
+      break;
+    }
+    rest = rest.substr(pos + 1);
+  }
+  _bindings.emplace_back(std::move(binding));
+  _bind_version = 0;
+  return static_cast<int32_t>(_bindings.size() - 1);
+}
+void DataVarBindings::Bind(const Params* params, uint64_t params_version, const GraphDataContext& ctx) {
+  if (0 != params_version && params_version == _bind_version) {
+    return;
+  }
+  _bind_version = params_version;
+  for (auto& binding : _bindings) {
+    binding.data_name.clear();
+    binding.data_idx = -1;
+    if (nullptr == params) {
+      continue;
+    }
+    const Params* var_params = params;
+    for (const ParamsKey& key : binding.path) {
+      var_params = &(var_params->Get(key));
+    }
+    const ParamsString& data_name = var_params->String();
+    DIDAGLE_DEBUG("Bind var:{} to data name:{}", binding.var, data_name);
+    if (data_name.empty()) {
+      continue;
+    }
+    binding.data_name.assign(data_name.data(), data_name.size());
+    binding.data_idx = ctx.FindDataIdx(DIObjectKeyView{binding.data_name, binding.type_id});
+  }
+}
+
 ProcessorDI::ProcessorDI(Processor* proc, bool strict_dsl) : _proc(proc), _strict_dsl(strict_dsl) {}
 int ProcessorDI::SetupInputOutputIds(const std::vector<FieldInfo>& fields, const std::vector<GraphData>& config_fields,
                                      FieldDataArray& ids) {
@@ -51,6 +100,46 @@ int ProcessorDI::PrepareOutputs(const std::vector<GraphData>& config_outputs) {
   _output_ids.clear();
   return SetupInputOutputIds(_proc->GetOutputIds(), config_outputs, _output_ids);
 }
+void ProcessorDI::SetupDataVars(DataVarBindings& bindings, const std::vector<const Params*>& local_params) {
+  auto setup_vars = [&](FieldDataArray& ids) {
+    for (auto& entry : ids) {
+      const std::string& name = entry.info.name;
+      if (name.empty() || name[0] != '$') {
+        continue;
+      }
+      if (nullptr != entry.data && !entry.data->aggregate.empty()) {
+        continue;
+      }
+      std::string_view var = std::string_view(name).substr(1);
+      std::string_view root = var.substr(0, var.find('.'));
+      bool shadowed = false;
+      for (const Params* params : local_params) {
+        if (nullptr != params && params->Contains(ParamsString(root.data(), root.size()))) {
+          shadowed = true;
+          break;
+        }
+      }
+      if (!shadowed) {
+        entry.var_idx = bindings.Register(var, entry.info.id);
+      }
+    }
+  };
+  setup_vars(_input_ids);
+  setup_vars(_output_ids);
+  _var_bindings = &bindings;
+}
+std::string_view ProcessorDI::GetDataName(const FieldData& entry, const Params* params, int32_t& idx) const {
+  if (entry.var_idx >= 0 && nullptr != _var_bindings) {
+    const DataVarBindings::Binding& binding = _var_bindings->Get(entry.var_idx);
+    idx = binding.data_idx;
+    return binding.data_name;
+  }
+  idx = -1;
+  ParamsString var_name = entry.info.name.substr(1);
+  const Params& var_value = params->GetVar(var_name);
+  DIDAGLE_DEBUG("Get Var value:{} for {}", var_value.String(), entry.info.name);
+  return std::string_view(var_value.String().data(), var_value.String().size());
+}
 int ProcessorDI::InjectInputs(GraphDataContext& ctx, const Params* params) {
   for (const auto& entry : _input_ids) {
     const std::string& field = entry.name;
@@ -96,13 +185,11 @@ int ProcessorDI::InjectInputs(GraphDataContext& ctx, const Params* params) {
         move_data = entry.info.flags.is_in_out;
       }
       if (!data.name.empty() && data.name[0] == '$' && nullptr != params) {
-        ParamsString var_name = data.name.substr(1);
-        const Params& var_value = params->GetVar(var_name);
-        DIDAGLE_DEBUG("Get Var value:{} for {}", var_value.String(), data.name);
-        if (!var_value.String().empty()) {
-          std::string_view data_name(var_value.String().data(), var_value.String().size());
+        int32_t data_idx = -1;
+        std::string_view data_name = GetDataName(entry, params, data_idx);
+        if (!data_name.empty()) {
           // rc = _proc->InjectInputField(ctx, field, data_name, move_data);
-          rc = entry.info.inject(ctx, entry.idx, data_name, move_data);
+          rc = entry.info.inject(ctx, data_idx, data_name, move_data);
         } else {
           rc = -1;
           if (required) {
@@ -140,22 +227,20 @@ int ProcessorDI::CollectOutputs(GraphDataContext& ctx, const Params* params) {
     const std::string& field = entry.name;
     const DIObjectKey& data = entry.info;
     if (!data.name.empty() && data.name[0] == '$' && nullptr != params) {
-      ParamsString var_name = data.name.substr(1);
-      const Params& var_value = params->GetVar(var_name);
-      DIDAGLE_DEBUG("Get Var value:{} for {}", var_value.String(), data.name);
-      if (!var_value.String().empty()) {
-        std::string_view data_name(var_value.String().data(), var_value.String().size());
+      int32_t data_idx = -1;
+      std::string_view data_name = GetDataName(entry, params, data_idx);
+      if (!data_name.empty()) {
         DIDAGLE_DEBUG("[{}]Collect output for field {}:{} with actual name:{}", _proc->Name(), field, data.name,
                       data_name);
         // int rc = _proc->EmitOutputField(ctx, field, data_name);
-        int rc = entry.info.emit(ctx, entry.idx, data_name);
+        int rc = entry.info.emit(ctx, data_idx, data_name);
         if (0 != rc) {
           DIDAGLE_ERROR("[{}]Collect output for field {}:{} failed with actual name:{}", _proc->Name(), field,
                         data.name, data_name);
         }
       } else {
         DIDAGLE_ERROR("[{}]Collect output for field {}:{} failed with var name:{}", _proc->Name(), field, data.name,
-                      var_name);
+                      data.name.substr(1));
       }
       continue;
     }
@@ -6,12 +6,40 @@
 #pragma once
 #include <map>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "didagle/processor/processor.h"
 #include "folly/FBVector.h"
 namespace didagle {
+/**
+ * @brief '$var' data names used by the vertices of a graph, resolved against the execute params once per request.
+ */
+class DataVarBindings {
+ public:
+  struct Binding {
+    std::string var;  // var name without '$'
+    std::vector<ParamsKey> path;
+    uint32_t type_id = 0;
+    // resolved data name, empty if the var is missing in execute params. owned since bindings are kept across
+    // requests with equal params while the params of last request could be released
+    std::string data_name;
+    int32_t data_idx = -1;
+  };
+  int32_t Register(std::string_view var, uint32_t type_id);
+  /**
+   * @brief resolve all vars with 'params', skipped if 'params_version' is the same as last bind(0 never matches).
+   */
+  void Bind(const Params* params, uint64_t params_version, const GraphDataContext& ctx);
+  inline const Binding& Get(int32_t idx) const { return _bindings[idx]; }
+  inline bool Empty() const { return _bindings.empty(); }
+
+ private:
+  std::vector<Binding> _bindings;
+  uint64_t _bind_version = 0;
+};
+
 class ProcessorDI {
  public:
   struct FieldData {
@@ -19,6 +47,8 @@ class ProcessorDI {
     FieldInfo info;
     const GraphData* data = nullptr;
     int32_t idx = -1;
+    // index in DataVarBindings for '$var' data name, -1 if resolved per execution
+    int32_t var_idx = -1;
     explicit FieldData(const FieldInfo& id) {
       name = id.name;
       info = id;
@@ -35,8 +65,10 @@ class ProcessorDI {
 
   FieldDataArray _input_ids;
   FieldDataArray _output_ids;
+  const DataVarBindings* _var_bindings = nullptr;
   int SetupInputOutputIds(const std::vector<FieldInfo>& fields, const std::vector<GraphData>& config_fields,
                           FieldDataArray& field_ids);
+  std::string_view GetDataName(const FieldData& entry, const Params* params, int32_t& idx) const;
 
  public:
   explicit ProcessorDI(Processor* proc, bool strict_dsl = false);
@@ -44,6 +76,11 @@ class ProcessorDI {
   FieldDataArray& GetOutputIds() { return _output_ids; }
   int PrepareInputs(const std::vector<GraphData>& config_inputs = {});
   int PrepareOutputs(const std::vector<GraphData>& config_outputs = {});
+  /**
+   * @brief register '$var' data names into graph level 'bindings', vars whose root is shadowed by any of
+   * 'local_params' are still resolved with the execute params of vertex.
+   */
+  void SetupDataVars(DataVarBindings& bindings, const std::vector<const Params*>& local_params);
   int InjectInputs(GraphDataContext& ctx, const Params* params);
   int CollectOutputs(GraphDataContext& ctx, const Params* params);
   int MoveDataWhenSkipped(GraphDataContext& ctx);
@@ -4,6 +4,33 @@
 
 namespace didagle {
 
+uint64_t GraphClusterContext::NextExecuteParamsVersion() {
+  static std::atomic<uint64_t> version{0};
+  return version.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+bool ConfigSettingMemo::Get(const Key& key, uint8_t& result) {
+  std::lock_guard<std::mutex> guard(mutex);
+  auto found = results.find(key);
+  if (found == results.end()) {
+    return false;
+  }
+  result = found->second;
+  return true;
+}
+void ConfigSettingMemo::Put(const Key& key, uint8_t result) {
+  std::lock_guard<std::mutex> guard(mutex);
+  results[key] = result;
+}
+void ConfigSettingMemo::Clear() {
+  std::lock_guard<std::mutex> guard(mutex);
+  results.clear();
+}
+
+void GraphClusterContext::SetExecuteParams(const Params* p) {
+  _exec_params = p;
+  _exec_params_version = (nullptr == p) ? 0 : NextExecuteParamsVersion();
+}
+
 GraphContext* GraphClusterContext::GetRunGraph(const std::string& name) {
   if (nullptr != _running_graph) {
     return _running_graph;
@@ -26,14 +53,20 @@ GraphContext* GraphClusterContext::GetRunGraph(const std::string& name) {
 void GraphClusterContext::Reset() {
   _end_ustime = 0;
   _exec_params = nullptr;
+  _exec_params_version = 0;
   if (nullptr != _running_graph) {
     _running_graph->Reset();
     _running_graph = nullptr;
   }
-  for (auto& item : _config_settings) {
-    item.eval_proc->Reset();
-    item.result = 0;
+  for (size_t i = 0; i < _config_settings.size(); i++) {
+    _config_settings[i].eval_proc->Reset();
+    _config_settings[i].result = 0;
+    _config_setting_states[i].store(0, std::memory_order_relaxed);
+  }
+  if (_shared_config_memo == &_config_memo) {
+    _config_memo.Clear();
   }
+  _shared_config_memo = &_config_memo;
   _extern_data_ctx = nullptr;
   _running_cluster.reset();
 }
@@ -42,7 +75,11 @@ int GraphClusterContext::Setup(GraphCluster* c) {
   if (!_cluster) {
     return -1;
   }
-
+  // allocated before any early return since 'Reset' touches states of every pushed config setting
+  _config_setting_states.reset(new std::atomic<uint8_t>[c->config_setting.size()]);
+  for (size_t i = 0; i < c->config_setting.size(); i++) {
+    _config_setting_states[i].store(0, std::memory_order_relaxed);
+  }
   for (const auto& cfg : c->config_setting) {
     Processor* p = ProcessorFactory::GetProcessor(cfg.processor);
     if (nullptr == p && c->strict_dsl) {
@@ -54,10 +91,13 @@ int GraphClusterContext::Setup(GraphCluster* c) {
       args.SetString(cfg.cond);
       if (0 != p->Setup(args)) {
         DIDAGLE_ERROR("Failed to setup expr processor", cfg.processor);
+        delete p;
         return -1;
       }
       ConfigSettingContext item;
       item.eval_proc = p;
+      item.name = cfg.name;
+      item.lazy = cfg._lazy;
       _config_settings.push_back(item);
     }
   }
@@ -85,61 +125,117 @@ int GraphClusterContext::Execute(const std::string& graph, DoneClosure&& done, G
   GraphDataContext& data_ctx = g->GetGraphDataContextRef();
   DIDAGLE_DEBUG("config setting size = {}", _config_settings.size());
   for (size_t i = 0; i < _config_settings.size(); i++) {
-    Processor* p = _config_settings[i].eval_proc;
-    p->SetDataContext(g->GetGraphDataContext());
-
-    int eval_rc = 0;
-    if (nullptr != _exec_params) {
-      eval_rc = p->Execute(*_exec_params);
-    } else {
-      Params args;
-      eval_rc = p->Execute(args);
-    }
-    if (0 != eval_rc) {
-      _config_settings[i].result = 0;
-    } else {
-      _config_settings[i].result = 1;
+    if (_config_settings[i].lazy) {
+      // evaluated on first reference by GetConfigSettingResult
+      continue;
     }
+    _config_settings[i].result = EvalConfigSetting(i);
+    _config_setting_states[i].store(_config_settings[i].result + 1, std::memory_order_release);
     bool* v = reinterpret_cast<bool*>(&_config_settings[i].result);
-    data_ctx.Set(_cluster->config_setting[i].name, v);
+    data_ctx.Set(_config_settings[i].name, v);
   }
 
   /**
    * @brief diable data entry creation since the graph is executing while the
-   * creation is not thread-safe.
+   * creation is not thread-safe, dynamic named data would be published into a concurrent side table.
    */
   data_ctx.DisableEntryCreation();
   DAGEventTracker* tracker = data_ctx.GetEventTracker();
   if (nullptr != tracker) {
-    auto event = std::make_unique<DAGEvent>();
-    event->start_ustime = start_exec_ustime;
-    event->end_ustime = ustime();
-    event->phase = PhaseType::DAG_GRAPH_GRAPH_PREPARE_EXECUTE;
-    tracker->Add(std::move(event));
+    DAGEventRecord record;
+    record.scope = reinterpret_cast<uintptr_t>(g);
+    record.start_ustime = start_exec_ustime;
+    record.end_ustime = ustime();
+    record.phase = PhaseType::DAG_GRAPH_GRAPH_PREPARE_EXECUTE;
+    tracker->Add(record);
   }
   return g->Execute(std::move(done));
 }
 
+uint8_t GraphClusterContext::EvalConfigSetting(size_t idx) {
+  Processor* p = _config_settings[idx].eval_proc;
+  p->SetDataContext(_running_graph->GetGraphDataContext());
+  int eval_rc = 0;
+  if (nullptr != _exec_params) {
+    eval_rc = p->Execute(*_exec_params);
+  } else {
+    static const Params empty_args;
+    eval_rc = p->Execute(empty_args);
+  }
+  return 0 == eval_rc ? 1 : 0;
+}
+
+int GraphClusterContext::FindConfigSetting(std::string_view name) const {
+  for (size_t i = 0; i < _config_settings.size(); i++) {
+    if (_config_settings[i].name == name) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool GraphClusterContext::GetConfigSettingResult(size_t idx) {
+  uint8_t state = _config_setting_states[idx].load(std::memory_order_acquire);
+  if (state != 0) {
+    return state == 2;
+  }
+  std::lock_guard<std::mutex> guard(_config_setting_mutex);
+  state = _config_setting_states[idx].load(std::memory_order_acquire);
+  if (state != 0) {
+    return state == 2;
+  }
+  ConfigSettingMemo::Key key;
+  key.cluster = _cluster;
+  key.idx = idx;
+  key.params = _exec_params;
+  key.params_version = _exec_params_version;
+  uint8_t result = 0;
+  if (!_shared_config_memo->Get(key, result)) {
+    result = EvalConfigSetting(idx);
+    _shared_config_memo->Put(key, result);
+  }
+  _config_settings[idx].result = result;
+  _config_setting_states[idx].store(result + 1, std::memory_order_release);
+  return result != 0;
+}
+
 GraphClusterContext::~GraphClusterContext() {
   for (auto& item : _config_settings) {
     delete item.eval_proc;
   }
 }
 
+VertexLatencyStats* GraphClusterContext::GetLatencyStats(const Vertex* v) const {
+  if (nullptr == _latency_stats || _latency_stats->empty()) {
+    return nullptr;
+  }
+  auto found = _latency_stats->find(v);
+  if (found == _latency_stats->end()) {
+    return nullptr;
+  }
+  return found->second.get();
+}
+
 GraphClusterContext* GraphClusterHandle::GetContext(GraphStore* store, GraphExecuteOptionsPtr options) {
   GraphClusterContext* ctx = nullptr;
   if (contexts.try_dequeue(ctx)) {
     return ctx;
   }
   ctx = new GraphClusterContext(store, options);
-  ctx->Setup(&cluster);
+  ctx->SetLatencyStats(&latency_stats);
+  if (0 != ctx->Setup(&cluster)) {
+    DIDAGLE_ERROR("Failed to setup context of cluster:{}", cluster._name);
+    delete ctx;
+    return nullptr;
+  }
+  created_contexts.fetch_add(1, std::memory_order_relaxed);
   return ctx;
 }
 void GraphClusterHandle::ReleaseContext(GraphClusterContext* p) {
   p->Reset();
   contexts.enqueue(p);
 }
-int GraphClusterHandle::Build(GraphStore* store, GraphExecuteOptionsPtr options) {
+int GraphClusterHandle::Build(GraphStore* store, GraphExecuteOptionsPtr options, bool prewarm) {
   if (0 != cluster.Build()) {
     DIDAGLE_ERROR("Failed to build toml script:{}", cluster._name);
     return -1;
@@ -151,12 +247,81 @@ int GraphClusterHandle::Build(GraphStore* store, GraphExecuteOptionsPtr options)
     }
     ctx.Reset();
   }
-  for (int i = 0; i < cluster.default_context_pool_size; i++) {
+  if (options->vertex_latency_stats) {
+    for (auto& [_, g] : cluster._graphs) {
+      for (auto& node : g->_nodes) {
+        latency_stats[node.second] = std::make_unique<VertexLatencyStats>();
+      }
+    }
+  }
+  if (options->critical_path_stats) {
+    for (auto& [_, g] : cluster._graphs) {
+      auto graph_stats = std::make_unique<GraphCriticalPathStats>();
+      build_critical_path_vertex_index(*g, graph_stats->vertex_index);
+      critical_path_stats.graphs[g] = std::move(graph_stats);
+      for (auto& node : g->_nodes) {
+        critical_path_stats.vertexs[node.second] = std::make_unique<VertexCriticalPathStats>();
+      }
+    }
+  }
+  if (prewarm) {
+    PrewarmContexts(store, options);
+  }
+  return 0;
+}
+void GraphClusterHandle::PrewarmContexts(GraphStore* store, GraphExecuteOptionsPtr options, int64_t count) {
+  if (count < 0) {
+    count = cluster.default_context_pool_size;
+  }
+  int64_t created = 0;
+  for (int64_t i = 0; i < count; i++) {
     GraphClusterContext* ctx = new GraphClusterContext(store, options);
-    ctx->Setup(&cluster);
+    ctx->SetLatencyStats(&latency_stats);
+    if (0 != ctx->Setup(&cluster)) {
+      DIDAGLE_ERROR("Failed to setup context of cluster:{}", cluster._name);
+      delete ctx;
+      break;
+    }
     contexts.enqueue(ctx);
+    created++;
+  }
+  created_contexts.fetch_add(created, std::memory_order_relaxed);
+}
+void GraphClusterHandle::GetLatencyStats(std::vector<VertexLatencySnapshot>& snapshots) const {
+  for (const auto& [v, stats] : latency_stats) {
+    VertexLatencySnapshot snapshot;
+    snapshot.cluster = cluster._name;
+    snapshot.graph = v->_graph->name;
+    snapshot.vertex = v->id;
+    for (int i = 0; i < VERTEX_LATENCY_PHASE_NUM; i++) {
+      snapshot.phases[i] = stats->phases[i].Snapshot();
+    }
+    snapshot.dispatch_queue_depth = stats->dispatch_queue_depth.Snapshot();
+    snapshots.emplace_back(std::move(snapshot));
+  }
+}
+void GraphClusterHandle::GetCriticalPathReport(CriticalPathReport& report) const {
+  for (const auto& [g, stats] : critical_path_stats.graphs) {
+    CriticalPathReport::GraphEntry entry;
+    entry.cluster = cluster._name;
+    entry.graph = g->name;
+    entry.samples = stats->samples.load(std::memory_order_relaxed);
+    entry.wall_us = stats->wall_us.load(std::memory_order_relaxed);
+    entry.exec_us = stats->exec_us.load(std::memory_order_relaxed);
+    entry.sched_us = stats->sched_us.load(std::memory_order_relaxed);
+    report.graphs.emplace_back(std::move(entry));
+  }
+  for (const auto& [v, stats] : critical_path_stats.vertexs) {
+    CriticalPathReport::VertexEntry entry;
+    entry.cluster = cluster._name;
+    entry.graph = v->_graph->name;
+    entry.vertex = v->id;
+    entry.samples = stats->samples.load(std::memory_order_relaxed);
+    entry.critical_count = stats->critical_count.load(std::memory_order_relaxed);
+    entry.slack_us = stats->slack_us.load(std::memory_order_relaxed);
+    entry.critical_exec_us = stats->critical_exec_us.load(std::memory_order_relaxed);
+    report.vertexs.emplace_back(std::move(entry));
   }
-  return 0;
 }
 GraphClusterHandle::~GraphClusterHandle() {
   GraphClusterContext* ctx = nullptr;
@@ -9,6 +9,7 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <string_view>
@@ -16,7 +17,10 @@
 #include <unordered_set>
 #include <vector>
 
+#include "folly/hash/Hash.h"
+
 #include "didagle/store/common.h"
+#include "didagle/store/critical_path.h"
 #include "didagle/store/graph_context.h"
 
 namespace didagle {
@@ -24,36 +28,102 @@ namespace didagle {
 struct ConfigSettingContext {
   Processor* eval_proc = nullptr;
   uint8_t result = 0;
+  std::string name;
+  bool lazy = false;
+};
+
+/**
+ * @brief Results of lazy config settings evaluated in one request, shared by the root cluster context
+ * and all its subgraph cluster contexts. The data context is not part of the key since lazy config settings
+ * only read execute params, never graph data.
+ */
+struct ConfigSettingMemo {
+  struct Key {
+    const GraphCluster* cluster = nullptr;
+    size_t idx = 0;
+    const Params* params = nullptr;
+    uint64_t params_version = 0;
+    bool operator==(const Key& other) const {
+      return cluster == other.cluster && idx == other.idx && params == other.params &&
+             params_version == other.params_version;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& k) const {
+      return folly::hash::hash_combine(k.cluster, k.idx, k.params, k.params_version);
+    }
+  };
+  std::mutex mutex;
+  folly::F14FastMap<Key, uint8_t, KeyHash> results;
+
+  bool Get(const Key& key, uint8_t& result);
+  void Put(const Key& key, uint8_t result);
+  void Clear();
 };
 struct GraphClusterHandle;
 class GraphStore;
+using VertexLatencyStatsTable = folly::F14FastMap<const Vertex*, std::unique_ptr<VertexLatencyStats>>;
 class GraphClusterContext {
  private:
   GraphStore* _store;
   GraphExecuteOptionsPtr _exec_opts;
   const Params* _exec_params = nullptr;
+  uint64_t _exec_params_version = 0;
   std::shared_ptr<GraphClusterHandle> _running_cluster;
   GraphContext* _running_graph = nullptr;
   GraphContext* _last_runnin_graph = nullptr;
   GraphCluster* _cluster = nullptr;
   std::vector<ConfigSettingContext> _config_settings;
+  // 0: not evaluated, 1: false, 2: true
+  std::unique_ptr<std::atomic<uint8_t>[]> _config_setting_states;
+  std::mutex _config_setting_mutex;
+  ConfigSettingMemo _config_memo;
+  ConfigSettingMemo* _shared_config_memo = nullptr;
   folly::F14FastMap<std::string, std::shared_ptr<GraphContext>> _graph_context_table;
   DoneClosure _done;
   GraphDataContext* _extern_data_ctx = nullptr;
   uint64_t _end_ustime = 0;
+  const VertexLatencyStatsTable* _latency_stats = nullptr;
+
+  uint8_t EvalConfigSetting(size_t idx);
 
  public:
-  GraphClusterContext(GraphStore* store, GraphExecuteOptionsPtr exec_opts) : _store(store), _exec_opts(exec_opts) {}
+  GraphClusterContext(GraphStore* store, GraphExecuteOptionsPtr exec_opts)
+      : _store(store), _exec_opts(exec_opts), _shared_config_memo(&_config_memo) {}
   inline GraphStore* GetStore() { return _store; }
   inline GraphExecuteOptionsPtr GetGraphExecuteOptions() { return _exec_opts; }
   inline void SetExternGraphDataContext(GraphDataContext* p) { _extern_data_ctx = p; }
   inline uint64_t GetEndTime() { return _end_ustime; }
   inline void SetEndTime(const uint64_t end_ustime) { _end_ustime = end_ustime; }
-  inline void SetExecuteParams(const Params* p) { _exec_params = p; }
+  /**
+   * @brief Set params of current execution, every non null params gets a new version
+   * so that processors could tell whether their applied params are still valid.
+   */
+  void SetExecuteParams(const Params* p);
+  inline void SetExecuteParams(const Params* p, uint64_t version) {
+    _exec_params = p;
+    _exec_params_version = version;
+  }
   inline const Params* GetExecuteParams() const { return _exec_params; }
+  inline uint64_t GetExecuteParamsVersion() const { return _exec_params_version; }
+  static uint64_t NextExecuteParamsVersion();
   inline GraphCluster* GetCluster() { return _cluster; }
-  inline void SetRunningCluster(std::shared_ptr<GraphClusterHandle> c) { _running_cluster = c; }
+  inline void SetRunningCluster(std::shared_ptr<GraphClusterHandle> c) { _running_cluster = std::move(c); }
   inline std::shared_ptr<GraphClusterHandle> GetRunningCluster() { return _running_cluster; }
+  // graph selected by 'Execute', nullptr if not executing
+  inline const GraphContext* GetRunningGraph() const { return _running_graph; }
+  inline void SetLatencyStats(const VertexLatencyStatsTable* stats) { _latency_stats = stats; }
+  VertexLatencyStats* GetLatencyStats(const Vertex* v) const;
+  inline ConfigSettingMemo* GetConfigSettingMemo() { return _shared_config_memo; }
+  inline void SetConfigSettingMemo(ConfigSettingMemo* memo) { _shared_config_memo = memo; }
+  /**
+   * @brief Index of config setting by name, -1 if not found.
+   */
+  int FindConfigSetting(std::string_view name) const;
+  /**
+   * @brief Result of config setting, lazy config setting is evaluated on first call.
+   */
+  bool GetConfigSettingResult(size_t idx);
   GraphContext* GetRunGraph(const std::string& name);
   int Setup(GraphCluster* c);
   void Reset();
@@ -66,9 +136,29 @@ struct GraphClusterHandle {
   GraphCluster cluster;
   using ContextPool = folly::UMPMCQueue<GraphClusterContext*, false>;
   ContextPool contexts;
+  // built if 'GraphExecuteOptions::vertex_latency_stats' is enabled, shared by all contexts
+  VertexLatencyStatsTable latency_stats;
+  // built if 'GraphExecuteOptions::critical_path_stats' is enabled
+  CriticalPathStatsTable critical_path_stats;
+  // hash of the DSL content, 0 if not loaded from DSL
+  uint64_t content_hash = 0;
+  // number of contexts created by this version, the peak concurrency
+  std::atomic<int64_t> created_contexts{0};
+  // compiled from a TaskGroup, evicted by the least recent 'last_used_ustime' beyond the limit
+  bool task_group = false;
+  std::atomic<uint64_t> last_used_ustime{0};
   GraphClusterContext* GetContext(GraphStore* store, GraphExecuteOptionsPtr options);
   void ReleaseContext(GraphClusterContext* p);
-  int Build(GraphStore* store, GraphExecuteOptionsPtr options);
+  /**
+   * @brief build & verify the cluster, then fill the context pool unless 'prewarm' is false.
+   */
+  int Build(GraphStore* store, GraphExecuteOptionsPtr options, bool prewarm = true);
+  /**
+   * @brief fill the context pool with 'count' contexts, 'default_context_pool_size' if negative.
+   */
+  void PrewarmContexts(GraphStore* store, GraphExecuteOptionsPtr options, int64_t count = -1);
+  void GetLatencyStats(std::vector<VertexLatencySnapshot>& snapshots) const;
+  void GetCriticalPathReport(CriticalPathReport& report) const;
   ~GraphClusterHandle();
 };
 
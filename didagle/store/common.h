@@ -34,11 +34,13 @@
 #include <functional>
 #include <memory>
 
+#include "folly/Executor.h"
 #include "folly/synchronization/Latch.h"
 
 #include "didagle/graph/params.h"
 #include "didagle/processor/processor.h"
 #include "didagle/trace/event.h"
+#include "didagle/trace/histogram.h"
 
 namespace didagle {
 
@@ -66,15 +68,46 @@ inline std::unique_ptr<Latch> new_folly_latch(ptrdiff_t n) {
 using LatchCreator = std::function<std::unique_ptr<Latch>(ptrdiff_t)>;
 struct GraphExecuteOptions {
   AsyncExecutor async_executor;
+  // runs successors of async processors with 'resume_on = "cpu"', 'async_executor' is used if empty
+  AsyncExecutor cpu_executor;
   LatchCreator latch_creator;
   std::shared_ptr<Params> params;
   EventReporter event_reporter;
+  // maintain latency histograms of every vertex, see 'GraphStore::GetVertexLatencyStats'.
+  // each latency kind recorded by a vertex allocates a histogram of about 9KB, per loaded cluster version
+  bool vertex_latency_stats = false;
+  // analyze critical path of requests with event tracking enabled, see 'GraphStore::GetCriticalPathReport'.
+  // the analysis runs in background after 'done', the events of data context must not be reset before released
+  bool critical_path_stats = false;
+  // current queue depth of 'async_executor', sampled on dispatching vertexs if tracing or latency stats is enabled
+  std::function<int64_t()> executor_queue_depth;
+  // keep events of the last N failed or slow requests of every graph, see 'GraphStore::GetFlightRecorder'
+  size_t flight_recorder_size = 0;
+  // requests slower than this are kept by flight recorder, 0 to keep failed requests only
+  uint64_t flight_recorder_slow_ms = 0;
+  // keep applied 'PARAMS_*' of pooled processors across requests instead of restoring defaults on reset, the
+  // setters are skipped while the vertex params & execute params version are unchanged.
+  // processors must not modify 'PARAMS_*' in execution if enabled
+  bool keep_processor_params = false;
+  // max number of clusters compiled from TaskGroups, the least recently used one is evicted beyond it, 0 for no limit
+  size_t task_group_cluster_limit = 1024;
+#if DIDAGLE_HAS_COROUTINES
+  // run graphs as coroutines on this executor instead of dispatching ready vertexs by 'async_executor',
+  // see 'GraphContext::CoroExecute'
+  folly::Executor::KeepAlive<> coro_executor;
+#endif
 };
 using GraphExecuteOptionsPtr = std::shared_ptr<GraphExecuteOptions>;
 
 struct SelectCondParamsContext {
   Processor* p = nullptr;
-  CondParams param;
+  const CondParams* param = nullptr;
+  // overlay of select args on vertex args or cluster execute params
+  Params view;
+  // index of matched config setting in cluster context
+  int config_idx = -1;
+  // trace name id of 'match'
+  uint32_t trace_cond_id = 0;
 };
 
 inline uint64_t ustime() {
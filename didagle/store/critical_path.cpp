@@ -0,0 +1,227 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include "didagle/store/critical_path.h"
+#include <algorithm>
+#include <string_view>
+
+namespace didagle {
+
+void build_critical_path_vertex_index(const Graph& graph, CriticalPathVertexIndex& index) {
+  for (const auto& [id, v] : graph._nodes) {
+    index[TraceNameTable::Intern(id)] = v;
+  }
+}
+
+int analyze_critical_path(const Graph& graph, const DAGEventTracker& tracker, uint64_t scope,
+                          CriticalPathAnalysis& analysis) {
+  CriticalPathVertexIndex index;
+  build_critical_path_vertex_index(graph, index);
+  return analyze_critical_path(graph, index, tracker, scope, analysis);
+}
+
+int analyze_critical_path(const Graph& graph, const CriticalPathVertexIndex& vertex_ids,
+                          const DAGEventTracker& tracker, uint64_t scope, CriticalPathAnalysis& analysis) {
+  analysis = CriticalPathAnalysis();
+  tracker.VisitRecords([&](const DAGEventRecord& record) {
+    if (PhaseType::DAG_GRAPH_GRAPH_PREPARE_EXECUTE != record.phase || 0 != analysis.start_ustime) {
+      return;
+    }
+    if (0 == scope || record.scope == scope) {
+      scope = record.scope;
+      analysis.start_ustime = record.start_ustime;
+    }
+  });
+  if (0 == scope) {
+    return -1;
+  }
+
+  struct Timing {
+    uint64_t begin_ustime = 0;
+    uint64_t exec_start_ustime = 0;
+    uint64_t exec_end_ustime = 0;
+    uint64_t end_ustime = 0;
+    bool executed = false;
+  };
+  folly::F14FastMap<const Vertex*, Timing> timings;
+  tracker.VisitRecords([&](const DAGEventRecord& record) {
+    if (record.scope != scope || 0 == record.vertex) {
+      return;
+    }
+    auto found = vertex_ids.find(record.vertex);
+    if (found == vertex_ids.end()) {
+      return;
+    }
+    Timing& timing = timings[found->second];
+    if (0 != record.start_ustime && (0 == timing.begin_ustime || record.start_ustime < timing.begin_ustime)) {
+      timing.begin_ustime = record.start_ustime;
+    }
+    timing.end_ustime = std::max(timing.end_ustime, record.end_ustime);
+    if (PhaseType::DAG_PHASE_UNKNOWN == record.phase) {
+      timing.executed = true;
+      // vertex skipped before execution has no start time
+      timing.exec_start_ustime = 0 == record.start_ustime ? record.end_ustime : record.start_ustime;
+      timing.exec_end_ustime = record.end_ustime;
+    }
+  });
+
+  // topological order of executed vertexs
+  folly::F14FastMap<const Vertex*, size_t> idxs;
+  std::vector<std::vector<size_t>> deps;
+  std::vector<std::vector<size_t>> successors;
+  for (const auto& [v, timing] : timings) {
+    if (timing.executed) {
+      idxs[v] = idxs.size();
+    }
+  }
+  if (idxs.empty()) {
+    return -1;
+  }
+  std::vector<const Vertex*> vertexs(idxs.size());
+  deps.resize(idxs.size());
+  successors.resize(idxs.size());
+  std::vector<size_t> wait_num(idxs.size(), 0);
+  for (const auto& [v, idx] : idxs) {
+    vertexs[idx] = v;
+    for (const auto& dep : v->_deps_idx) {
+      auto found = idxs.find(dep.first);
+      if (found == idxs.end()) {
+        continue;
+      }
+      deps[idx].emplace_back(found->second);
+      successors[found->second].emplace_back(idx);
+      wait_num[idx]++;
+    }
+  }
+  std::vector<size_t> order;
+  for (size_t i = 0; i < vertexs.size(); i++) {
+    if (0 == wait_num[i]) {
+      order.emplace_back(i);
+    }
+  }
+  for (size_t i = 0; i < order.size(); i++) {
+    for (size_t successor : successors[order[i]]) {
+      if (0 == --wait_num[successor]) {
+        order.emplace_back(successor);
+      }
+    }
+  }
+  if (order.size() != vertexs.size()) {
+    return -1;
+  }
+
+  std::vector<size_t> positions(vertexs.size());
+  analysis.vertexs.resize(vertexs.size());
+  for (size_t pos = 0; pos < order.size(); pos++) {
+    size_t idx = order[pos];
+    positions[idx] = pos;
+    // start from the first vertex if there is no graph prepare record of the given scope
+    uint64_t begin_ustime = timings[vertexs[idx]].begin_ustime;
+    if (0 != begin_ustime && (0 == analysis.start_ustime || begin_ustime < analysis.start_ustime)) {
+      analysis.start_ustime = begin_ustime;
+    }
+  }
+  for (size_t pos = 0; pos < order.size(); pos++) {
+    size_t idx = order[pos];
+    const Timing& timing = timings[vertexs[idx]];
+    CriticalPathVertex& v = analysis.vertexs[pos];
+    v.vertex = vertexs[idx];
+    v.exec_start_ustime = timing.exec_start_ustime;
+    v.exec_end_ustime = timing.exec_end_ustime;
+    v.end_ustime = std::max(timing.end_ustime, timing.exec_end_ustime);
+    v.ready_ustime = analysis.start_ustime;
+    for (size_t dep : deps[idx]) {
+      v.ready_ustime = std::max(v.ready_ustime, analysis.vertexs[positions[dep]].end_ustime);
+    }
+    analysis.end_ustime = std::max(analysis.end_ustime, v.end_ustime);
+  }
+
+  // latest finish time without delaying the graph, the duration of a vertex includes the wait for scheduling
+  std::vector<uint64_t> latest_end(order.size(), analysis.end_ustime);
+  for (size_t pos = order.size(); pos > 0; pos--) {
+    size_t idx = order[pos - 1];
+    CriticalPathVertex& v = analysis.vertexs[pos - 1];
+    for (size_t successor : successors[idx]) {
+      const CriticalPathVertex& s = analysis.vertexs[positions[successor]];
+      uint64_t latest_start = latest_end[positions[successor]] - (s.end_ustime - std::min(s.ready_ustime, s.end_ustime));
+      latest_end[pos - 1] = std::min(latest_end[pos - 1], latest_start);
+    }
+    v.slack_us = latest_end[pos - 1] > v.end_ustime ? latest_end[pos - 1] - v.end_ustime : 0;
+  }
+
+  // walk back from the last finished vertex through the dependency which made it ready
+  size_t pos = 0;
+  for (size_t i = 1; i < analysis.vertexs.size(); i++) {
+    if (analysis.vertexs[i].end_ustime > analysis.vertexs[pos].end_ustime) {
+      pos = i;
+    }
+  }
+  while (true) {
+    CriticalPathVertex& v = analysis.vertexs[pos];
+    v.critical = true;
+    analysis.critical_path.emplace_back(pos);
+    analysis.exec_us += v.exec_end_ustime - v.exec_start_ustime;
+    bool found = false;
+    size_t last_dep = 0;
+    for (size_t dep : deps[order[pos]]) {
+      size_t dep_pos = positions[dep];
+      if (!found || analysis.vertexs[dep_pos].end_ustime > analysis.vertexs[last_dep].end_ustime) {
+        last_dep = dep_pos;
+        found = true;
+      }
+    }
+    if (!found) {
+      break;
+    }
+    pos = last_dep;
+  }
+  std::reverse(analysis.critical_path.begin(), analysis.critical_path.end());
+  uint64_t wall_us = analysis.end_ustime - analysis.start_ustime;
+  analysis.sched_us = wall_us > analysis.exec_us ? wall_us - analysis.exec_us : 0;
+  return 0;
+}
+
+void CriticalPathStatsTable::Add(const Graph& graph, const DAGEventTracker& tracker, uint64_t scope) {
+  auto found = graphs.find(&graph);
+  if (found == graphs.end()) {
+    return;
+  }
+  CriticalPathAnalysis analysis;
+  if (0 == analyze_critical_path(graph, found->second->vertex_index, tracker, scope, analysis)) {
+    Add(graph, analysis);
+  }
+}
+void CriticalPathStatsTable::Add(const Graph& graph, const CriticalPathAnalysis& analysis) {
+  auto found = graphs.find(&graph);
+  if (found == graphs.end()) {
+    return;
+  }
+  GraphCriticalPathStats& graph_stats = *found->second;
+  graph_stats.samples.fetch_add(1, std::memory_order_relaxed);
+  graph_stats.wall_us.fetch_add(analysis.end_ustime - analysis.start_ustime, std::memory_order_relaxed);
+  graph_stats.exec_us.fetch_add(analysis.exec_us, std::memory_order_relaxed);
+  graph_stats.sched_us.fetch_add(analysis.sched_us, std::memory_order_relaxed);
+  for (const CriticalPathVertex& v : analysis.vertexs) {
+    auto vertex_found = vertexs.find(v.vertex);
+    if (vertex_found == vertexs.end()) {
+      continue;
+    }
+    VertexCriticalPathStats& stats = *vertex_found->second;
+    stats.samples.fetch_add(1, std::memory_order_relaxed);
+    stats.slack_us.fetch_add(v.slack_us, std::memory_order_relaxed);
+    if (v.critical) {
+      stats.critical_count.fetch_add(1, std::memory_order_relaxed);
+      stats.critical_exec_us.fetch_add(v.exec_end_ustime - v.exec_start_ustime, std::memory_order_relaxed);
+    }
+  }
+}
+
+void CriticalPathReport::Sort() {
+  std::stable_sort(vertexs.begin(), vertexs.end(), [](const VertexEntry& a, const VertexEntry& b) {
+    if (a.critical_count != b.critical_count) {
+      return a.critical_count > b.critical_count;
+    }
+    return a.critical_exec_us > b.critical_exec_us;
+  });
+}
+
+}  // namespace didagle
@@ -0,0 +1,107 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "folly/container/F14Map.h"
+
+#include "didagle/graph/graph.h"
+#include "didagle/trace/event.h"
+
+namespace didagle {
+
+struct CriticalPathVertex {
+  const Vertex* vertex = nullptr;
+  uint64_t ready_ustime = 0;  // all executed dependencies done, or graph start
+  uint64_t exec_start_ustime = 0;
+  uint64_t exec_end_ustime = 0;
+  uint64_t end_ustime = 0;  // including post execute
+  // how long the vertex could be delayed without delaying the graph
+  uint64_t slack_us = 0;
+  bool critical = false;
+};
+
+struct CriticalPathAnalysis {
+  uint64_t start_ustime = 0;
+  uint64_t end_ustime = 0;
+  // wall time of critical path spent in processor/subgraph execution, the rest is scheduling & prepare/post execute
+  uint64_t exec_us = 0;
+  uint64_t sched_us = 0;
+  // executed vertexs in topological order
+  std::vector<CriticalPathVertex> vertexs;
+  // indexes of 'vertexs' from graph start to end
+  std::vector<size_t> critical_path;
+};
+
+// vertexs of a graph by interned trace name
+using CriticalPathVertexIndex = folly::F14FastMap<uint32_t, const Vertex*>;
+void build_critical_path_vertex_index(const Graph& graph, CriticalPathVertexIndex& index);
+
+/**
+ * @brief Compute critical path & per vertex slack of a traced execution of 'graph' with the topology of
+ * 'Vertex::_deps_idx'. 'scope' selects the execution in tracker, 0 for the first executed graph.
+ * Return -1 if no execution of 'graph' found in tracker.
+ */
+int analyze_critical_path(const Graph& graph, const CriticalPathVertexIndex& index, const DAGEventTracker& tracker,
+                          uint64_t scope, CriticalPathAnalysis& analysis);
+int analyze_critical_path(const Graph& graph, const DAGEventTracker& tracker, uint64_t scope,
+                          CriticalPathAnalysis& analysis);
+
+struct VertexCriticalPathStats {
+  std::atomic<uint64_t> samples{0};
+  std::atomic<uint64_t> critical_count{0};
+  std::atomic<uint64_t> slack_us{0};
+  std::atomic<uint64_t> critical_exec_us{0};
+};
+struct GraphCriticalPathStats {
+  // built with the cluster, so that requests do not intern vertex names
+  CriticalPathVertexIndex vertex_index;
+  std::atomic<uint64_t> samples{0};
+  std::atomic<uint64_t> wall_us{0};
+  std::atomic<uint64_t> exec_us{0};
+  std::atomic<uint64_t> sched_us{0};
+};
+struct CriticalPathStatsTable {
+  folly::F14FastMap<const Graph*, std::unique_ptr<GraphCriticalPathStats>> graphs;
+  folly::F14FastMap<const Vertex*, std::unique_ptr<VertexCriticalPathStats>> vertexs;
+
+  bool Empty() const { return graphs.empty(); }
+  /**
+   * @brief analyze a traced execution of 'graph' in 'scope' & add it into the stats.
+   */
+  void Add(const Graph& graph, const DAGEventTracker& tracker, uint64_t scope);
+  void Add(const Graph& graph, const CriticalPathAnalysis& analysis);
+};
+
+struct CriticalPathReport {
+  struct GraphEntry {
+    std::string cluster;
+    std::string graph;
+    uint64_t samples = 0;
+    uint64_t wall_us = 0;
+    uint64_t exec_us = 0;
+    uint64_t sched_us = 0;
+  };
+  struct VertexEntry {
+    std::string cluster;
+    std::string graph;
+    std::string vertex;
+    uint64_t samples = 0;
+    uint64_t critical_count = 0;
+    uint64_t slack_us = 0;
+    uint64_t critical_exec_us = 0;
+  };
+  std::vector<GraphEntry> graphs;
+  // sorted by 'critical_count' in descending order
+  std::vector<VertexEntry> vertexs;
+
+  void Sort();
+};
+
+}  // namespace didagle
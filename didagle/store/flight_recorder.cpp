@@ -0,0 +1,206 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include "didagle/store/flight_recorder.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+#include "didagle/log/log.h"
+#include "didagle/trace/chrome_trace.h"
+
+namespace didagle {
+namespace {
+struct SignalDumper {
+  std::mutex mutex;
+  const FlightRecorder* recorder = nullptr;
+  std::string file;
+  int read_fd = -1;
+};
+// never destroyed since the dump thread is detached
+SignalDumper& GetSignalDumper() {
+  static SignalDumper* dumper = new SignalDumper;
+  return *dumper;
+}
+std::atomic<int> g_signal_write_fd{-1};
+
+void on_dump_signal(int) {
+  int fd = g_signal_write_fd.load(std::memory_order_relaxed);
+  if (fd >= 0) {
+    char c = 1;
+    ssize_t n = write(fd, &c, 1);
+    (void)n;
+  }
+}
+void run_signal_dumper(int fd) {
+  char buf[64];
+  while (true) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int rc = poll(&pfd, 1, -1);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0 || 0 != (pfd.revents & (POLLERR | POLLNVAL))) {
+      return;
+    }
+    // drain the non-blocking pipe, signals received before the dump are merged into one dump
+    ssize_t n = 0;
+    size_t received = 0;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+      received += n;
+    }
+    if (0 == n && 0 == received) {
+      // write end closed
+      return;
+    }
+    if (n < 0 && errno != EAGAIN && errno != EINTR) {
+      return;
+    }
+    if (0 == received) {
+      continue;
+    }
+    SignalDumper& dumper = GetSignalDumper();
+    std::lock_guard<std::mutex> guard(dumper.mutex);
+    if (nullptr != dumper.recorder && 0 != dumper.recorder->DumpFile(dumper.file)) {
+      DIDAGLE_ERROR("Failed to dump flight recorder into {}", dumper.file);
+    }
+  }
+}
+}  // namespace
+
+void FlightRecorder::Add(FlightRecordPtr record) {
+  if (0 == _capacity) {
+    return;
+  }
+  std::string key;
+  key.reserve(record->cluster.size() + record->graph.size() + 1);
+  key.append(record->cluster).append("/").append(record->graph);
+  std::lock_guard<std::mutex> guard(_mutex);
+  GraphRecords& graph_records = _graphs[key];
+  if (graph_records.records.empty()) {
+    graph_records.cluster = record->cluster;
+    graph_records.graph = record->graph;
+  }
+  graph_records.records.emplace_back(std::move(record));
+  while (graph_records.records.size() > _capacity) {
+    graph_records.records.pop_front();
+  }
+}
+
+void FlightRecorder::Get(const std::string& cluster, const std::string& graph,
+                         std::vector<FlightRecordPtr>& records) const {
+  std::lock_guard<std::mutex> guard(_mutex);
+  for (const auto& [_, graph_records] : _graphs) {
+    if ((!cluster.empty() && cluster != graph_records.cluster) || (!graph.empty() && graph != graph_records.graph)) {
+      continue;
+    }
+    records.insert(records.end(), graph_records.records.begin(), graph_records.records.end());
+  }
+}
+
+void FlightRecorder::Dump(std::string& json) const {
+  std::vector<FlightRecordPtr> records;
+  Get("", "", records);
+  json.append("{\"requests\":[");
+  for (size_t i = 0; i < records.size(); i++) {
+    const FlightRecord& request = *records[i];
+    json.append(i > 0 ? ",{" : "{").append("\"cluster\":");
+    append_json_string(json, request.cluster);
+    json.append(",\"graph\":");
+    append_json_string(json, request.graph);
+    json.append(",\"start_ustime\":").append(std::to_string(request.start_ustime));
+    json.append(",\"latency_us\":").append(std::to_string(request.end_ustime - request.start_ustime));
+    json.append(",\"rc\":").append(std::to_string(request.rc));
+    json.append(",\"events\":[");
+    DAGEvent event;
+    for (size_t j = 0; j < request.records.size(); j++) {
+      DAGEventTracker::ToDAGEvent(request.records[j], event);
+      json.append(j > 0 ? ",{" : "{").append("\"phase\":");
+      append_json_string(json, get_dag_phase_name(event.phase));
+      json.append(",\"vertex\":");
+      append_json_string(json, event.vertex);
+      json.append(",\"processor\":");
+      append_json_string(json, event.processor);
+      if (!event.full_graph_name.empty()) {
+        json.append(",\"subgraph\":");
+        append_json_string(json, event.full_graph_name);
+      }
+      if (!event.matched_cond.empty()) {
+        json.append(",\"matched_cond\":");
+        append_json_string(json, event.matched_cond);
+      }
+      json.append(",\"start_ustime\":").append(std::to_string(event.start_ustime));
+      json.append(",\"end_ustime\":").append(std::to_string(event.end_ustime));
+      json.append(",\"thread_id\":").append(std::to_string(event.thread_id));
+      json.append(",\"scope\":").append(std::to_string(event.scope));
+      if (PhaseType::DAG_PHASE_UNKNOWN == event.phase) {
+        json.append(",\"rc\":").append(std::to_string(event.rc));
+        json.append(",\"code\":").append(std::to_string(event.code));
+      }
+      if (event.queue_depth >= 0) {
+        json.append(",\"queue_depth\":").append(std::to_string(event.queue_depth));
+      }
+      json.push_back('}');
+    }
+    json.append("]}");
+  }
+  json.append("]}\n");
+}
+
+int FlightRecorder::DumpFile(const std::string& file) const {
+  std::string json;
+  Dump(json);
+  FILE* fp = fopen(file.c_str(), "w");
+  if (nullptr == fp) {
+    return -1;
+  }
+  size_t n = fwrite(json.data(), 1, json.size(), fp);
+  int rc = fclose(fp);
+  return (n == json.size() && 0 == rc) ? 0 : -1;
+}
+
+int FlightRecorder::DumpOnSignal(int signo, const std::string& file) {
+  SignalDumper& dumper = GetSignalDumper();
+  std::lock_guard<std::mutex> guard(dumper.mutex);
+  if (nullptr != dumper.recorder && this != dumper.recorder) {
+    DIDAGLE_ERROR("Signal dump is already bound to another flight recorder.");
+    return -1;
+  }
+  if (dumper.read_fd < 0) {
+    int fds[2];
+    // non-blocking so that the signal handler never blocks on a full pipe, and not leaked into child processes
+    if (0 != pipe2(fds, O_NONBLOCK | O_CLOEXEC)) {
+      DIDAGLE_ERROR("Failed to create pipe for flight recorder signal dump.");
+      return -1;
+    }
+    dumper.read_fd = fds[0];
+    g_signal_write_fd.store(fds[1]);
+    std::thread(run_signal_dumper, fds[0]).detach();
+  }
+  struct sigaction action;
+  action.sa_handler = on_dump_signal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  if (0 != sigaction(signo, &action, nullptr)) {
+    DIDAGLE_ERROR("Failed to install flight recorder dump handler for signal:{}", signo);
+    return -1;
+  }
+  dumper.recorder = this;
+  dumper.file = file;
+  return 0;
+}
+
+FlightRecorder::~FlightRecorder() {
+  SignalDumper& dumper = GetSignalDumper();
+  std::lock_guard<std::mutex> guard(dumper.mutex);
+  if (this == dumper.recorder) {
+    dumper.recorder = nullptr;
+  }
+}
+
+}  // namespace didagle
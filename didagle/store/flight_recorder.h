@@ -0,0 +1,70 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#pragma once
+
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "folly/container/F14Map.h"
+
+#include "didagle/trace/event.h"
+
+namespace didagle {
+
+/**
+ * @brief Evidence of one slow or failed request, vertex results & matched 'select_args' conditions are the
+ * 'rc'/'code'/'matched_cond' of vertex execute records(phase 'DAG_PHASE_UNKNOWN').
+ */
+struct FlightRecord {
+  std::string cluster;
+  std::string graph;
+  uint64_t start_ustime = 0;
+  uint64_t end_ustime = 0;
+  int rc = 0;
+  std::vector<DAGEventRecord> records;
+};
+using FlightRecordPtr = std::shared_ptr<const FlightRecord>;
+
+/**
+ * @brief Bounded in memory recorder keeps the last N slow or failed requests of every graph.
+ */
+class FlightRecorder {
+ public:
+  explicit FlightRecorder(size_t capacity) : _capacity(capacity) {}
+  void Add(FlightRecordPtr record);
+  /**
+   * @brief records of 'graph' in 'cluster' from oldest to newest, empty 'cluster'/'graph' matches all.
+   */
+  void Get(const std::string& cluster, const std::string& graph, std::vector<FlightRecordPtr>& records) const;
+  /**
+   * @brief render all records as JSON.
+   */
+  void Dump(std::string& json) const;
+  /**
+   * @brief write 'Dump' JSON into 'file', return -1 if the file could not be written.
+   */
+  int DumpFile(const std::string& file) const;
+  /**
+   * @brief dump into 'file' from a background thread whenever 'signo' is received, only one recorder of the
+   * process could be bound to the signal.
+   */
+  int DumpOnSignal(int signo, const std::string& file);
+  ~FlightRecorder();
+
+ private:
+  struct GraphRecords {
+    std::string cluster;
+    std::string graph;
+    std::deque<FlightRecordPtr> records;
+  };
+  size_t _capacity = 0;
+  mutable std::mutex _mutex;
+  folly::F14NodeMap<std::string, GraphRecords> _graphs;
+};
+
+}  // namespace didagle
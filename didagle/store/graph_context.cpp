@@ -46,6 +46,7 @@ int GraphContext::Setup(GraphClusterContext* c, Graph* g) {
   }
   for (auto& [_, vetex_ctx] : _vertex_context_table) {
     vetex_ctx->SetupSuccessors();
+    vetex_ctx->SetupDataVars(_data_vars);
   }
   _data_ctx->ReserveChildCapacity(_children_count);
   // std::set<DIObjectKey> move_ids;
@@ -65,7 +66,7 @@ int GraphContext::Setup(GraphClusterContext* c, Graph* g) {
             return -1;
           }
         }
-        if (!entry.info.flags.is_extern && !entry.info.flags.is_aggregate) {
+        if (!entry.info.flags.is_extern && !entry.info.flags.is_aggregate && key.name[0] != '$') {
           entry.idx = static_cast<int32_t>(_data_ctx->RegisterData(key));
         }
       }
@@ -113,14 +114,27 @@ void GraphContext::Reset() {
   }
   _data_ctx->Reset();
   early_exist_rc_ = 0;
+  _coro_running = false;
 }
 void GraphContext::ExecuteReadyVertexs(folly::fbvector<VertexContext*>& ready_vertexs) {
   DIDAGLE_DEBUG("ExecuteReadyVertexs with {} vertexs.", ready_vertexs.size());
   if (ready_vertexs.empty()) {
     return;
   }
+  DAGEventTracker* tracker = _data_ctx->GetEventTracker();
+  // taken once if any vertex records it, every vertex is marked ready once right before it runs or is dispatched
+  uint64_t ready_ustime = 0;
+  for (VertexContext* ctx : ready_vertexs) {
+    if (nullptr != tracker || nullptr != ctx->GetLatencyStats()) {
+      ready_ustime = ustime();
+      break;
+    }
+  }
   if (ready_vertexs.size() == 1) {
     // inplace run
+    if (0 != ready_ustime) {
+      ready_vertexs[0]->SetReady(ready_ustime);
+    }
     ready_vertexs[0]->Execute();
   } else {
     VertexContext* local_execute = nullptr;
@@ -141,28 +155,73 @@ void GraphContext::ExecuteReadyVertexs(folly::fbvector<VertexContext*>& ready_ve
       local_execute = ready_vertexs[0];
     }
     uint64_t sched_start_ustime = ustime();
-    DAGEventTracker* tracker = _data_ctx->GetEventTracker();
+    uint32_t dispatch_thread_id = nullptr != tracker ? get_trace_thread_id() : 0;
+    const GraphExecuteOptions* exec_opts = _cluster->GetGraphExecuteOptions().get();
+    int32_t queue_depth = -1;
+    if (0 != ready_ustime && exec_opts->executor_queue_depth) {
+      queue_depth = static_cast<int32_t>(exec_opts->executor_queue_depth());
+    }
     for (VertexContext* ctx : ready_vertexs) {
       if (ctx == local_execute) {
         continue;
       }
       VertexContext* next = ctx;
-      _cluster->GetGraphExecuteOptions()->async_executor([tracker, next, sched_start_ustime]() {
-        if (nullptr != tracker) {
-          auto event = std::make_unique<DAGEvent>();
-          event->start_ustime = sched_start_ustime;
-          event->end_ustime = ustime();
-          event->phase = PhaseType::DAG_PHASE_CONCURRENT_SCHED;
-          tracker->Add(std::move(event));
+      if (0 != ready_ustime) {
+        next->SetReady(ready_ustime, queue_depth);
+      }
+      exec_opts->async_executor([tracker, next, sched_start_ustime, dispatch_thread_id, queue_depth]() {
+        VertexLatencyStats* latency_stats = next->GetLatencyStats();
+        if (nullptr != tracker || nullptr != latency_stats) {
+          uint64_t sched_end_ustime = ustime();
+          if (nullptr != tracker) {
+            DAGEventRecord record;
+            record.vertex = next->GetTraceNames().vertex;
+            record.scope = next->GetTraceNames().scope;
+            record.dispatch_thread_id = dispatch_thread_id;
+            record.queue_depth = queue_depth;
+            record.start_ustime = sched_start_ustime;
+            record.end_ustime = sched_end_ustime;
+            record.phase = PhaseType::DAG_PHASE_CONCURRENT_SCHED;
+            tracker->Add(record);
+          }
+          if (nullptr != latency_stats) {
+            latency_stats->Record(VERTEX_LATENCY_QUEUE_WAIT, sched_start_ustime, sched_end_ustime);
+          }
         }
         next->Execute();
       });
     }
+    if (0 != ready_ustime) {
+      local_execute->SetReady(ready_ustime);
+    }
     local_execute->Execute();
   }
 }
+void GraphContext::ExecuteReadyVertex(VertexContext* v) {
+  if (nullptr != v->GetLatencyStats() || nullptr != _data_ctx->GetEventTracker()) {
+    v->SetReady(ustime());
+  }
+  v->Execute();
+}
 void GraphContext::OnVertexDone(VertexContext* vertex) {
   DIDAGLE_DEBUG("[{}]OnVertexDone while _join_vertex_num:{}.", vertex->GetVertex()->id, _join_vertex_num.load());
+#if DIDAGLE_HAS_COROUTINES
+  if (_coro_running) {
+    bool record_ready = nullptr != _data_ctx->GetEventTracker();
+    for (size_t i = 0; i < vertex->_successor_ctxs.size(); i++) {
+      VertexContext* successor_ctx = vertex->_successor_ctxs[i];
+      if (1 == successor_ctx->SetDependencyResult(vertex->_successor_dep_idxs[i], vertex->GetResult())) {
+        if (record_ready || nullptr != successor_ctx->GetLatencyStats()) {
+          successor_ctx->SetReady(ustime());
+        }
+        successor_ctx->_ready_baton.post();
+      }
+    }
+    // the graph may be finished & reset once posted
+    vertex->_done_baton.post();
+    return;
+  }
+#endif
   if (1 == _join_vertex_num.fetch_sub(1)) {  // last vertex
     // printf("%s while %d %d\n", _graph->name.c_str(), nullptr != _while_ctx, _while_ctx->_code);
     if (nullptr != _while_ctx && _while_ctx->_code == 0) {
@@ -196,7 +255,45 @@ void GraphContext::OnVertexDone(VertexContext* vertex) {
 
 int GraphContext::Execute(DoneClosure&& done) {
   _done = std::move(done);
+  if (!_data_vars.Empty()) {
+    // resolve '$var' data names once for all vertices
+    _data_vars.Bind(_cluster->GetExecuteParams(), _cluster->GetExecuteParamsVersion(), *_data_ctx);
+  }
+#if DIDAGLE_HAS_COROUTINES
+  const GraphExecuteOptions* exec_opts = _cluster->GetGraphExecuteOptions().get();
+  if (exec_opts->coro_executor) {
+    _coro_running = true;
+    coro_spawn(exec_opts->coro_executor, [this]() -> Awaitable<void> {
+      int rc = co_await CoroExecute();
+      _coro_running = false;
+      if (_done) {
+        _done(rc);
+      }
+    });
+    return 0;
+  }
+#endif
   ExecuteReadyVertexs(_start_ctxs);
   return 0;
 }
+
+#if DIDAGLE_HAS_COROUTINES
+Awaitable<int> GraphContext::CoroExecute() {
+  folly::Executor::KeepAlive<> executor = _cluster->GetGraphExecuteOptions()->coro_executor;
+  while (true) {
+    // started through the executor, so that ready vertexs run concurrently instead of one after another inline
+    std::vector<folly::coro::TaskWithExecutor<void>> vertexs;
+    vertexs.reserve(_vertex_context_table.size());
+    for (auto& [_, ctx] : _vertex_context_table) {
+      vertexs.emplace_back(ctx->CoroExecute().scheduleOn(executor));
+    }
+    co_await folly::coro::collectAllRange(std::move(vertexs));
+    if (nullptr == _while_ctx || _while_ctx->_code != 0) {
+      break;
+    }
+    ResetState();
+  }
+  co_return early_exist_rc_;
+}
+#endif
 }  // namespace didagle
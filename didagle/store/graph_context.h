@@ -38,10 +38,13 @@ class GraphContext {
   size_t _children_count;
 
   folly::fbvector<VertexContext*> _start_ctxs;
+  DataVarBindings _data_vars;
 
   VertexContext* _while_ctx = nullptr;
 
   int early_exist_rc_ = 0;
+  // executed by the coroutine engine, vertexs are joined by batons instead of dispatching successors
+  bool _coro_running = false;
 
  public:
   GraphContext();
@@ -57,8 +60,16 @@ class GraphContext {
   void Reset();
   void ResetState();
   void ExecuteReadyVertexs(folly::fbvector<VertexContext*>& ready_vertexs);
-  inline void ExecuteReadyVertex(VertexContext* v) { v->Execute(); }
+  void ExecuteReadyVertex(VertexContext* v);
   int Execute(DoneClosure&& done);
+#if DIDAGLE_HAS_COROUTINES
+  /**
+   * @brief Run all vertexs as coroutines scheduled on 'GraphExecuteOptions::coro_executor' & joined by
+   * 'collectAllRange', each vertex waits its dependencies by a baton, so ready vertexs run concurrently on the
+   * executor. Started by 'Execute' if 'coro_executor' is set, the early exit code is returned.
+   */
+  Awaitable<int> CoroExecute();
+#endif
   inline GraphDataContext* GetGraphDataContext() { return _data_ctx.get(); }
   inline GraphDataContext& GetGraphDataContextRef() { return *(GetGraphDataContext()); }
   inline void SetGraphDataContext(GraphDataContext* p) { _data_ctx->SetParent(p); }
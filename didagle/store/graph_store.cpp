@@ -29,10 +29,19 @@
 ** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "didagle/store/graph_store.h"
+#include <dirent.h>
 #include <fmt/core.h>
+#include <stdio.h>
 #include <unistd.h>
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "didagle/graph/graph_plan.h"
 
 namespace didagle {
 static std::string get_basename(const std::string& filename) {
@@ -49,14 +58,67 @@ static std::string get_basename(const std::string& filename) {
     return filename;
 }
 
+// generations are unique among stores, so that handles cached by generation never match another store
+static std::atomic<uint64_t> g_cluster_generation{0};
+
 GraphStore::GraphStore(const GraphExecuteOptions& options) {
+  auto table = std::make_shared<ClusterTable>();
+  table->generation = g_cluster_generation.fetch_add(1) + 1;
+  _cluster_generation.store(table->generation, std::memory_order_release);
+  _cluster_table.store(std::move(table));
   _exec_options = std::make_shared<GraphExecuteOptions>(options);
+  if (options.flight_recorder_size > 0) {
+    _flight_recorder = std::make_unique<FlightRecorder>(options.flight_recorder_size);
+  }
   // _async_reset_worker = std::make_unique<AsyncResetWorker>(options.async_reset_worker_num);
   _graph_exec_func_ =
       std::bind(&GraphStore::Execute, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
                 std::placeholders::_4, std::placeholders::_5, std::placeholders::_6);
 }
 
+static bool read_file(const std::string& file, std::string& content) {
+  FILE* fp = fopen(file.c_str(), "rb");
+  if (nullptr == fp) {
+    return false;
+  }
+  char buf[8192];
+  size_t n = 0;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    content.append(buf, n);
+  }
+  bool ok = 0 == ferror(fp);
+  fclose(fp);
+  return ok;
+}
+static uint64_t get_content_hash(const std::string& content) { return std::hash<std::string>{}(content); }
+
+std::shared_ptr<GraphClusterHandle> GraphStore::BuildCluster(std::shared_ptr<GraphClusterHandle> g,
+                                                             ClusterLoadResult* result) {
+  std::shared_ptr<GraphClusterHandle> old = FindGraphClusterByName(g->cluster._name);
+  if (old && 0 != g->content_hash && old->content_hash == g->content_hash) {
+    // unchanged DSL, keep the running version & its warmed contexts
+    return old;
+  }
+  uint64_t start_us = ustime();
+  if (0 != g->Build(this, _exec_options, false)) {
+    return nullptr;
+  }
+  uint64_t built_us = ustime();
+  // warm as many contexts as the replaced version had created, so that the swap does not create them on demand
+  g->PrewarmContexts(this, _exec_options, old ? old->created_contexts.load() : -1);
+  if (nullptr != result) {
+    result->build_us = built_us - start_us;
+    result->prewarm_us = ustime() - built_us;
+  }
+  return g;
+}
+std::shared_ptr<GraphClusterHandle> GraphStore::Reload(std::shared_ptr<GraphClusterHandle> g) {
+  g = BuildCluster(std::move(g));
+  if (g) {
+    PublishClusters({g});
+  }
+  return g;
+}
 std::shared_ptr<GraphClusterHandle> GraphStore::LoadString(const std::string& content) {
   std::shared_ptr<GraphClusterHandle> g = std::make_shared<GraphClusterHandle>();
   bool v = kcfg::ParseFromTomlString(content, g->cluster);
@@ -69,64 +131,261 @@ std::shared_ptr<GraphClusterHandle> GraphStore::LoadString(const std::string& co
     return nullptr;
   }
   g->cluster._name = g->cluster.name;
-  if (0 != g->Build(this, _exec_options)) {
+  g->content_hash = get_content_hash(content);
+  return Reload(std::move(g));
+}
+std::shared_ptr<GraphClusterHandle> GraphStore::Load(const std::string& file) {
+  std::string content;
+  if (!read_file(file, content)) {
+    DIDAGLE_ERROR("Failed to read didagle toml script:{}", file);
     return nullptr;
   }
-  {
-    std::lock_guard<std::mutex> guard(_graphs_mutex);
-    _graphs[std::move(g->cluster.name)].store(g);
+  std::string name = get_basename(file);
+  uint64_t content_hash = get_content_hash(content);
+  std::shared_ptr<GraphClusterHandle> old = FindGraphClusterByName(name);
+  if (old && old->content_hash == content_hash) {
+    return old;
   }
-
-  return g;
-}
-std::shared_ptr<GraphClusterHandle> GraphStore::Load(const std::string& file) {
   std::shared_ptr<GraphClusterHandle> g = std::make_shared<GraphClusterHandle>();
-  bool v = kcfg::ParseFromTomlFile(file, g->cluster);
+  bool v = kcfg::ParseFromTomlString(content, g->cluster);
   if (!v) {
     DIDAGLE_ERROR("Failed to parse didagle toml script:{}", file);
     return nullptr;
   }
-  std::string name = get_basename(file);
   g->cluster._name = name;
-  // g->_graph_manager = this;
-  if (0 != g->Build(this, _exec_options)) {
-    return nullptr;
+  g->content_hash = content_hash;
+  return Reload(std::move(g));
+}
+int GraphStore::LoadPlan(const std::string& file) {
+  std::unique_ptr<GraphPlan> plan = GraphPlan::Load(file);
+  if (!plan) {
+    return -1;
+  }
+  std::vector<std::shared_ptr<GraphClusterHandle>> handles;
+  handles.reserve(plan->GetClusterCount());
+  for (size_t i = 0; i < plan->GetClusterCount(); i++) {
+    std::shared_ptr<GraphClusterHandle> g = std::make_shared<GraphClusterHandle>();
+    if (0 != plan->ReadCluster(i, g->cluster)) {
+      DIDAGLE_ERROR("Failed to read cluster:{} from graph plan:{}", plan->GetClusterName(i), file);
+      return -1;
+    }
+    // clusters of an unchanged plan keep their running versions
+    g->content_hash = plan->GetChecksum() ^ get_content_hash(g->cluster._name);
+    std::string name = g->cluster._name;
+    g = BuildCluster(std::move(g));
+    if (!g) {
+      DIDAGLE_ERROR("Failed to build cluster:{} from graph plan:{}", name, file);
+      return -1;
+    }
+    handles.emplace_back(std::move(g));
+  }
+  PublishClusters(handles);
+  return 0;
+}
+int GraphStore::LoadBatch(const std::vector<std::string>& files, std::vector<ClusterLoadResult>& results,
+                          size_t concurrency) {
+  results.clear();
+  results.resize(files.size());
+  std::vector<std::shared_ptr<GraphClusterHandle>> handles(files.size());
+  std::atomic<size_t> next_file{0};
+  auto load_worker = [&]() {
+    for (size_t i = next_file.fetch_add(1); i < files.size(); i = next_file.fetch_add(1)) {
+      ClusterLoadResult& result = results[i];
+      result.file = files[i];
+      result.cluster = get_basename(files[i]);
+      uint64_t start_us = ustime();
+      std::string content;
+      if (!read_file(files[i], content)) {
+        result.error = "failed to read DSL";
+        continue;
+      }
+      std::shared_ptr<GraphClusterHandle> g = std::make_shared<GraphClusterHandle>();
+      if (!kcfg::ParseFromTomlString(content, g->cluster)) {
+        result.error = "failed to parse DSL";
+        continue;
+      }
+      g->cluster._name = result.cluster;
+      g->content_hash = get_content_hash(content);
+      result.parse_us = ustime() - start_us;
+      g = BuildCluster(std::move(g), &result);
+      if (!g) {
+        result.error = "failed to build cluster";
+        continue;
+      }
+      result.rc = 0;
+      handles[i] = std::move(g);
+    }
+  };
+  if (0 == concurrency) {
+    concurrency = std::max(1u, std::thread::hardware_concurrency());
+  }
+  concurrency = std::min(concurrency, files.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < concurrency; i++) {
+    workers.emplace_back(load_worker);
+  }
+  load_worker();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  // resolve subgraph references once all clusters are built, clusters referencing a failed cluster of the batch
+  // fail as well, repeated until no more cluster is dropped
+  std::unordered_map<std::string, GraphCluster*> batch_clusters;
+  std::unordered_set<std::string> failed_clusters;
+  for (size_t i = 0; i < handles.size(); i++) {
+    if (handles[i]) {
+      batch_clusters[handles[i]->cluster._name] = &handles[i]->cluster;
+    } else {
+      failed_clusters.insert(results[i].cluster);
+    }
   }
+  auto check_subgraphs = [&](size_t i) {
+    for (const Graph& graph : handles[i]->cluster.graph) {
+      for (const Vertex& v : graph.vertex) {
+        if (v.graph.empty() || !v.while_cond.empty()) {
+          continue;
+        }
+        if (failed_clusters.count(v.cluster) > 0) {
+          results[i].error = fmt::format("failed cluster:{} referenced by vertex:{} in graph:{}", v.cluster, v.id,
+                                         graph.name);
+          return false;
+        }
+        auto found = batch_clusters.find(v.cluster);
+        bool exists = found != batch_clusters.end() ? found->second->Exists(v.graph) : Exists(v.cluster, v.graph);
+        if (!exists) {
+          results[i].error = fmt::format("no subgraph {}::{} referenced by vertex:{} in graph:{}", v.cluster,
+                                         v.graph, v.id, graph.name);
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+  bool dropped = true;
+  while (dropped) {
+    dropped = false;
+    for (size_t i = 0; i < handles.size(); i++) {
+      if (!handles[i] || check_subgraphs(i)) {
+        continue;
+      }
+      results[i].rc = -1;
+      batch_clusters.erase(handles[i]->cluster._name);
+      failed_clusters.insert(results[i].cluster);
+      handles[i].reset();
+      dropped = true;
+    }
+  }
+  int rc = 0;
+  for (size_t i = 0; i < handles.size(); i++) {
+    if (!handles[i]) {
+      DIDAGLE_ERROR("Failed to load cluster file:{} with error:{}", results[i].file, results[i].error);
+      rc = -1;
+    }
+  }
+  PublishClusters(handles);
+  return rc;
+}
+int GraphStore::LoadDirectory(const std::string& dir, std::vector<ClusterLoadResult>& results, size_t concurrency) {
+  DIR* d = opendir(dir.c_str());
+  if (nullptr == d) {
+    DIDAGLE_ERROR("Failed to open DSL directory:{}", dir);
+    return -1;
+  }
+  std::vector<std::string> files;
+  static constexpr std::string_view kSuffix = ".toml";
+  while (struct dirent* entry = readdir(d)) {
+    std::string_view name(entry->d_name);
+    if (name.size() > kSuffix.size() && name.substr(name.size() - kSuffix.size()) == kSuffix) {
+      files.emplace_back(dir + "/" + entry->d_name);
+    }
+  }
+  closedir(d);
+  std::sort(files.begin(), files.end());
+  return LoadBatch(files, results, concurrency);
+}
+void GraphStore::PublishClusters(const std::vector<std::shared_ptr<GraphClusterHandle>>& handles) {
+  std::vector<std::shared_ptr<GraphClusterHandle>> replaced;
   {
     std::lock_guard<std::mutex> guard(_graphs_mutex);
-    _graphs[std::move(name)].store(g);
+    auto table = std::make_shared<ClusterTable>(*_cluster_table.load());
+    bool changed = false;
+    for (const auto& g : handles) {
+      if (!g) {
+        continue;
+      }
+      std::shared_ptr<GraphClusterHandle>& slot = table->clusters[g->cluster._name];
+      if (slot == g) {
+        continue;
+      }
+      if (slot) {
+        replaced.emplace_back(std::move(slot));
+      }
+      slot = g;
+      changed = true;
+    }
+    if (!changed) {
+      return;
+    }
+    table->generation = g_cluster_generation.fetch_add(1) + 1;
+    uint64_t generation = table->generation;
+    _cluster_table.store(std::move(table));
+    _cluster_generation.store(generation, std::memory_order_release);
+  }
+  ReleaseClusters(std::move(replaced));
+}
+void GraphStore::ReleaseClusters(std::vector<std::shared_ptr<GraphClusterHandle>>&& clusters) {
+  if (clusters.empty()) {
+    return;
+  }
+  // running requests hold their own references, the pooled contexts of old versions are freed in background
+  std::shared_ptr<AsyncResetWorker> worker = AsyncResetWorker::GetInstance();
+  if (worker) {
+    worker->Post([clusters = std::move(clusters)]() mutable { clusters.clear(); });
   }
-
-  return g;
 }
 std::shared_ptr<GraphClusterHandle> GraphStore::FindGraphClusterByName(const std::string& name) {
-  std::lock_guard<std::mutex> guard(_graphs_mutex);
-  auto found = _graphs.find(name);
-  if (found != _graphs.end()) {
-    return found->second.load();
+  // readers never lock, the snapshot is only held during the lookup so that replaced tables are not kept alive
+  std::shared_ptr<const ClusterTable> table = _cluster_table.load();
+  auto found = table->clusters.find(name);
+  if (found != table->clusters.end()) {
+    return found->second;
   }
   return nullptr;
 }
 GraphClusterContext* GraphStore::GetGraphClusterContext(const std::string& cluster) {
-  std::shared_ptr<GraphClusterHandle> c = FindGraphClusterByName(cluster);
-  if (!c) {
+  return GetGraphClusterContext(FindGraphClusterByName(cluster));
+}
+GraphClusterContext* GraphStore::GetGraphClusterContext(std::shared_ptr<GraphClusterHandle> cluster) {
+  if (!cluster) {
+    return nullptr;
+  }
+  GraphClusterContext* ctx = cluster->GetContext(this, _exec_options);
+  if (nullptr == ctx) {
     return nullptr;
   }
-  GraphClusterContext* ctx = c->GetContext(this, _exec_options);
-  ctx->SetRunningCluster(c);
+  ctx->SetRunningCluster(std::move(cluster));
   return ctx;
 }
 
-Graph GraphStore::BuildGraphByTaskGroup(TaskGroupPtr group) {
+void GraphStore::BuildGraphByTaskGroup(const TaskGroup& group, const std::string& cluster, size_t& graph_idx,
+                                       size_t& func_idx, std::vector<Graph>& graphs) {
   Graph group_g;
-  group_g.name = group->Id();
-  for (auto task : group->Tasks()) {
+  group_g.name = TaskGroup::GetGraphName(graph_idx++);
+  // indexes of functions follow the order of 'TaskGroup::CollectFuncs'
+  size_t func_base = func_idx;
+  func_idx += group.GetFuncCount();
+  for (auto task : group.Tasks()) {
     Vertex vertex;
     vertex.id = task->Id();
     vertex.processor = task->processor_;
-    if (vertex.processor.empty()) {
-      vertex.cluster = group->ClusterId();
-      vertex.graph = task->group_id_;
+    if (task->group_) {
+      vertex.processor.clear();
+      vertex.cluster = cluster;
+      vertex.graph = TaskGroup::GetGraphName(graph_idx);
+      BuildGraphByTaskGroup(*task->group_, cluster, graph_idx, func_idx, graphs);
+    } else if (task->func_idx_ >= 0) {
+      vertex.args.Put(std::string(kTaskFuncIndexKey), static_cast<int64_t>(func_base + task->func_idx_));
     }
     vertex.successor = task->succeed_;
     vertex.deps = task->precede_;
@@ -137,33 +396,90 @@ Graph GraphStore::BuildGraphByTaskGroup(TaskGroupPtr group) {
     // }
     group_g.vertex.emplace_back(vertex);
   }
-  return group_g;
+  graphs.emplace_back(std::move(group_g));
 }
 
 std::shared_ptr<GraphClusterHandle> GraphStore::LoadTaskGroup(TaskGroupPtr graph) {
-  std::shared_ptr<GraphClusterHandle> c = FindGraphClusterByName(graph->ClusterId());
+  std::string structure = graph->GetStructure();
+  std::string cluster_id = TaskGroup::GetClusterId(structure);
+  std::shared_ptr<GraphClusterHandle> c = FindGraphClusterByName(cluster_id);
   if (c) {
+    if (c->cluster.desc != structure) {
+      DIDAGLE_ERROR("Task group cluster:{} conflicts with another group structure.", cluster_id);
+      return nullptr;
+    }
+    c->last_used_ustime.store(ustime(), std::memory_order_relaxed);
     return c;
   }
+  register_task_func_processor();
   std::shared_ptr<GraphClusterHandle> g = std::make_shared<GraphClusterHandle>();
-  g->cluster._name = graph->ClusterId();
-
-  for (auto group : graph->SubTaskGroups()) {
-    Graph group_g = BuildGraphByTaskGroup(group);
-    g->cluster.graph.emplace_back(group_g);
-  }
-  g->cluster.graph.emplace_back(BuildGraphByTaskGroup(graph));
+  g->cluster._name = cluster_id;
+  g->cluster.desc = std::move(structure);
+  size_t graph_idx = 0;
+  size_t func_idx = 0;
+  BuildGraphByTaskGroup(*graph, cluster_id, graph_idx, func_idx, g->cluster.graph);
 
   if (0 != g->Build(this, _exec_options)) {
     return nullptr;
   }
+  g->task_group = true;
+  g->last_used_ustime.store(ustime(), std::memory_order_relaxed);
+  _task_group_compiled.fetch_add(1, std::memory_order_relaxed);
+  return PublishTaskGroupCluster(std::move(g));
+}
+std::shared_ptr<GraphClusterHandle> GraphStore::PublishTaskGroupCluster(std::shared_ptr<GraphClusterHandle> g) {
+  std::vector<std::shared_ptr<GraphClusterHandle>> evicted;
   {
     std::lock_guard<std::mutex> guard(_graphs_mutex);
-    _graphs[g->cluster._name].store(g);
+    auto table = std::make_shared<ClusterTable>(*_cluster_table.load());
+    std::shared_ptr<GraphClusterHandle>& slot = table->clusters[g->cluster._name];
+    if (slot) {
+      if (slot->cluster.desc != g->cluster.desc) {
+        DIDAGLE_ERROR("Task group cluster:{} conflicts with another group structure.", g->cluster._name);
+        return nullptr;
+      }
+      return slot;
+    }
+    slot = g;
+    _task_group_clusters++;
+    size_t limit = _exec_options->task_group_cluster_limit;
+    while (limit > 0 && _task_group_clusters > limit) {
+      // linear scan only when a new structure is compiled, which is much more expensive
+      auto lru = table->clusters.end();
+      for (auto it = table->clusters.begin(); it != table->clusters.end(); ++it) {
+        if (!it->second->task_group || it->second == g) {
+          continue;
+        }
+        if (lru == table->clusters.end() ||
+            it->second->last_used_ustime.load(std::memory_order_relaxed) <
+                lru->second->last_used_ustime.load(std::memory_order_relaxed)) {
+          lru = it;
+        }
+      }
+      if (lru == table->clusters.end()) {
+        break;
+      }
+      evicted.emplace_back(std::move(lru->second));
+      table->clusters.erase(lru);
+      _task_group_clusters--;
+      _task_group_evicted.fetch_add(1, std::memory_order_relaxed);
+    }
+    table->generation = g_cluster_generation.fetch_add(1) + 1;
+    uint64_t generation = table->generation;
+    _cluster_table.store(std::move(table));
+    _cluster_generation.store(generation, std::memory_order_release);
   }
-
+  ReleaseClusters(std::move(evicted));
   return g;
 }
+void GraphStore::GetTaskGroupClusterStats(TaskGroupClusterStats& stats) {
+  {
+    std::lock_guard<std::mutex> guard(_graphs_mutex);
+    stats.clusters = _task_group_clusters;
+  }
+  stats.compiled = _task_group_compiled.load(std::memory_order_relaxed);
+  stats.evicted = _task_group_evicted.load(std::memory_order_relaxed);
+}
 
 bool GraphStore::Exists(const std::string& cluster, const std::string& graph) {
   std::shared_ptr<GraphClusterHandle> c = FindGraphClusterByName(cluster);
@@ -173,6 +489,123 @@ bool GraphStore::Exists(const std::string& cluster, const std::string& graph) {
   return c->cluster.Exists(graph);
 }
 
+/**
+ * @brief enable event tracker by the sampling settings of graph if caller did not enable it,
+ * returns the slow threshold in us if the events are only buffered for tail sampling, otherwise 0.
+ */
+uint64_t GraphStore::SampleEventTracker(GraphDataContext& data_ctx, GraphClusterContext* ctx,
+                                        const std::string& graph) {
+  if (!ctx->GetCluster()->_trace_sampling || nullptr != data_ctx.GetEventTracker()) {
+    return 0;
+  }
+  const Graph* g = ctx->GetCluster()->FindGraphByName(graph);
+  if (nullptr == g) {
+    return 0;
+  }
+  double sample_rate = g->GetTraceSampleRate();
+  if (sample_rate > 0) {
+    thread_local std::minstd_rand engine(std::random_device{}());
+    if (sample_rate >= 1.0 || std::uniform_real_distribution<double>(0.0, 1.0)(engine) < sample_rate) {
+      data_ctx.EnableEventTracker();
+      data_ctx.GetEventTracker()->sample_reason = SAMPLE_BY_RATE;
+      return 0;
+    }
+  }
+  int64_t slow_threshold_ms = g->GetTraceSlowThresholdMs();
+  if (slow_threshold_ms > 0) {
+    data_ctx.EnableEventTracker();
+    data_ctx.GetEventTracker()->sample_reason = SAMPLE_BY_LATENCY;
+    return static_cast<uint64_t>(slow_threshold_ms) * 1000;
+  }
+  return 0;
+}
+
+int GraphStore::GetGraphClusters(const std::string& cluster,
+                                 std::vector<std::shared_ptr<GraphClusterHandle>>& clusters) {
+  if (!cluster.empty()) {
+    std::shared_ptr<GraphClusterHandle> c = FindGraphClusterByName(cluster);
+    if (!c) {
+      DIDAGLE_ERROR("Find graph cluster {} failed.", cluster);
+      return -1;
+    }
+    clusters.emplace_back(c);
+    return 0;
+  }
+  std::shared_ptr<const ClusterTable> table = _cluster_table.load();
+  for (const auto& [_, c] : table->clusters) {
+    clusters.emplace_back(c);
+  }
+  return 0;
+}
+
+void GraphStore::AddFlightRecord(GraphDataContext& data_ctx, GraphClusterContext* ctx, const Graph* g, int code,
+                                 uint64_t start_ustime, uint64_t end_ustime) {
+  DAGEventTracker* tracker = data_ctx.GetEventTracker();
+  uint64_t slow_threshold_us = _exec_options->flight_recorder_slow_ms * 1000;
+  bool slow = slow_threshold_us > 0 && end_ustime - start_ustime >= slow_threshold_us;
+  if (nullptr == tracker || (0 == code && !slow)) {
+    return;
+  }
+  auto record = std::make_shared<FlightRecord>();
+  record->cluster = ctx->GetCluster()->_name;
+  record->graph = g->name;
+  record->start_ustime = start_ustime;
+  record->end_ustime = end_ustime;
+  record->rc = code;
+  tracker->VisitRecords([&](const DAGEventRecord& event) { record->records.emplace_back(event); });
+  _flight_recorder->Add(std::move(record));
+}
+
+int GraphStore::GetVertexLatencyStats(const std::string& cluster, std::vector<VertexLatencySnapshot>& snapshots) {
+  if (!_exec_options->vertex_latency_stats) {
+    DIDAGLE_ERROR("'vertex_latency_stats' is not enabled.");
+    return -1;
+  }
+  std::vector<std::shared_ptr<GraphClusterHandle>> clusters;
+  if (0 != GetGraphClusters(cluster, clusters)) {
+    return -1;
+  }
+  for (auto& c : clusters) {
+    c->GetLatencyStats(snapshots);
+  }
+  return 0;
+}
+
+int GraphStore::GetCriticalPathReport(const std::string& cluster, CriticalPathReport& report) {
+  if (!_exec_options->critical_path_stats) {
+    DIDAGLE_ERROR("'critical_path_stats' is not enabled.");
+    return -1;
+  }
+  std::vector<std::shared_ptr<GraphClusterHandle>> clusters;
+  if (0 != GetGraphClusters(cluster, clusters)) {
+    return -1;
+  }
+  for (auto& c : clusters) {
+    c->GetCriticalPathReport(report);
+  }
+  report.Sort();
+  return 0;
+}
+
+void GraphStore::AddCriticalPathStats(GraphDataContextPtr data_ctx, std::shared_ptr<GraphClusterHandle> handle,
+                                      const Graph* g, uint64_t scope) {
+  if (!handle || handle->critical_path_stats.Empty()) {
+    return;
+  }
+  // analyzed in background after the request is done, 'data_ctx' keeps the events & the cluster context alive
+  std::shared_ptr<AsyncResetWorker> worker = AsyncResetWorker::GetInstance();
+  if (!worker) {
+    return;
+  }
+  worker->Post([data_ctx = std::move(data_ctx), handle = std::move(handle), g, scope]() mutable {
+    const DAGEventTracker* tracker = data_ctx->GetEventTracker();
+    if (nullptr != tracker) {
+      handle->critical_path_stats.Add(*g, *tracker, scope);
+    }
+    data_ctx.reset();
+  });
+}
+
 int GraphStore::Execute(GraphDataContextPtr data_ctx, const std::string& cluster, const std::string& graph,
                         ParamsPtr params, DoneClosure&& done, uint64_t time_out_ms) {
   if (!_exec_options->async_executor) {
@@ -217,10 +650,45 @@ int GraphStore::Execute(GraphDataContextPtr data_ctx, const std::string& cluster
   auto release_closure = [release_func](int rc) mutable { AsyncResetWorker::GetInstance()->Post(release_func); };
   data_ctx->SetReleaseClosure(std::move(release_closure));
 
-  auto graph_done = [params, data_ctx, done](int code) mutable {
+  uint64_t trace_slow_threshold_us = SampleEventTracker(*data_ctx, ctx, graph);
+  bool flight_tracing = false;
+  if (_flight_recorder && nullptr == data_ctx->GetEventTracker()) {
+    // unknown whether the request would be slow or failed, track it & drop events after execution
+    data_ctx->EnableEventTracker();
+    data_ctx->GetEventTracker()->sample_reason = SAMPLE_BY_FLIGHT_RECORDER;
+    flight_tracing = true;
+  }
+  uint64_t start_exec_ustime = (trace_slow_threshold_us > 0 || _flight_recorder) ? ustime() : 0;
+  const Graph* done_graph = (_exec_options->critical_path_stats || _flight_recorder)
+                                ? ctx->GetCluster()->FindGraphByName(graph)
+                                : nullptr;
+  auto graph_done = [this, params, data_ctx, done, trace_slow_threshold_us, start_exec_ustime, flight_tracing,
+                     done_graph, ctx](int code) mutable {
+    uint64_t exec_end_ustime = 0 != start_exec_ustime ? ustime() : 0;
+    if (_flight_recorder && nullptr != done_graph) {
+      AddFlightRecord(*data_ctx, ctx, done_graph, code, start_exec_ustime, exec_end_ustime);
+    }
+    if (flight_tracing) {
+      data_ctx->DisableEventTracker();
+    } else if (trace_slow_threshold_us > 0 && exec_end_ustime - start_exec_ustime < trace_slow_threshold_us) {
+      // not slow enough, drop events buffered for tail sampling
+      data_ctx->DisableEventTracker();
+    }
+    GraphDataContextPtr critical_path_ctx;
+    std::shared_ptr<GraphClusterHandle> critical_path_cluster;
+    uint64_t critical_path_scope = 0;
+    if (_exec_options->critical_path_stats && nullptr != done_graph && nullptr != data_ctx->GetEventTracker()) {
+      critical_path_ctx = data_ctx;
+      critical_path_cluster = ctx->GetRunningCluster();
+      critical_path_scope = reinterpret_cast<uintptr_t>(ctx->GetRunningGraph());
+    }
     data_ctx.reset();
     done(code);
     params.reset();
+    if (critical_path_ctx) {
+      AddCriticalPathStats(std::move(critical_path_ctx), std::move(critical_path_cluster), done_graph,
+                           critical_path_scope);
+    }
 
     // AsyncResetWorker::GetInstance()->Post([this, ctx]() mutable {
     //   uint64_t start_exec_ustime = ustime();
@@ -269,16 +737,29 @@ int GraphStore::SyncExecute(GraphDataContextPtr data_ctx, const std::string& clu
 }
 
 int GraphStore::AsyncExecute(TaskGroupPtr graph, DoneClosure&& done, uint64_t time_out_ms) {
+  return AsyncExecute(graph, GraphDataContext::New(), nullptr, std::move(done), time_out_ms);
+}
+int GraphStore::AsyncExecute(TaskGroupPtr graph, GraphDataContextPtr data_ctx, ParamsPtr params, DoneClosure&& done,
+                             uint64_t time_out_ms) {
   std::shared_ptr<GraphClusterHandle> c = LoadTaskGroup(graph);
   if (!c) {
     done(-1);
     return -1;
   }
-  GraphDataContextPtr data_ctx = GraphDataContext::New();
-  return Execute(data_ctx, graph->ClusterId(), graph->Id(), nullptr, std::move(done), time_out_ms);
+  auto funcs = std::make_shared<TaskFuncTable>();
+  graph->CollectFuncs(funcs->funcs);
+  data_ctx->Set(kTaskFuncTableName, funcs.get());
+  // the group owns the bound functions, keep both alive until the execution is done
+  return Execute(
+      data_ctx, c->cluster._name, TaskGroup::GetGraphName(0), params,
+      [graph, funcs, done = std::move(done)](int rc) { done(rc); }, time_out_ms);
 }
 
 int GraphStore::SyncExecute(TaskGroupPtr graph, uint64_t time_out_ms) {
+  return SyncExecute(graph, GraphDataContext::New(), nullptr, time_out_ms);
+}
+int GraphStore::SyncExecute(TaskGroupPtr graph, GraphDataContextPtr data_ctx, ParamsPtr params,
+                            uint64_t time_out_ms) {
   if (!_exec_options->latch_creator) {
     DIDAGLE_ERROR("Empty 'latch_creator'");
     return -1;
@@ -286,7 +767,7 @@ int GraphStore::SyncExecute(TaskGroupPtr graph, uint64_t time_out_ms) {
   auto latch = _exec_options->latch_creator(1);
   int code = 0;
   int rc = AsyncExecute(
-      graph,
+      graph, data_ctx, params,
       [&](int rc) {
         code = rc;
         latch->CountDown();
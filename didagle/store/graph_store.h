@@ -8,7 +8,10 @@
 #include <atomic>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "folly/concurrency/AtomicSharedPtr.h"
 #include "folly/concurrency/UnboundedQueue.h"
 #include "folly/container/F14Map.h"
 
@@ -16,36 +19,142 @@
 #include "didagle/store/background_worker.h"
 #include "didagle/store/cluster_context.h"
 #include "didagle/store/common.h"
+#include "didagle/store/flight_recorder.h"
 #include "didagle/store/graph_task.h"
 
 namespace didagle {
 
+struct ClusterLoadResult {
+  std::string file;
+  std::string cluster;
+  int rc = -1;
+  std::string error;
+  // time spent in parsing DSL, building & verifying graphs, filling the context pool
+  uint64_t parse_us = 0;
+  uint64_t build_us = 0;
+  uint64_t prewarm_us = 0;
+};
+
+struct TaskGroupClusterStats {
+  size_t clusters = 0;
+  uint64_t compiled = 0;
+  uint64_t evicted = 0;
+};
+
 class GraphStore {
  public:
   explicit GraphStore(const GraphExecuteOptions& options);
 
+  /**
+   * @brief load or reload a cluster, reloading an unchanged DSL keeps the running version. a changed one is
+   * built & pre-warmed before the swap, the replaced version is released in background.
+   */
   std::shared_ptr<GraphClusterHandle> Load(const std::string& file);
   std::shared_ptr<GraphClusterHandle> LoadString(const std::string& content);
+  /**
+   * @brief load all clusters of a binary graph plan compiled by 'tools/graph_compile', no cluster is replaced if
+   * any of them failed to build. only the TOML parsing is saved, clusters are fully built & pre-warmed as 'Load',
+   * reloading an unchanged plan keeps the running clusters.
+   */
+  int LoadPlan(const std::string& file);
+  /**
+   * @brief load DSL files on 'concurrency' threads(hardware concurrency if 0), subgraph references to other
+   * clusters are resolved against the whole batch & loaded clusters once all files are built. clusters with
+   * errors & clusters referencing them are not published, 'results' is in the order of 'files'. return 0 if all clusters are loaded.
+   * reloads are handled as 'Load': unchanged files keep their running clusters.
+   */
+  int LoadBatch(const std::vector<std::string>& files, std::vector<ClusterLoadResult>& results,
+                size_t concurrency = 0);
+  /**
+   * @brief 'LoadBatch' all '*.toml' files in 'dir'.
+   */
+  int LoadDirectory(const std::string& dir, std::vector<ClusterLoadResult>& results, size_t concurrency = 0);
+  /**
+   * @brief lock free lookup on a snapshot of loaded clusters.
+   */
   std::shared_ptr<GraphClusterHandle> FindGraphClusterByName(const std::string& name);
   GraphClusterContext* GetGraphClusterContext(const std::string& cluster);
+  GraphClusterContext* GetGraphClusterContext(std::shared_ptr<GraphClusterHandle> cluster);
+  /**
+   * @brief generation of the cluster table, changed every time clusters are published(unique among all stores).
+   * handles resolved by name could be cached until the generation changes.
+   */
+  inline uint64_t GetClusterGeneration() const { return _cluster_generation.load(std::memory_order_acquire); }
   int Execute(GraphDataContextPtr data_ctx, const std::string& cluster, const std::string& graph, ParamsPtr params,
               DoneClosure&& done, uint64_t time_out_ms = 0);
   int SyncExecute(GraphDataContextPtr data_ctx, const std::string& cluster, const std::string& graph,
                   ParamsPtr params = nullptr, uint64_t time_out_ms = 0);
   bool Exists(const std::string& cluster, const std::string& graph);
+  /**
+   * @brief snapshot latency histograms of all vertices in 'cluster', or all clusters if 'cluster' is empty,
+   * requires 'GraphExecuteOptions::vertex_latency_stats'.
+   */
+  int GetVertexLatencyStats(const std::string& cluster, std::vector<VertexLatencySnapshot>& snapshots);
+  /**
+   * @brief critical path statistics of traced requests in 'cluster', or all clusters if 'cluster' is empty,
+   * vertexs most often on the critical path come first. requires 'GraphExecuteOptions::critical_path_stats'.
+   */
+  int GetCriticalPathReport(const std::string& cluster, CriticalPathReport& report);
+  /**
+   * @brief recorder of slow or failed requests, null if 'GraphExecuteOptions::flight_recorder_size' is 0.
+   */
+  inline FlightRecorder* GetFlightRecorder() { return _flight_recorder.get(); }
 
+  /**
+   * @brief execute a task group, groups with the same structure are compiled once into a cached cluster, and
+   * functions of 'graph' are bound into 'data_ctx' for this execution only.
+   */
   int AsyncExecute(TaskGroupPtr graph, DoneClosure&& done, uint64_t time_out_ms = 0);
+  int AsyncExecute(TaskGroupPtr graph, GraphDataContextPtr data_ctx, ParamsPtr params, DoneClosure&& done,
+                   uint64_t time_out_ms = 0);
   int SyncExecute(TaskGroupPtr graph, uint64_t time_out_ms = 0);
+  int SyncExecute(TaskGroupPtr graph, GraphDataContextPtr data_ctx, ParamsPtr params, uint64_t time_out_ms = 0);
+  /**
+   * @brief number of cached TaskGroup clusters, & how many were compiled or evicted by
+   * 'GraphExecuteOptions::task_group_cluster_limit'.
+   */
+  void GetTaskGroupClusterStats(TaskGroupClusterStats& stats);
   ~GraphStore();
 
  private:
   static constexpr uint32_t kWaitRunningGraphCompleteTimeUs = 1000;
-  Graph BuildGraphByTaskGroup(TaskGroupPtr graph);
+  void BuildGraphByTaskGroup(const TaskGroup& group, const std::string& cluster, size_t& graph_idx,
+                             size_t& func_idx, std::vector<Graph>& graphs);
+  uint64_t SampleEventTracker(GraphDataContext& data_ctx, GraphClusterContext* ctx, const std::string& graph);
+  void AddCriticalPathStats(GraphDataContextPtr data_ctx, std::shared_ptr<GraphClusterHandle> handle, const Graph* g,
+                            uint64_t scope);
+  void AddFlightRecord(GraphDataContext& data_ctx, GraphClusterContext* ctx, const Graph* g, int code,
+                       uint64_t start_ustime, uint64_t end_ustime);
+  int GetGraphClusters(const std::string& cluster, std::vector<std::shared_ptr<GraphClusterHandle>>& clusters);
   std::shared_ptr<GraphClusterHandle> LoadTaskGroup(TaskGroupPtr graph);
-  using ClusterGraphTable = folly::F14NodeMap<std::string, folly::atomic_shared_ptr<GraphClusterHandle>>;
-  ClusterGraphTable _graphs;
+  // publish a compiled TaskGroup cluster & evict the least recently used ones beyond the limit, the cluster
+  // published by a concurrent compilation of the same structure is returned if any
+  std::shared_ptr<GraphClusterHandle> PublishTaskGroupCluster(std::shared_ptr<GraphClusterHandle> g);
+  void ReleaseClusters(std::vector<std::shared_ptr<GraphClusterHandle>>&& clusters);
+  /**
+   * @brief build & pre-warm 'g' to replace the running cluster of the same name, the running one is returned if
+   * the content hash is unchanged. null if failed to build.
+   */
+  std::shared_ptr<GraphClusterHandle> BuildCluster(std::shared_ptr<GraphClusterHandle> g,
+                                                   ClusterLoadResult* result = nullptr);
+  std::shared_ptr<GraphClusterHandle> Reload(std::shared_ptr<GraphClusterHandle> g);
+  // immutable snapshot of loaded clusters, replaced as a whole by writers
+  struct ClusterTable {
+    folly::F14FastMap<std::string, std::shared_ptr<GraphClusterHandle>> clusters;
+    uint64_t generation = 0;
+  };
+  // every load path publishes through here, replaced clusters are released in background
+  void PublishClusters(const std::vector<std::shared_ptr<GraphClusterHandle>>& handles);
+  folly::atomic_shared_ptr<const ClusterTable> _cluster_table;
+  std::atomic<uint64_t> _cluster_generation{0};
   GraphExecuteOptionsPtr _exec_options;
+  std::unique_ptr<FlightRecorder> _flight_recorder;
+  // serializes writers of '_cluster_table'
   std::mutex _graphs_mutex;
+  // guarded by '_graphs_mutex'
+  size_t _task_group_clusters = 0;
+  std::atomic<uint64_t> _task_group_compiled{0};
+  std::atomic<uint64_t> _task_group_evicted{0};
   GraphExecFunc _graph_exec_func_;
   // std::unique_ptr<AsyncResetWorker> _async_reset_worker;
   std::atomic<uint32_t> running_graphs_{0};
@@ -29,18 +29,43 @@
 ** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "didagle/store/graph_task.h"
+#include <fmt/core.h>
 #include <atomic>
+#include <functional>
 #include <memory>
 
+#include "didagle/log/log.h"
+
 namespace didagle {
 static constexpr std::string_view k_task_prefix = "didagle_task_";
 static constexpr std::string_view k_task_group_cluster_prefix = "didagle_task_group_cluster_";
 static constexpr std::string_view k_task_group_prefix = "didagle_task_group_";
-static constexpr std::string_view k_processor_prefix = "didagle_task_processor_";
 static std::atomic<uint64_t> g_task_group_id_seed{0};
 static std::atomic<uint64_t> g_task_id_seed{0};
-static std::atomic<uint64_t> g_task_group_cluster_id_seed{0};
-static std::atomic<uint64_t> g_processor_id_seed{0};
+
+namespace {
+class TaskFuncProcessor : public Processor {
+ public:
+  std::string_view Name() const override { return kTaskFuncProcessorName; }
+  int OnExecute(const Params& args) override {
+    const TaskFuncTable* table = GetDataContext().Get<TaskFuncTable>(kTaskFuncTableName);
+    static const ParamsKey kIndexKey(ParamsString(kTaskFuncIndexKey.data(), kTaskFuncIndexKey.size()));
+    int64_t idx = args[kIndexKey].Int();
+    if (nullptr == table || idx < 0 || static_cast<size_t>(idx) >= table->funcs.size()) {
+      DIDAGLE_ERROR("No task function:{} bound in data context.", idx);
+      return -1;
+    }
+    return (*table->funcs[idx])(args);
+  }
+};
+}  // namespace
+
+bool register_task_func_processor() {
+  static bool registered = ProcessorFactory::Register(kTaskFuncProcessorName, []() -> Processor* {
+    return new TaskFuncProcessor;
+  });
+  return registered;
+}
 Task::Task(const std::string& processor, const std::string& group_id) {
   processor_ = processor;
   group_id_ = group_id;
@@ -66,32 +91,86 @@ TaskGroup::TaskGroup() {
   std::string s(k_task_group_prefix);
   s.append(std::to_string(g_task_group_id_seed.fetch_add(1)));
   id_ = s;
-  std::string ss(k_task_group_cluster_prefix);
-  ss.append(std::to_string(g_task_group_cluster_id_seed.fetch_add(1)));
-  cluster_id_ = ss;
 }
 
+// task ids are local to the group, so that groups built by the same code have the same structure
+static void add_task(std::vector<TaskPtr>& tasks, TaskPtr task) {
+  task->Name(std::string(k_task_prefix) + std::to_string(tasks.size()));
+  tasks.emplace_back(std::move(task));
+}
 TaskPtr TaskGroup::Add(ExecFunc&& f) {
-  std::string s(k_processor_prefix);
-  s.append(std::to_string(g_processor_id_seed.fetch_add(1)));
-  bool r = register_func_processor(s, std::move(f));
-  if (!r) {
-    return nullptr;
-  }
-  auto task = std::make_shared<Task>(s, "");
-  tasks_.emplace_back(task);
+  auto task = std::make_shared<Task>(std::string(kTaskFuncProcessorName), "");
+  task->func_idx_ = static_cast<int32_t>(funcs_.size());
+  task->func_ = std::make_shared<ExecFunc>(std::move(f));
+  funcs_.emplace_back(task->func_);
+  add_task(tasks_, task);
   return task;
 }
 TaskPtr TaskGroup::Add(TaskGroupPtr group) {
   childs_.emplace_back(group);
-  group->cluster_id_ = cluster_id_;
   auto new_task = std::make_shared<Task>("", group->id_);
-  tasks_.emplace_back(new_task);
+  new_task->group_ = group;
+  add_task(tasks_, new_task);
   return new_task;
 }
 TaskPtr TaskGroup::Clone(TaskPtr task) {
   auto new_task = std::make_shared<Task>(task->processor_, task->group_id_);
-  tasks_.emplace_back(new_task);
+  if (task->func_) {
+    // the cloned task may come from another group, bind its function into this group
+    new_task->func_idx_ = static_cast<int32_t>(funcs_.size());
+    new_task->func_ = task->func_;
+    funcs_.emplace_back(task->func_);
+  }
+  new_task->group_ = task->group_;
+  add_task(tasks_, new_task);
   return new_task;
 }
+void TaskGroup::AppendStructure(std::string& s) const {
+  auto append_ids = [&s](char type, const std::set<std::string>& ids) {
+    for (const auto& id : ids) {
+      s.append(1, type).append(id);
+    }
+  };
+  s.append("{");
+  for (const auto& task : tasks_) {
+    s.append(task->id_).append("=");
+    if (task->group_) {
+      task->group_->AppendStructure(s);
+    } else if (task->func_idx_ >= 0) {
+      s.append("$").append(std::to_string(task->func_idx_));
+    } else {
+      s.append(task->processor_);
+    }
+    append_ids('<', task->precede_);
+    append_ids('>', task->succeed_);
+    append_ids('+', task->consequent_);
+    append_ids('-', task->alternative_);
+    s.append(";");
+  }
+  s.append("}");
+}
+std::string TaskGroup::GetStructure() const {
+  std::string s;
+  AppendStructure(s);
+  return s;
+}
+std::string TaskGroup::ClusterId() const { return GetClusterId(GetStructure()); }
+std::string TaskGroup::GetClusterId(const std::string& structure) {
+  return fmt::format("{}{:016x}", k_task_group_cluster_prefix, std::hash<std::string>{}(structure));
+}
+void TaskGroup::CollectFuncs(std::vector<const ExecFunc*>& funcs) const {
+  for (const auto& f : funcs_) {
+    funcs.emplace_back(f.get());
+  }
+  for (const auto& task : tasks_) {
+    if (task->group_) {
+      task->group_->CollectFuncs(funcs);
+    }
+  }
+}
+std::string TaskGroup::GetGraphName(size_t idx) {
+  std::string s(k_task_group_prefix);
+  s.append(std::to_string(idx));
+  return s;
+}
 }  // namespace didagle
\ No newline at end of file
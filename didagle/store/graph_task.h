@@ -30,6 +30,7 @@
 */
 
 #pragma once
+#include <stdint.h>
 #include <memory>
 #include <set>
 #include <string>
@@ -44,6 +45,19 @@ class TaskGroup;
 class GraphStore;
 using TaskPtr = std::shared_ptr<Task>;
 using TaskGroupPtr = std::shared_ptr<TaskGroup>;
+
+/**
+ * @brief builtin processor running the function bound to current execution, functions of a task group are
+ * bound into the data context as 'TaskFuncTable' instead of being registered globally.
+ */
+constexpr std::string_view kTaskFuncProcessorName = "didagle_task_func";
+constexpr std::string_view kTaskFuncTableName = "__didagle_task_funcs__";
+constexpr std::string_view kTaskFuncIndexKey = "__didagle_task_func__";
+struct TaskFuncTable {
+  std::vector<const ExecFunc*> funcs;
+};
+bool register_task_func_processor();
+
 class Task {
  public:
   Task(const std::string& processor, const std::string& group_id);
@@ -64,6 +78,10 @@ class Task {
   std::string id_;
   std::string processor_;
   std::string group_id_;
+  // index in functions of owner group, or the subgroup executed by this task
+  int32_t func_idx_ = -1;
+  std::shared_ptr<ExecFunc> func_;
+  TaskGroupPtr group_;
   std::set<std::string> precede_;
   std::set<std::string> succeed_;
   std::set<std::string> consequent_;
@@ -80,14 +98,33 @@ class TaskGroup {
   TaskPtr Add(TaskGroupPtr group);
   TaskPtr Clone(TaskPtr task);
   const std::string& Id() const { return id_; }
-  const std::string& ClusterId() const { return cluster_id_; }
+  /**
+   * @brief cluster id by the structural hash of the whole group(tasks, edges & subgroups), functions are not part
+   * of the structure, so groups with the same shape share one compiled cluster.
+   */
+  std::string ClusterId() const;
+  static std::string GetClusterId(const std::string& structure);
+  /**
+   * @brief canonical text of the group structure, which is the key of compiled cluster.
+   */
+  std::string GetStructure() const;
+  /**
+   * @brief functions of this group & subgroups, in the order of the indexes assigned by the compiled cluster.
+   */
+  void CollectFuncs(std::vector<const ExecFunc*>& funcs) const;
+  size_t GetFuncCount() const { return funcs_.size(); }
+  /**
+   * @brief name of the 'idx'th graph in the compiled cluster, subgroups are numbered in preorder from the root 0.
+   */
+  static std::string GetGraphName(size_t idx);
   const std::vector<TaskGroupPtr>& SubTaskGroups() const { return childs_; }
   const std::vector<TaskPtr>& Tasks() const { return tasks_; }
 
  private:
-  std::string cluster_id_;
+  void AppendStructure(std::string& s) const;
   std::string id_;
   std::vector<TaskPtr> tasks_;
   std::vector<TaskGroupPtr> childs_;
+  std::vector<std::shared_ptr<ExecFunc>> funcs_;
 };
 }  // namespace didagle
\ No newline at end of file
@@ -44,19 +44,54 @@ int VertexContext::Setup(GraphContext* g, Vertex* v) {
     _processor = ProcessorFactory::GetProcessor(_vertex->processor);
     if (_processor) {
       _processor->id_ = _vertex->id;
+      _processor->KeepParamsOnReset(
+          _graph_ctx->GetGraphClusterContext()->GetGraphExecuteOptions()->keep_processor_params);
     }
   }
+  _latency_stats = _graph_ctx->GetGraphClusterContext()->GetLatencyStats(_vertex);
+  _trace_names.vertex = TraceNameTable::Intern(_vertex->id);
+  _trace_names.scope = reinterpret_cast<uintptr_t>(_graph_ctx);
+  if (nullptr != _processor) {
+    _trace_names.processor = TraceNameTable::Intern(_processor->Name());
+  } else {
+    _trace_names.graph = TraceNameTable::Intern(_vertex->graph);
+    _trace_names.cluster = TraceNameTable::Intern(_vertex->_graph->_cluster->_name);
+    _trace_names.full_graph_name = TraceNameTable::Intern(_full_graph_name);
+  }
   if (_graph_ctx->GetGraphCluster()->strict_dsl) {
     if (nullptr == _processor && !_vertex->processor.empty()) {
       DIDAGLE_ERROR("No processor found for {}", _vertex->processor);
       return -1;
     }
   }
-  _params = _vertex->args;
+  _args = &_vertex->args;
+  if (nullptr != _processor && (!_vertex->cond.empty() || !_vertex->while_cond.empty())) {
+    _own_args = std::make_unique<Params>(_vertex->args);
+    if (!_vertex->cond.empty()) {
+      _own_args->SetString(_vertex->cond);
+    }
+    if (!_vertex->while_cond.empty()) {
+      (*_own_args)[std::string(kExprParamKey)].SetString(_vertex->while_cond);
+      (*_own_args)[std::string(kWhileExecCluterParamKey)].SetString(_vertex->cluster);
+      (*_own_args)[std::string(kWhileExecGraphParamKey)].SetString(_vertex->graph);
+      (*_own_args)[std::string(kWhileAsyncExecParamKey)].SetBool(_vertex->while_async);
+      _own_args->Compile();
+    }
+    _args = _own_args.get();
+  }
+  if (!_vertex->expect_config.empty()) {
+    std::string_view expect_config = _vertex->expect_config;
+    _expect_config_not = expect_config[0] == '!';
+    if (_expect_config_not) {
+      expect_config = expect_config.substr(1);
+    }
+    _expect_config_idx = _graph_ctx->GetGraphClusterContext()->FindConfigSetting(expect_config);
+  }
 
   for (const auto& select : _vertex->select_args) {
     SelectCondParamsContext select_ctx;
-    select_ctx.param = select;
+    select_ctx.param = &select;
+    select_ctx.trace_cond_id = TraceNameTable::Intern(select.match);
     if (select.IsCondExpr()) {
       select_ctx.p = ProcessorFactory::GetProcessor(_graph_ctx->GetGraphCluster()->default_expr_processor);
       if (select_ctx.p == nullptr && _graph_ctx->GetGraphCluster()->strict_dsl) {
@@ -72,8 +107,8 @@ int VertexContext::Setup(GraphContext* g, Vertex* v) {
         }
       }
     }
-    if (select.inherit_default) {
-      select_ctx.param.args.SetParent(&_params);
+    if (!select.IsCondExpr()) {
+      select_ctx.config_idx = _graph_ctx->GetGraphClusterContext()->FindConfigSetting(select.match);
     }
     _select_contexts.emplace_back(select_ctx);
   }
@@ -89,27 +124,25 @@ int VertexContext::Setup(GraphContext* g, Vertex* v) {
   }
   Reset();
   if (nullptr != _processor) {
-    if (!_vertex->cond.empty()) {
-      _params.SetString(_vertex->cond);
-    }
-    if (!_vertex->while_cond.empty()) {
-      _params[std::string(kExprParamKey)].SetString(_vertex->while_cond);
-      _params[std::string(kWhileExecCluterParamKey)].SetString(_vertex->cluster);
-      _params[std::string(kWhileExecGraphParamKey)].SetString(_vertex->graph);
-      _params[std::string(kWhileAsyncExecParamKey)].SetBool(_vertex->while_async);
-    }
-    return _processor->Setup(_params);
+    return _processor->Setup(*_args);
   }
   return 0;
 }
 
 void VertexContext::ResetState() {
   _exec_start_ustime = 0;
+  _exec_end_ustime = 0;
+  _ready_ustime = 0;
+  _dispatch_queue_depth = -1;
   _result = V_RESULT_INVALID;
   _code = V_CODE_INVALID;
   _exec_rc = INT_MAX;
   _deps_results.assign(_vertex->_deps_idx.size(), V_RESULT_INVALID);
   _waiting_num = _vertex->_deps_idx.size();
+#if DIDAGLE_HAS_COROUTINES
+  _ready_baton.reset();
+  _done_baton.reset();
+#endif
   if (nullptr != _subgraph_ctx) {
     _subgraph_ctx->ResetState();
   }
@@ -129,15 +162,30 @@ void VertexContext::Reset() {
   }
 
   for (auto& select : _select_contexts) {
-    select.param.args.SetParent(nullptr);
+    select.view.SetOverlay(&select.param->args, nullptr);
+    if (nullptr != select.p) {
+      select.p->Reset();
+    }
   }
-  _params.SetParent(nullptr);
+  _args_view.SetOverlay(_args, nullptr);
   _exec_params = nullptr;
   _exec_matched_cond = "";
+  _exec_matched_cond_id = 0;
 }
 
 VertexContext::VertexContext() { _waiting_num = 0; }
 
+void VertexContext::SetupDataVars(DataVarBindings& bindings) {
+  if (nullptr == _processor_di) {
+    return;
+  }
+  // vars shadowed by vertex/select args are resolved with the params of each execution
+  std::vector<const Params*> local_params = {_args};
+  for (const auto& select : _select_contexts) {
+    local_params.emplace_back(&select.param->args);
+  }
+  _processor_di->SetupDataVars(bindings, local_params);
+}
 void VertexContext::SetupSuccessors() {
   for (Vertex* successor : GetVertex()->_successor_vertex) {
     VertexContext* successor_ctx = _graph_ctx->FindVertexContext(successor);
@@ -166,7 +214,7 @@ void VertexContext::FinishVertexProcess(int code, bool adjust_code) {
   if (_exec_rc == INT_MAX) {
     _exec_rc = _code;
   }
-  auto exec_end_ustime = ustime();
+  auto exec_end_ustime = 0 != _exec_end_ustime ? _exec_end_ustime : ustime();
   if (0 != _code) {
     if (0 == _result) {
       _result = V_RESULT_ERR;
@@ -180,29 +228,37 @@ void VertexContext::FinishVertexProcess(int code, bool adjust_code) {
     if (nullptr != _processor_di) {
       uint64_t post_exec_start_ustime = ustime();
       _processor_di->CollectOutputs(_graph_ctx->GetGraphDataContextRef(), _exec_params);
-      if (nullptr != tracker) {
-        auto event = std::make_unique<DAGEvent>();
-        event->start_ustime = post_exec_start_ustime;
-        event->end_ustime = ustime();
-        event->phase = PhaseType::DAG_PHASE_OP_POST_EXECUTE;
-        tracker->Add(std::move(event));
+      if (nullptr != tracker || nullptr != _latency_stats) {
+        uint64_t post_exec_end_ustime = ustime();
+        if (nullptr != tracker) {
+          DAGEventRecord record;
+          record.vertex = _trace_names.vertex;
+          record.scope = _trace_names.scope;
+          record.start_ustime = post_exec_start_ustime;
+          record.end_ustime = post_exec_end_ustime;
+          record.phase = PhaseType::DAG_PHASE_OP_POST_EXECUTE;
+          tracker->Add(record);
+        }
+        if (nullptr != _latency_stats) {
+          _latency_stats->Record(VERTEX_LATENCY_POST_EXECUTE, post_exec_start_ustime, post_exec_end_ustime);
+        }
       }
     }
   }
+  if (nullptr != _latency_stats && 0 != _exec_start_ustime) {
+    _latency_stats->Record(VERTEX_LATENCY_EXECUTE, _exec_start_ustime, exec_end_ustime);
+  }
   if (nullptr != tracker) {
-    auto event = std::make_unique<DAGEvent>();
-    event->start_ustime = _exec_start_ustime;
-    event->end_ustime = exec_end_ustime;
-    if (nullptr != _processor) {
-      event->processor = _processor->Name();
-    } else {
-      event->graph = _vertex->graph;
-      event->cluster = _vertex->_graph->_cluster->_name;
-      event->full_graph_name = _full_graph_name;
+    DAGEventRecord record = _trace_names;
+    record.start_ustime = _exec_start_ustime;
+    record.end_ustime = exec_end_ustime;
+    record.matched_cond = _exec_matched_cond_id;
+    record.rc = _exec_rc;
+    record.code = _code;
+    if (nullptr != _subgraph_ctx) {
+      record.child_scope = reinterpret_cast<uintptr_t>(_subgraph_ctx);
     }
-    event->matched_cond = _exec_matched_cond;
-    event->rc = _exec_rc;
-    tracker->Add(std::move(event));
+    tracker->Add(record);
   }
   if (nullptr != _subgraph_ctx) {
     _graph_ctx->GetGraphDataContextRef().SetChild(_subgraph_ctx->GetGraphDataContext(), _child_idx);
@@ -210,81 +266,106 @@ void VertexContext::FinishVertexProcess(int code, bool adjust_code) {
   _graph_ctx->OnVertexDone(this);
 }
 const Params* VertexContext::GetExecParams(std::string_view* matched_cond) {
-  Params* exec_params = nullptr;
+  const Params* exec_params = nullptr;
   const Params* cluster_exec_params = _graph_ctx->GetGraphClusterContext()->GetExecuteParams();
+  // vertex/select args are shared by all contexts, layer them through views instead of 'SetParent'
+  _args_view.SetOverlay(_args, cluster_exec_params);
   // std::string_view matched_cond;
   if (!_select_contexts.empty()) {
     for (auto& select : _select_contexts) {
-      auto& args = select.param;
+      const CondParams& args = *select.param;
       if (args.IsCondExpr() && nullptr != select.p) {
         select.p->SetDataContext(_graph_ctx->GetGraphDataContext());
         int eval_rc;
         if (cluster_exec_params != nullptr) {
           eval_rc = select.p->Execute(*cluster_exec_params);
         } else {
-          Params params;
-          eval_rc = select.p->Execute(params);
+          static const Params empty_params;
+          eval_rc = select.p->Execute(empty_params);
         }
         if (eval_rc == 0) {
-          exec_params = &(args.args);
+          exec_params = &(select.view);
           *matched_cond = select.p->GetString(Processor::GetStringMode::kDefault);
-          break;
+          _exec_matched_cond_id = select.trace_cond_id;
         }
       } else {
-        const bool* v = _graph_ctx->GetGraphDataContextRef().Get<bool>(args.match);
-        if (nullptr == v) {
-          DIDAGLE_DEBUG("0 Vertex:{} match {} null", _vertex->GetDotLable(), args.match);
-          continue;
+        bool matched = false;
+        if (select.config_idx >= 0) {
+          matched = _graph_ctx->GetGraphClusterContext()->GetConfigSettingResult(select.config_idx);
+        } else {
+          const bool* v = _graph_ctx->GetGraphDataContextRef().Get<bool>(args.match);
+          if (nullptr == v) {
+            DIDAGLE_DEBUG("0 Vertex:{} match {} null", _vertex->GetDotLable(), args.match);
+            continue;
+          }
+          matched = *v;
         }
-        DIDAGLE_DEBUG("0 Vertex:{} match {} args {}", _vertex->GetDotLable(), args.match, *v);
-        if (!(*v)) {
+        DIDAGLE_DEBUG("0 Vertex:{} match {} args {}", _vertex->GetDotLable(), args.match, matched);
+        if (!matched) {
           continue;
         }
         DIDAGLE_DEBUG("Vertex:{} match {} args", _vertex->GetDotLable(), args.match);
-        exec_params = &(args.args);
+        exec_params = &(select.view);
         *matched_cond = args.match;
+        _exec_matched_cond_id = select.trace_cond_id;
+      }
+      if (nullptr != exec_params) {
+        select.view.SetOverlay(&args.args, args.inherit_default ? &_args_view : cluster_exec_params);
         break;
       }
     }
   }
   if (nullptr == exec_params) {
-    exec_params = &_params;
-  }
-
-  if (nullptr != cluster_exec_params) {
-    exec_params->SetParent(cluster_exec_params);
+    exec_params = &_args_view;
   }
   return exec_params;
 }
 
-int VertexContext::ExecuteProcessor() {
+bool VertexContext::PrepareProcessor() {
   DIDAGLE_DEBUG("Vertex:{} begin execute", _vertex->GetDotLable());
   auto prepare_start_us = ustime();
   _processor->SetDataContext(_graph_ctx->GetGraphDataContext());
   _exec_params = GetExecParams(&_exec_matched_cond);
+  _processor->SetParamsVersion(_graph_ctx->GetGraphClusterContext()->GetExecuteParamsVersion());
   _processor->Prepare(*_exec_params);
   if (0 != _processor_di->InjectInputs(_graph_ctx->GetGraphDataContextRef(), _exec_params)) {
     DIDAGLE_DEBUG("Vertex:{} inject inputs failed", _vertex->GetDotLable());
     FinishVertexProcess(V_CODE_SKIP, false);
-    return 0;
+    return false;
   }
   auto prepare_end_ustime = ustime();
   DAGEventTracker* tracker = _graph_ctx->GetGraphDataContextRef().GetEventTracker();
   if (nullptr != tracker) {
-    auto event = std::make_unique<DAGEvent>();
-    event->start_ustime = prepare_start_us;
-    event->end_ustime = prepare_end_ustime;
-    event->phase = PhaseType::DAG_PHASE_OP_PREPARE_EXECUTE;
-    tracker->Add(std::move(event));
+    DAGEventRecord record;
+    record.vertex = _trace_names.vertex;
+    record.scope = _trace_names.scope;
+    record.start_ustime = prepare_start_us;
+    record.end_ustime = prepare_end_ustime;
+    record.phase = PhaseType::DAG_PHASE_OP_PREPARE_EXECUTE;
+    tracker->Add(record);
+  }
+  if (nullptr != _latency_stats) {
+    _latency_stats->Record(VERTEX_LATENCY_PREPARE, prepare_start_us, prepare_end_ustime);
+  }
+  return true;
+}
+
+int VertexContext::ExecuteProcessor() {
+  if (!PrepareProcessor()) {
+    return 0;
   }
   _exec_start_ustime = ustime();
   switch (_processor->GetExecMode()) {
     case Processor::ExecMode::EXEC_ASYNC_FUTURE: {
       try {
-        _processor->FutureExecute(*_exec_params).thenValue([this](int rc) {
-          _exec_rc = rc;
-          FinishVertexProcess(_exec_rc, true);
-        });
+        if (V_RESUME_INLINE == _vertex->_resume_on) {
+          _processor->FutureExecute(*_exec_params).thenValue([this](int rc) {
+            _exec_rc = rc;
+            FinishVertexProcess(_exec_rc, true);
+          });
+        } else {
+          _processor->FutureExecute(*_exec_params).thenValue([this](int rc) { ResumeVertexProcess(rc); });
+        }
       } catch (std::exception& ex) {
         DIDAGLE_ERROR("Vertex:{} execute with caught excetion:{} ", _vertex->GetDotLable(), ex.what());
         _exec_rc = V_CODE_ERR;
@@ -356,7 +437,22 @@ int VertexContext::ExecuteSubGraph() {
     _subgraph_ctx->Execute([this](int code) { FinishVertexProcess(code, true); });
   } else {
     _subgraph_cluster->SetExternGraphDataContext(_graph_ctx->GetGraphDataContext());
-    _subgraph_cluster->SetExecuteParams(_exec_params);
+    GraphClusterContext* cluster_ctx = _graph_ctx->GetGraphClusterContext();
+    uint64_t parent_params_version = cluster_ctx->GetExecuteParamsVersion();
+    if (_select_contexts.empty() && _vertex->args.Size() == 0) {
+      // no args of its own, pass current params through so that lazy config results could be shared
+      _subgraph_cluster->SetExecuteParams(cluster_ctx->GetExecuteParams(), parent_params_version);
+    } else {
+      if (_exec_params != _subgraph_params || parent_params_version != _subgraph_parent_params_version ||
+          0 == _subgraph_params_version) {
+        // effective params of subgraph changed, allocate a new version
+        _subgraph_params = _exec_params;
+        _subgraph_parent_params_version = parent_params_version;
+        _subgraph_params_version = GraphClusterContext::NextExecuteParamsVersion();
+      }
+      _subgraph_cluster->SetExecuteParams(_exec_params, _subgraph_params_version);
+    }
+    _subgraph_cluster->SetConfigSettingMemo(cluster_ctx->GetConfigSettingMemo());
     // succeed end time
     _subgraph_cluster->SetEndTime(_graph_ctx->GetGraphClusterContext()->GetEndTime());
     _subgraph_cluster->Execute(
@@ -365,11 +461,75 @@ int VertexContext::ExecuteSubGraph() {
 
   return 0;
 }
-int VertexContext::Execute() {
+void VertexContext::ResumeVertexProcess(int rc) {
+  _exec_rc = rc;
+  _exec_end_ustime = ustime();
+  const GraphExecuteOptions* exec_opts = _graph_ctx->GetGraphClusterContext()->GetGraphExecuteOptions().get();
+  const AsyncExecutor* executor = &exec_opts->async_executor;
+  if (V_RESUME_CPU == _vertex->_resume_on && exec_opts->cpu_executor) {
+    executor = &exec_opts->cpu_executor;
+  }
+  (*executor)([this]() {
+    uint64_t resume_ustime = ustime();
+    DAGEventTracker* tracker = _graph_ctx->GetGraphDataContextRef().GetEventTracker();
+    if (nullptr != tracker) {
+      DAGEventRecord record;
+      record.vertex = _trace_names.vertex;
+      record.scope = _trace_names.scope;
+      record.start_ustime = _exec_end_ustime;
+      record.end_ustime = resume_ustime;
+      record.phase = PhaseType::DAG_PHASE_OP_RESUME_HOP;
+      tracker->Add(record);
+    }
+    if (nullptr != _latency_stats) {
+      _latency_stats->Record(VERTEX_LATENCY_RESUME_HOP, _exec_end_ustime, resume_ustime);
+    }
+    FinishVertexProcess(_exec_rc, true);
+  });
+}
+void VertexContext::RecordReadyWait() {
+  uint64_t start_ustime = ustime();
+  DAGEventTracker* tracker = _graph_ctx->GetGraphDataContextRef().GetEventTracker();
+  if (nullptr != tracker) {
+    DAGEventRecord record;
+    record.vertex = _trace_names.vertex;
+    record.scope = _trace_names.scope;
+    record.start_ustime = _ready_ustime;
+    record.end_ustime = start_ustime;
+    record.queue_depth = _dispatch_queue_depth;
+    record.phase = PhaseType::DAG_PHASE_VERTEX_READY_WAIT;
+    tracker->Add(record);
+  }
+  if (nullptr != _latency_stats) {
+    _latency_stats->Record(VERTEX_LATENCY_READY_WAIT, _ready_ustime, start_ustime);
+    if (_dispatch_queue_depth >= 0) {
+      _latency_stats->dispatch_queue_depth.Record(_dispatch_queue_depth);
+    }
+  }
+  _ready_ustime = 0;
+  _dispatch_queue_depth = -1;
+}
+bool VertexContext::PrepareExecute() {
+  if (0 != _ready_ustime) {
+    RecordReadyWait();
+  }
   bool match_dep_expected_result = true;
-  if (!_vertex->cluster.empty() && nullptr != _graph_ctx->GetGraphClusterContext()->GetStore() &&
-      nullptr == _subgraph_cluster) {
-    _subgraph_cluster = _graph_ctx->GetGraphClusterContext()->GetStore()->GetGraphClusterContext(_vertex->cluster);
+  GraphStore* store = _graph_ctx->GetGraphClusterContext()->GetStore();
+  if (!_vertex->cluster.empty() && nullptr != store && nullptr == _subgraph_cluster) {
+    uint64_t generation = store->GetClusterGeneration();
+    std::shared_ptr<GraphClusterHandle> handle;
+    if (_vertex->cluster == _vertex->_graph->_cluster->_name) {
+      // subgraph of the same cluster runs on the version of the request, which may be replaced or evicted already
+      handle = _graph_ctx->GetGraphClusterContext()->GetRunningCluster();
+    } else if (generation == _subgraph_generation) {
+      handle = _subgraph_handle.lock();
+    }
+    if (!handle) {
+      handle = store->FindGraphClusterByName(_vertex->cluster);
+      _subgraph_handle = handle;
+      _subgraph_generation = generation;
+    }
+    _subgraph_cluster = store->GetGraphClusterContext(std::move(handle));
   }
   if (nullptr == _processor && nullptr == _subgraph_cluster) {
     match_dep_expected_result = false;
@@ -385,18 +545,20 @@ int VertexContext::Execute() {
   DIDAGLE_DEBUG("Vertex:{} match deps result:{}.", _vertex->GetDotLable(), match_dep_expected_result);
   if (match_dep_expected_result) {
     if (!_vertex->expect_config.empty()) {
-      std::string_view var_name = _vertex->expect_config;
-      bool not_cond = false;
-      if (var_name[0] == '!') {
-        var_name = var_name.substr(1);
-        not_cond = true;
-      }
-      const bool* v = _graph_ctx->GetGraphDataContextRef().Get<bool>(var_name);
       bool match_result = false;
-      if (nullptr != v) {
-        match_result = *v;
+      if (_expect_config_idx >= 0) {
+        match_result = _graph_ctx->GetGraphClusterContext()->GetConfigSettingResult(_expect_config_idx);
+      } else {
+        std::string_view var_name = _vertex->expect_config;
+        if (_expect_config_not) {
+          var_name = var_name.substr(1);
+        }
+        const bool* v = _graph_ctx->GetGraphDataContextRef().Get<bool>(var_name);
+        if (nullptr != v) {
+          match_result = *v;
+        }
       }
-      if (not_cond) {
+      if (_expect_config_not) {
         match_result = !match_result;
       }
       if (!match_result) {
@@ -420,14 +582,65 @@ int VertexContext::Execute() {
     _code = V_CODE_SKIP;
     // no need to exec this
     FinishVertexProcess(_code, false);
+    return false;
+  }
+  return true;
+}
+int VertexContext::Execute() {
+  if (!PrepareExecute()) {
+    return 0;
+  }
+  if (nullptr != _processor) {
+    ExecuteProcessor();
   } else {
-    if (nullptr != _processor) {
-      ExecuteProcessor();
-    } else {
+    ExecuteSubGraph();
+  }
+  return 0;
+}
+
+#if DIDAGLE_HAS_COROUTINES
+Awaitable<int> VertexContext::CoroExecuteProcessor() {
+  _exec_start_ustime = ustime();
+  try {
+    switch (_processor->GetExecMode()) {
+      case Processor::ExecMode::EXEC_ASYNC_FUTURE: {
+        // resumed on the executor of graph coroutine instead of the thread fulfilling the future
+        co_return co_await _processor->FutureExecute(*_exec_params).semi();
+      }
+#if ISPINE_HAS_COROUTINES
+      case Processor::ExecMode::EXEC_STD_COROUTINE: {
+        co_return co_await _processor->CoroExecute(*_exec_params);
+      }
+#endif
+      case Processor::ExecMode::EXEC_ADAPTIVE: {
+        co_return co_await _processor->AExecute(*_exec_params);
+      }
+      default: {
+        co_return _processor->Execute(*_exec_params);
+      }
+    }
+  } catch (std::exception& ex) {
+    DIDAGLE_ERROR("Vertex:{} execute with caught excetion:{} ", _vertex->GetDotLable(), ex.what());
+  } catch (...) {
+    DIDAGLE_ERROR("Vertex:{} execute with caught unknown excetion.", _vertex->GetDotLable());
+  }
+  co_return V_CODE_ERR;
+}
+
+Awaitable<void> VertexContext::CoroExecute() {
+  if (!_vertex->_deps_idx.empty()) {
+    co_await _ready_baton;
+  }
+  if (PrepareExecute()) {
+    if (nullptr == _processor) {
       ExecuteSubGraph();
+    } else if (PrepareProcessor()) {
+      _exec_rc = co_await CoroExecuteProcessor();
+      FinishVertexProcess(_exec_rc, true);
     }
   }
-  return 0;
+  co_await _done_baton;
 }
+#endif
 
 }  // namespace didagle
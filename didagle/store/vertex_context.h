@@ -21,10 +21,15 @@
 #include "didagle/processor/processor_di.h"
 #include "didagle/store/common.h"
 
+#if DIDAGLE_HAS_COROUTINES
+#include "folly/experimental/coro/Baton.h"
+#endif
+
 namespace didagle {
 
 class GraphContext;
 class GraphClusterContext;
+struct GraphClusterHandle;
 class GraphStore;
 class VertexContext {
  private:
@@ -38,19 +43,51 @@ class VertexContext {
   ProcessorDI* _processor_di = nullptr;
   GraphClusterContext* _subgraph_cluster = nullptr;
   GraphContext* _subgraph_ctx = nullptr;
+  // subgraph cluster resolved by name, valid until the cluster generation of store changes. weak since
+  // subgraphs of the same cluster would otherwise keep their own handle alive
+  std::weak_ptr<GraphClusterHandle> _subgraph_handle;
+  uint64_t _subgraph_generation = 0;
   std::string _full_graph_name;
-  Params _params;
+  // vertex args, shared with the vertex unless extra setup entries are needed
+  const Params* _args = nullptr;
+  std::unique_ptr<Params> _own_args;
+  // overlay of vertex args on cluster execute params
+  Params _args_view;
   std::vector<SelectCondParamsContext> _select_contexts;
   uint64_t _exec_start_ustime = 0;
+  // set when the future of an async processor is fulfilled if it does not resume inline
+  uint64_t _exec_end_ustime = 0;
+  // set when all dependencies are done if tracing or latency stats is enabled
+  uint64_t _ready_ustime = 0;
+  int32_t _dispatch_queue_depth = -1;
   size_t _child_idx = (size_t)-1;
   const Params* _exec_params = nullptr;
+  int _expect_config_idx = -1;
+  bool _expect_config_not = false;
+  // (params, parent version) -> version of params passed to subgraph
+  const Params* _subgraph_params = nullptr;
+  uint64_t _subgraph_parent_params_version = 0;
+  uint64_t _subgraph_params_version = 0;
   std::string_view _exec_matched_cond;
+  uint32_t _exec_matched_cond_id = 0;
+  // names of the vertex in trace records
+  DAGEventRecord _trace_names;
+  VertexLatencyStats* _latency_stats = nullptr;
   int _exec_rc = INT_MAX;
 
   std::vector<VertexContext*> _successor_ctxs;
   std::vector<int> _successor_dep_idxs;
+#if DIDAGLE_HAS_COROUTINES
+  // coroutine engine: posted by the last finished dependency & by the vertex itself once finished
+  folly::coro::Baton _ready_baton;
+  folly::coro::Baton _done_baton;
+#endif
 
   void SetupSuccessors();
+  void SetupDataVars(DataVarBindings& bindings);
+  // false if the vertex is skipped & already finished
+  bool PrepareExecute();
+  bool PrepareProcessor();
 
   friend class GraphContext;
 
@@ -60,11 +97,23 @@ class VertexContext {
   inline Vertex* GetVertex() { return _vertex; }
   const Params* GetExecParams(std::string_view* matched_cond);
   inline ProcessorDI* GetProcessorDI() { return _processor_di; }
+  inline VertexLatencyStats* GetLatencyStats() { return _latency_stats; }
+  inline const DAGEventRecord& GetTraceNames() const { return _trace_names; }
+  inline void SetReady(uint64_t ready_ustime, int32_t dispatch_queue_depth = -1) {
+    _ready_ustime = ready_ustime;
+    _dispatch_queue_depth = dispatch_queue_depth;
+  }
   inline Processor* GetProcessor() { return _processor; }
   inline VertexResult GetResult() { return _result; }
   void FinishVertexProcess(int code, bool adjust_code);
   int ExecuteProcessor();
   int ExecuteSubGraph();
+  void RecordReadyWait();
+  /**
+   * @brief finish an async processor on the executor selected by 'Vertex::resume_on', the hop is recorded
+   * as 'DAG_PHASE_OP_RESUME_HOP'.
+   */
+  void ResumeVertexProcess(int rc);
   inline uint32_t SetDependencyResult(int idx, VertexResult r) {
     VertexResult last_result_val = _deps_results[idx];
     _deps_results[idx] = r;
@@ -79,6 +128,14 @@ class VertexContext {
   void Reset();
   void ResetState();
   int Execute();
+#if DIDAGLE_HAS_COROUTINES
+  /**
+   * @brief coroutine engine: wait dependencies, run the vertex & wait it finished. processors are awaited
+   * directly, subgraphs are joined through '_done_baton'.
+   */
+  Awaitable<void> CoroExecute();
+  Awaitable<int> CoroExecuteProcessor();
+#endif
   ~VertexContext();
 };
 
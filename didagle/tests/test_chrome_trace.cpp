@@ -0,0 +1,150 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "didagle/trace/chrome_trace.h"
+using namespace didagle;
+
+static DAGEventRecord new_record(std::string_view vertex, uint64_t scope, uint32_t tid, uint64_t start, uint64_t end) {
+  DAGEventRecord record;
+  record.vertex = TraceNameTable::Intern(vertex);
+  record.scope = scope;
+  record.thread_id = tid;
+  record.start_ustime = start;
+  record.end_ustime = end;
+  record.rc = 0;
+  return record;
+}
+
+static std::string find_event(const std::string& json, std::string_view key) {
+  size_t pos = json.find(key);
+  if (pos == std::string::npos) {
+    return "";
+  }
+  size_t begin = json.rfind("{\"ph\"", pos);
+  size_t end = json.find("}}", pos);
+  return json.substr(begin, end - begin);
+}
+
+TEST(ChromeTrace, export) {
+  DAGEventTracker tracker;
+  // subgraph vertex 'sub' runs 'v1' inplace & dispatches 'v2' to thread 2, 'v3' of root graph runs on thread 3
+  DAGEventRecord sub = new_record("sub", 1, 1, 1000100, 1000200);
+  sub.child_scope = 2;
+  sub.cluster = TraceNameTable::Intern("sub.toml");
+  sub.full_graph_name = TraceNameTable::Intern("sub_graph");
+  tracker.Add(sub);
+  DAGEventRecord v1 = new_record("v1", 2, 1, 1000110, 1000150);
+  v1.processor = TraceNameTable::Intern("proc_\"v1\"");
+  tracker.Add(v1);
+  DAGEventRecord sched = new_record("v2", 2, 2, 1000150, 1000155);
+  sched.phase = PhaseType::DAG_PHASE_CONCURRENT_SCHED;
+  sched.dispatch_thread_id = 1;
+  tracker.Add(sched);
+  DAGEventRecord v2 = new_record("v2", 2, 2, 1000156, 1000190);
+  v2.processor = TraceNameTable::Intern("proc_v2");
+  tracker.Add(v2);
+  DAGEventRecord v3 = new_record("v3", 1, 3, 1000120, 1000180);
+  v3.processor = TraceNameTable::Intern("proc_v3");
+  tracker.Add(v3);
+  DAGEventRecord prepare = new_record("v3", 1, 3, 1000118, 1000120);
+  prepare.phase = PhaseType::DAG_PHASE_OP_PREPARE_EXECUTE;
+  tracker.Add(prepare);
+  DAGEventRecord ready = new_record("v2", 2, 2, 1000150, 1000156);
+  ready.phase = PhaseType::DAG_PHASE_VERTEX_READY_WAIT;
+  ready.queue_depth = 5;
+  tracker.Add(ready);
+  // skipped vertex without start time
+  tracker.Add(new_record("v4", 1, 3, 0, 1000190));
+
+  std::string json;
+  write_chrome_trace(tracker, json);
+  ASSERT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+  ASSERT_EQ(json.find("\"v4\""), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"thread-3\""), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"proc_\\\"v1\\\"\""), std::string::npos);
+
+  // timestamps are relative to the first record
+  std::string prepare_event = find_event(json, "\"name\":\"prepare_execute\"");
+  ASSERT_NE(prepare_event.find("\"pid\":1,\"tid\":3,\"ts\":18,\"dur\":2"), std::string::npos) << prepare_event;
+
+  // dispatch flow from thread 1 to thread 2
+  ASSERT_NE(json.find("{\"ph\":\"X\",\"name\":\"dispatch\",\"cat\":\"concurrency_sched\",\"pid\":1,\"tid\":1,\"ts\":50"),
+            std::string::npos);
+  ASSERT_NE(json.find("{\"ph\":\"s\",\"name\":\"dispatch\",\"cat\":\"dispatch\",\"pid\":1,\"tid\":1,\"ts\":50,\"id\":1}"),
+            std::string::npos);
+  ASSERT_NE(json.find("{\"ph\":\"f\",\"name\":\"dispatch\",\"cat\":\"dispatch\",\"pid\":1,\"tid\":2,\"ts\":55,\"id\":1}"),
+            std::string::npos);
+
+  // ready wait as async slice
+  ASSERT_NE(json.find("{\"ph\":\"b\",\"name\":\"v2\",\"cat\":\"ready_wait\",\"pid\":1,\"tid\":2,\"ts\":50,\"id\":1,"
+                      "\"args\":{\"queue_depth\":5}}"),
+            std::string::npos);
+  ASSERT_NE(json.find("{\"ph\":\"e\",\"name\":\"v2\",\"cat\":\"ready_wait\",\"pid\":1,\"tid\":2,\"ts\":56,\"id\":1}"),
+            std::string::npos);
+
+  // vertexs of subgraph are nested under the subgraph vertex on lane 0, 'v3' overlaps partially so goes to lane 1
+  std::string lane_prefix = "\"pid\":2,\"tid\":";
+  ASSERT_NE(json.find("\"name\":\"sub_graph\",\"cat\":\"unknown\"," + lane_prefix + "1"), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"proc_v2\",\"cat\":\"unknown\"," + lane_prefix + "1"), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"proc_v3\",\"cat\":\"unknown\"," + lane_prefix + "2"), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"lane-1\""), std::string::npos);
+  ASSERT_EQ(json.find("\"name\":\"lane-2\""), std::string::npos);
+
+  std::string file = testing::TempDir() + "/test_chrome_trace.json";
+  ASSERT_EQ(write_chrome_trace_file(tracker, file), 0);
+  FILE* fp = fopen(file.c_str(), "r");
+  ASSERT_TRUE(fp != nullptr);
+  std::string content(json.size(), '\0');
+  ASSERT_EQ(fread(&content[0], 1, content.size(), fp), json.size());
+  fclose(fp);
+  ASSERT_EQ(content, json);
+  ASSERT_EQ(write_chrome_trace_file(tracker, "/nonexistent_dir/trace.json"), -1);
+}
+
+TEST(ChromeTrace, subgraph_lanes) {
+  DAGEventTracker tracker;
+  // 'w' of root graph fits into the time of 'sub', it is still a sibling of 'sub' instead of nested under it
+  DAGEventRecord sub = new_record("lane_sub", 1, 1, 1000100, 1000200);
+  sub.child_scope = 2;
+  tracker.Add(sub);
+  tracker.Add(new_record("lane_a", 2, 1, 1000110, 1000150));
+  tracker.Add(new_record("lane_b", 2, 2, 1000120, 1000160));
+  tracker.Add(new_record("lane_w", 1, 3, 1000105, 1000115));
+  tracker.Add(new_record("lane_x", 1, 3, 1000210, 1000220));
+
+  std::string json;
+  write_chrome_trace(tracker, json);
+  // slices of the graph process follow the thread slices
+  std::string graph_json = json.substr(json.find("{\"name\":\"graph\"}"));
+  auto lane_of = [&](const std::string& vertex) {
+    std::string event = find_event(graph_json, "\"vertex\":\"" + vertex + "\"");
+    size_t pos = event.find("\"pid\":2,\"tid\":");
+    if (pos == std::string::npos) {
+      return -1;
+    }
+    return atoi(event.c_str() + pos + 14);
+  };
+  // 'sub' reserves lanes 1 & 2 for its overlapping subgraph vertexs
+  ASSERT_EQ(lane_of("lane_sub"), 1);
+  ASSERT_EQ(lane_of("lane_a"), 1);
+  ASSERT_EQ(lane_of("lane_b"), 2);
+  ASSERT_EQ(lane_of("lane_w"), 3);
+  ASSERT_EQ(lane_of("lane_x"), 1);
+  ASSERT_NE(json.find("\"name\":\"lane-2\""), std::string::npos);
+  ASSERT_EQ(json.find("\"name\":\"lane-3\""), std::string::npos);
+}
+
+TEST(ChromeTrace, empty) {
+  DAGEventTracker tracker;
+  std::string json;
+  write_chrome_trace(tracker, json);
+  ASSERT_EQ(json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+                  "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"threads\"}},"
+                  "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"graph\"}}]}\n");
+}
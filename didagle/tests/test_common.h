@@ -30,6 +30,7 @@
 */
 
 #pragma once
+#include <functional>
 #include <memory>
 #include "didagle/didagle.h"
 
@@ -42,7 +43,7 @@ struct TestContext {
   std::unique_ptr<folly::CPUThreadPoolExecutor> executor;
   // boost::asio::thread_pool pool;
   std::unique_ptr<GraphStore> store;
-  explicit TestContext(size_t n = 4) {
+  explicit TestContext(size_t n = 4, std::function<void(GraphExecuteOptions&)> init_opt = {}) {
     folly::SingletonVault::singleton()->registrationComplete();
     executor =
         std::make_unique<folly::CPUThreadPoolExecutor>(n, std::make_shared<folly::NamedThreadFactory>("didagle_test"));
@@ -52,6 +53,9 @@ struct TestContext {
       // boost::asio::post(pool, r);
     };
     exec_opt.latch_creator = new_folly_latch;
+    if (init_opt) {
+      init_opt(exec_opt);
+    }
     store = std::make_unique<GraphStore>(exec_opt);
   }
   ~TestContext() {
@@ -0,0 +1,184 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "folly/executors/CPUThreadPoolExecutor.h"
+#include "folly/futures/Future.h"
+#include "folly/system/ThreadName.h"
+
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+#if DIDAGLE_HAS_COROUTINES
+static folly::CPUThreadPoolExecutor* get_io_executor() {
+  static folly::CPUThreadPoolExecutor executor(2, std::make_shared<folly::NamedThreadFactory>("coro_io"));
+  return &executor;
+}
+static std::string g_sink_thread;
+
+GRAPH_OP_BEGIN(coro_src)
+GRAPH_OP_OUTPUT(int, coro_a)
+int OnExecute(const Params& args) override {
+  coro_a = 1;
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_FUTURE_OP_BEGIN(coro_future)
+GRAPH_OP_INPUT(int, coro_a)
+GRAPH_OP_OUTPUT(int, coro_b)
+folly::Future<int> OnFutureExecute(const Params& args) override {
+  return folly::via(get_io_executor(), [this]() {
+    coro_b = *coro_a + 1;
+    return 0;
+  });
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(coro_sub)
+GRAPH_OP_EXTERN_INPUT(int, coro_a)
+GRAPH_OP_OUTPUT(int, coro_d)
+int OnExecute(const Params& args) override {
+  coro_d = *coro_a + 2;
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(coro_sink)
+GRAPH_OP_INPUT(int, coro_b)
+GRAPH_OP_EXTERN_INPUT(int, coro_d)
+GRAPH_OP_OUTPUT(std::string, coro_c)
+int OnExecute(const Params& args) override {
+  coro_c = fmt::format("{}#{}", nullptr != coro_b ? *coro_b : -1, nullptr != coro_d ? *coro_d : -1);
+  g_sink_thread = folly::getCurrentThreadName().value_or("");
+  return 0;
+}
+GRAPH_OP_END
+
+static std::atomic<int> g_overlap_arrived{0};
+static std::atomic<int> g_overlap_met{0};
+// wait until the other start vertex arrived, never met if start vertexs run one after another
+static int wait_overlap() {
+  g_overlap_arrived.fetch_add(1);
+  for (int i = 0; i < 1000 && g_overlap_arrived.load() < 2; i++) {
+    usleep(1000);
+  }
+  if (g_overlap_arrived.load() >= 2) {
+    g_overlap_met.fetch_add(1);
+  }
+  return 0;
+}
+
+GRAPH_OP_BEGIN(coro_overlap0)
+int OnExecute(const Params& args) override { return wait_overlap(); }
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(coro_overlap1)
+int OnExecute(const Params& args) override { return wait_overlap(); }
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(coro_fail)
+int OnExecute(const Params& args) override { return -100; }
+GRAPH_OP_END
+
+TEST(CoroEngine, simple) {
+  std::string content = R"(
+name="test"
+[[graph]]
+name="main"
+[[graph.vertex]]
+id = "src"
+processor = "coro_src"
+[[graph.vertex]]
+id = "future"
+processor = "coro_future"
+[[graph.vertex]]
+id = "sub"
+cluster="."
+graph="sub"
+deps=["src"]
+[[graph.vertex]]
+id = "sink"
+processor = "coro_sink"
+deps=["sub"]
+
+[[graph]]
+name="sub"
+[[graph.vertex]]
+processor = "coro_sub"
+start=true
+  )";
+  folly::CPUThreadPoolExecutor coro_executor(2, std::make_shared<folly::NamedThreadFactory>("coro_engine"));
+  TestContext ctx(4, [&](GraphExecuteOptions& opts) { opts.coro_executor = folly::getKeepAliveToken(coro_executor); });
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 10; i++) {
+    g_sink_thread.clear();
+    auto data_ctx = GraphDataContext::New();
+    int rc = ctx.store->SyncExecute(data_ctx, "test", "main");
+    ASSERT_EQ(rc, 0);
+    auto coro_c = data_ctx->Get<std::string>("coro_c");
+    ASSERT_TRUE(coro_c != nullptr);
+    ASSERT_EQ(*coro_c, "2#3");
+    // resumed on the graph executor instead of the io thread fulfilling the future
+    ASSERT_EQ(g_sink_thread.rfind("coro_engine", 0), 0u);
+  }
+}
+
+TEST(CoroEngine, early_exit) {
+  std::string content = R"(
+name="test"
+[[graph]]
+name="main"
+[[graph.vertex]]
+id = "src"
+processor = "coro_src"
+[[graph.vertex]]
+id = "fail"
+processor = "coro_fail"
+deps=["src"]
+early_exit_graph_if_failed=true
+[[graph.vertex]]
+id = "future"
+processor = "coro_future"
+deps=["fail"]
+  )";
+  folly::CPUThreadPoolExecutor coro_executor(2, std::make_shared<folly::NamedThreadFactory>("coro_engine"));
+  TestContext ctx(4, [&](GraphExecuteOptions& opts) { opts.coro_executor = folly::getKeepAliveToken(coro_executor); });
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  auto data_ctx = GraphDataContext::New();
+  int rc = ctx.store->SyncExecute(data_ctx, "test", "main");
+  ASSERT_EQ(rc, -100);
+  ASSERT_TRUE(data_ctx->Get<int>("coro_b") == nullptr);
+}
+
+TEST(CoroEngine, concurrent_start_vertexs) {
+  std::string content = R"(
+name="test"
+[[graph]]
+name="main"
+[[graph.vertex]]
+id = "v0"
+processor = "coro_overlap0"
+[[graph.vertex]]
+id = "v1"
+processor = "coro_overlap1"
+  )";
+  folly::CPUThreadPoolExecutor coro_executor(4, std::make_shared<folly::NamedThreadFactory>("coro_engine"));
+  TestContext ctx(4, [&](GraphExecuteOptions& opts) { opts.coro_executor = folly::getKeepAliveToken(coro_executor); });
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  auto data_ctx = GraphDataContext::New();
+  ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test", "main"), 0);
+  // both sync start vertexs are running at the same time
+  ASSERT_EQ(g_overlap_met.load(), 2);
+}
+#endif
@@ -0,0 +1,170 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "didagle/processor/api.h"
+#include "didagle/store/critical_path.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(test_cp_fast)
+GRAPH_OP_OUTPUT(int64_t, cp_fast)
+int OnExecute(const Params& args) override {
+  cp_fast = 1;
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test_cp_slow)
+GRAPH_OP_OUTPUT(int64_t, cp_slow)
+int OnExecute(const Params& args) override {
+  usleep(20000);
+  cp_slow = 1;
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test_cp_join)
+GRAPH_OP_INPUT(int64_t, cp_fast)
+GRAPH_OP_INPUT(int64_t, cp_slow)
+int OnExecute(const Params& args) override { return 0; }
+GRAPH_OP_END
+
+static void add_vertex_records(DAGEventTracker& tracker, const std::string& id, uint64_t scope, uint64_t start,
+                               uint64_t exec_start, uint64_t exec_end) {
+  DAGEventRecord prepare;
+  prepare.vertex = TraceNameTable::Intern(id);
+  prepare.scope = scope;
+  prepare.phase = PhaseType::DAG_PHASE_OP_PREPARE_EXECUTE;
+  prepare.start_ustime = start;
+  prepare.end_ustime = exec_start;
+  tracker.Add(prepare);
+  DAGEventRecord exec;
+  exec.vertex = prepare.vertex;
+  exec.scope = scope;
+  exec.start_ustime = exec_start;
+  exec.end_ustime = exec_end;
+  exec.rc = 0;
+  tracker.Add(exec);
+}
+
+TEST(CriticalPath, analyze) {
+  // a -> b -> d, a -> c -> d
+  Graph graph;
+  graph.name = "cp";
+  std::vector<Vertex> vertexs(4);
+  const char* ids[] = {"cp_a", "cp_b", "cp_c", "cp_d"};
+  for (size_t i = 0; i < vertexs.size(); i++) {
+    vertexs[i].id = ids[i];
+    vertexs[i]._graph = &graph;
+    graph._nodes[ids[i]] = &vertexs[i];
+  }
+  vertexs[1]._deps_idx[&vertexs[0]] = 0;
+  vertexs[2]._deps_idx[&vertexs[0]] = 0;
+  vertexs[3]._deps_idx[&vertexs[1]] = 0;
+  vertexs[3]._deps_idx[&vertexs[2]] = 1;
+
+  DAGEventTracker tracker;
+  // another graph executed before with the same vertex ids
+  add_vertex_records(tracker, "cp_a", 99, 10, 11, 20);
+  DAGEventRecord graph_prepare;
+  graph_prepare.scope = 1;
+  graph_prepare.phase = PhaseType::DAG_GRAPH_GRAPH_PREPARE_EXECUTE;
+  graph_prepare.start_ustime = 1000;
+  graph_prepare.end_ustime = 1010;
+  tracker.Add(graph_prepare);
+  add_vertex_records(tracker, "cp_a", 1, 1010, 1012, 1100);
+  add_vertex_records(tracker, "cp_b", 1, 1105, 1110, 1400);
+  add_vertex_records(tracker, "cp_c", 1, 1120, 1125, 1200);
+  add_vertex_records(tracker, "cp_d", 1, 1410, 1420, 1500);
+
+  CriticalPathAnalysis analysis;
+  ASSERT_EQ(analyze_critical_path(graph, tracker, 0, analysis), 0);
+  ASSERT_EQ(analysis.start_ustime, 1000u);
+  ASSERT_EQ(analysis.end_ustime, 1500u);
+  ASSERT_EQ(analysis.vertexs.size(), 4u);
+  ASSERT_EQ(analysis.critical_path.size(), 3u);
+  ASSERT_EQ(analysis.vertexs[analysis.critical_path[0]].vertex, &vertexs[0]);
+  ASSERT_EQ(analysis.vertexs[analysis.critical_path[1]].vertex, &vertexs[1]);
+  ASSERT_EQ(analysis.vertexs[analysis.critical_path[2]].vertex, &vertexs[3]);
+  ASSERT_EQ(analysis.exec_us, 88u + 290u + 80u);
+  ASSERT_EQ(analysis.sched_us, 500u - analysis.exec_us);
+  for (const auto& v : analysis.vertexs) {
+    if (v.vertex == &vertexs[2]) {
+      ASSERT_FALSE(v.critical);
+      ASSERT_EQ(v.ready_ustime, 1100u);
+      // 'cp_c' could finish as late as 'cp_b'
+      ASSERT_EQ(v.slack_us, 200u);
+    } else {
+      ASSERT_EQ(v.slack_us, 0u);
+    }
+  }
+
+  ASSERT_EQ(analyze_critical_path(graph, tracker, 99, analysis), 0);
+  ASSERT_EQ(analysis.vertexs.size(), 1u);
+  ASSERT_EQ(analysis.start_ustime, 10u);
+  ASSERT_EQ(analyze_critical_path(graph, tracker, 2, analysis), -1);
+  DAGEventTracker empty;
+  ASSERT_EQ(analyze_critical_path(graph, empty, 0, analysis), -1);
+
+  CriticalPathStatsTable table;
+  table.graphs[&graph] = std::make_unique<GraphCriticalPathStats>();
+  for (auto& v : vertexs) {
+    table.vertexs[&v] = std::make_unique<VertexCriticalPathStats>();
+  }
+  ASSERT_EQ(analyze_critical_path(graph, tracker, 1, analysis), 0);
+  table.Add(graph, analysis);
+  table.Add(graph, analysis);
+  ASSERT_EQ(table.graphs[&graph]->samples.load(), 2u);
+  ASSERT_EQ(table.vertexs[&vertexs[1]]->critical_count.load(), 2u);
+  ASSERT_EQ(table.vertexs[&vertexs[2]]->critical_count.load(), 0u);
+  ASSERT_EQ(table.vertexs[&vertexs[2]]->slack_us.load(), 400u);
+}
+
+TEST(CriticalPath, report) {
+  std::string content = R"(
+name="test"
+[[graph]]
+name="test"
+[[graph.vertex]]
+processor = "test_cp_fast"
+[[graph.vertex]]
+processor = "test_cp_slow"
+[[graph.vertex]]
+processor = "test_cp_join"
+  )";
+  TestContext ctx(4, [](GraphExecuteOptions& opt) { opt.critical_path_stats = true; });
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 5; i++) {
+    auto data_ctx = GraphDataContext::New();
+    data_ctx->EnableEventTracker();
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test", "test"), 0);
+  }
+  // requests without event tracking are not analyzed
+  ASSERT_EQ(ctx.store->SyncExecute(GraphDataContext::New(), "test", "test"), 0);
+
+  // requests are analyzed in background after done
+  CriticalPathReport report;
+  for (int i = 0; i < 100; i++) {
+    report = CriticalPathReport();
+    ASSERT_EQ(ctx.store->GetCriticalPathReport("test", report), 0);
+    if (report.graphs.size() == 1 && report.graphs[0].samples >= 5) {
+      break;
+    }
+    usleep(10000);
+  }
+  ASSERT_EQ(report.graphs.size(), 1u);
+  ASSERT_EQ(report.graphs[0].samples, 5u);
+  ASSERT_GE(report.graphs[0].exec_us, 5u * 20000);
+  ASSERT_EQ(report.vertexs.size(), 3u);
+  ASSERT_EQ(report.vertexs[0].critical_count, 5u);
+  ASSERT_EQ(report.vertexs.back().vertex, "test_cp_fast");
+  ASSERT_EQ(report.vertexs.back().critical_count, 0u);
+  ASSERT_GT(report.vertexs.back().slack_us, 0u);
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(test0)
+GRAPH_OP_OUTPUT(std::string, test0)
+std::string dynamic_value;  // NOLINT
+int OnExecute(const Params& args) override {
+  test0 = "test0";
+  dynamic_value = "dynamic0";
+  GetDataContext().Set("dynamic0", &dynamic_value);
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test1)
+GRAPH_OP_OUTPUT(std::string, test1)
+std::string dynamic_value;  // NOLINT
+int OnExecute(const Params& args) override {
+  test1 = "test1";
+  dynamic_value = "dynamic1";
+  GetDataContext().Set("dynamic1", &dynamic_value);
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test2)
+GRAPH_OP_INPUT(std::string, test0)
+GRAPH_OP_INPUT(std::string, test1)
+GRAPH_OP_OUTPUT(std::string, test2)
+int OnExecute(const Params& args) override {
+  const std::string* v0 = GetDataContext().Get<std::string>("dynamic0");
+  const std::string* v1 = GetDataContext().Get<std::string>("dynamic1");
+  if (nullptr == v0 || nullptr == v1) {
+    return -1;
+  }
+  test2 = *v0 + "#" + *v1;
+  return 0;
+}
+GRAPH_OP_END
+
+TEST(DynamicData, publish_during_execution) {
+  std::string content = R"(
+name="test"
+[[graph]]
+name="test"
+[[graph.vertex]]
+processor = "test0"
+start = true
+[[graph.vertex]]
+processor = "test1"
+start = true
+[[graph.vertex]]
+processor = "test2"
+  )";
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 3; i++) {
+    auto data_ctx = GraphDataContext::New();
+    int rc = ctx.store->SyncExecute(data_ctx, "test", "test");
+    ASSERT_EQ(rc, 0);
+    auto test2 = data_ctx->Get<std::string>("test2");
+    ASSERT_TRUE(test2 != nullptr);
+    ASSERT_EQ(*test2, "dynamic0#dynamic1");
+    // dynamic data is visible from the caller's context as well
+    auto dynamic0 = data_ctx->Get<std::string>("dynamic0");
+    ASSERT_TRUE(dynamic0 != nullptr);
+    ASSERT_EQ(*dynamic0, "dynamic0");
+  }
+}
+
+TEST(DynamicData, stable_entries) {
+  auto data_ctx = GraphDataContext::New();
+  data_ctx->DisableEntryCreation();
+  std::string v0 = "v0";
+  ASSERT_TRUE(data_ctx->Set("stable", &v0));
+  const DataValue* entry = data_ctx->GetDataEntry<std::string>("stable");
+  ASSERT_TRUE(entry != nullptr);
+  ASSERT_EQ(entry->val.load(), &v0);
+
+  // entries survive the reset with empty values, pointers taken before stay valid
+  data_ctx->Reset();
+  ASSERT_TRUE(entry->val.load() == nullptr);
+  ASSERT_TRUE(data_ctx->Get<std::string>("stable") == nullptr);
+
+  data_ctx->DisableEntryCreation();
+  std::string v1 = "v1";
+  ASSERT_TRUE(data_ctx->Set("stable", &v1));
+  ASSERT_EQ(data_ctx->GetDataEntry<std::string>("stable"), entry);
+  ASSERT_EQ(*data_ctx->Get<std::string>("stable"), "v1");
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "didagle/trace/event.h"
+using namespace didagle;
+
+TEST(DAGEventTracker, records) {
+  uint32_t proc_id = TraceNameTable::Intern("test_proc");
+  ASSERT_EQ(proc_id, TraceNameTable::Intern("test_proc"));
+  ASSERT_EQ(TraceNameTable::Get(proc_id), "test_proc");
+  ASSERT_EQ(TraceNameTable::Intern(""), 0u);
+  ASSERT_TRUE(TraceNameTable::Get(0).empty());
+
+  constexpr int kThreads = 4;
+  constexpr int kEventsPerThread = 1000;
+  DAGEventTracker tracker;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&tracker, proc_id, t]() {
+      for (int i = 0; i < kEventsPerThread; i++) {
+        DAGEventRecord record;
+        record.processor = proc_id;
+        record.start_ustime = t * kEventsPerThread + i;
+        record.end_ustime = record.start_ustime + 1;
+        record.rc = 0;
+        tracker.Add(record);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::set<uint64_t> starts;
+  tracker.Visit([&](const DAGEvent& event) {
+    ASSERT_EQ(event.processor, "test_proc");
+    ASSERT_EQ(event.end_ustime, event.start_ustime + 1);
+    starts.insert(event.start_ustime);
+  });
+  ASSERT_EQ(starts.size(), static_cast<size_t>(kThreads * kEventsPerThread));
+
+  // legacy heap events & records are both swept
+  auto legacy = std::make_unique<DAGEvent>();
+  legacy->phase = PhaseType::DAG_PHASE_OP_POST_EXECUTE;
+  tracker.Add(std::move(legacy));
+  size_t swept = 0;
+  DAGEvent* kept = nullptr;
+  tracker.Sweep([&](DAGEvent* event) -> EventReportStatus {
+    swept++;
+    if (nullptr == kept) {
+      kept = event;
+      return STATUS_KEEP;
+    }
+    return STATUS_NORMAL;
+  });
+  ASSERT_EQ(swept, static_cast<size_t>(kThreads * kEventsPerThread + 1));
+  ASSERT_TRUE(kept != nullptr);
+  delete kept;
+  swept = 0;
+  tracker.Sweep([&](DAGEvent* event) -> EventReportStatus {
+    swept++;
+    return STATUS_NORMAL;
+  });
+  ASSERT_EQ(swept, 0u);
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "didagle/graph/params.h"
+#include "didagle/processor/api.h"
+#include "didagle/processor/impl/expr_program.h"
+#include "didagle/processor/processor.h"
+using namespace didagle;
+
+static ExprValue ToExprValue(const Params& p) {
+  if (p.IsInt()) {
+    return ExprValue::Int(p.Int());
+  } else if (p.IsDouble()) {
+    return ExprValue::Double(p.Double());
+  } else if (p.IsBool()) {
+    return ExprValue::Bool(p.Bool());
+  } else if (p.IsString()) {
+    return ExprValue::String(std::string_view(p.String().data(), p.String().size()));
+  } else if (p.Valid()) {
+    return ExprValue::Object(&p);
+  }
+  return ExprValue::Bool(false);
+}
+
+// returns 1/0 for bool result, -1 for eval error, -2 for compile error
+static int Eval(const std::string& expr, const Params& root, size_t* codes = nullptr) {
+  ExprProgram program;
+  if (0 != program.Compile(expr)) {
+    return -2;
+  }
+  if (nullptr != codes) {
+    *codes = program.Size();
+  }
+  ExprValue v = program.Eval([&](size_t idx) {
+    const Params* p = &root;
+    for (const auto& key : program.GetVars()[idx].keys) {
+      p = &((*p)[key]);
+    }
+    return ToExprValue(*p);
+  });
+  if (v.type != ExprValue::EXPR_BOOL) {
+    return -1;
+  }
+  return v.bv ? 1 : 0;
+}
+
+TEST(ExprProgram, eval) {
+  Params root;
+  root["exp"]["id"].SetInt(1000);
+  root["exp"]["name"].SetString("abc");
+  root["arr"].Add().SetInt(3);
+  root["arr"].Add().SetInt(5);
+  root["d"].SetDouble(2.5);
+
+  EXPECT_EQ(Eval("$exp.id==1000", root), 1);
+  EXPECT_EQ(Eval("$exp.id == 1001", root), 0);
+  EXPECT_EQ(Eval("$exp.id >= 999 && $exp.name == 'abc'", root), 1);
+  EXPECT_EQ(Eval("!($exp.id == 1000) || $d > 2", root), 1);
+  EXPECT_EQ(Eval("-$d < -2.4", root), 1);
+  EXPECT_EQ(Eval("$exp.id % 7 == 6", root), 1);
+  EXPECT_EQ(Eval("has_param($exp, \"id\")", root), 1);
+  EXPECT_EQ(Eval("has_param($exp, \"xyz\")", root), 0);
+  EXPECT_EQ(Eval("has_value($arr, 5)", root), 1);
+  EXPECT_EQ(Eval("has_value($arr, 4)", root), 0);
+  // type mismatch & division by zero are errors
+  EXPECT_EQ(Eval("$missing == 1", root), -1);
+  EXPECT_EQ(Eval("$exp.id / 0 == 1", root), -1);
+}
+
+TEST(ExprProgram, constant_folding) {
+  Params root;
+  size_t codes = 0;
+  EXPECT_EQ(Eval("1 + 2 * 3 == 7", root, &codes), 1);
+  EXPECT_EQ(codes, 1);
+  EXPECT_EQ(Eval("(1 + 2) * 3 == 9 && true", root, &codes), 1);
+  EXPECT_EQ(codes, 1);
+  EXPECT_EQ(Eval("false && $x == 1", root, &codes), 0);
+  EXPECT_EQ(codes, 1);
+}
+
+TEST(ExprProgram, unsupported) {
+  Params root;
+  EXPECT_EQ(Eval("foo($x)", root), -2);
+  EXPECT_EQ(Eval("$a.", root), -2);
+  EXPECT_EQ(Eval("$a ==", root), -2);
+  EXPECT_EQ(Eval("$a = 1", root), -2);
+}
+
+TEST(ExprProcessor, cached_vars) {
+  std::unique_ptr<Processor> p(ProcessorFactory::GetProcessor("didagle_expr"));
+  ASSERT_TRUE(p != nullptr);
+  Params cond;
+  cond.SetString("$flag && $n > 1");
+  ASSERT_EQ(p->Setup(cond), 0);
+  auto data_ctx = GraphDataContext::New();
+  p->SetDataContext(data_ctx.get());
+  Params args;
+  args["flag"].SetBool(true);
+  args["n"].SetInt(2);
+  ASSERT_EQ(p->Execute(args), 0);
+  ASSERT_EQ(p->Execute(args), 0);
+  // single name vars resolve to data once it is published
+  bool flag = false;
+  data_ctx->Set("flag", &flag);
+  ASSERT_EQ(p->Execute(args), -1);
+  // replaced data is read instead of the cached value
+  bool new_flag = true;
+  data_ctx->Set("flag", &new_flag);
+  ASSERT_EQ(p->Execute(args), 0);
+  // moved data falls back to params
+  ASSERT_TRUE(data_ctx->Move<bool>("flag") != nullptr);
+  args["flag"].SetBool(false);
+  ASSERT_EQ(p->Execute(args), -1);
+  // data published into the dynamic table while executing
+  data_ctx->DisableEntryCreation();
+  int64_t n = 0;
+  args["flag"].SetBool(true);
+  ASSERT_EQ(p->Execute(args), 0);
+  data_ctx->Set("n", &n);
+  ASSERT_EQ(p->Execute(args), -1);
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "didagle/processor/api.h"
+#include "didagle/store/flight_recorder.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(test_flight_ok)
+int OnExecute(const Params& args) override { return 0; }
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test_flight_slow)
+int OnExecute(const Params& args) override {
+  usleep(20000);
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test_flight_fail)
+int OnExecute(const Params& args) override { return -3; }
+GRAPH_OP_END
+
+static FlightRecordPtr new_flight_record(const std::string& graph, int rc) {
+  auto record = std::make_shared<FlightRecord>();
+  record->cluster = "cluster";
+  record->graph = graph;
+  record->start_ustime = 100;
+  record->end_ustime = 300;
+  record->rc = rc;
+  DAGEventRecord event;
+  event.vertex = TraceNameTable::Intern("flight_vertex");
+  event.matched_cond = TraceNameTable::Intern("$flag==1");
+  event.start_ustime = 110;
+  event.end_ustime = 290;
+  event.rc = rc;
+  event.code = rc;
+  record->records.emplace_back(event);
+  return record;
+}
+
+static std::string read_file(const std::string& file) {
+  std::string content;
+  FILE* fp = fopen(file.c_str(), "r");
+  if (nullptr == fp) {
+    return content;
+  }
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    content.append(buf, n);
+  }
+  fclose(fp);
+  return content;
+}
+
+TEST(FlightRecorder, bounded) {
+  FlightRecorder recorder(2);
+  for (int i = 1; i <= 3; i++) {
+    recorder.Add(new_flight_record("g0", i));
+  }
+  recorder.Add(new_flight_record("g1", -1));
+  std::vector<FlightRecordPtr> records;
+  recorder.Get("cluster", "g0", records);
+  ASSERT_EQ(records.size(), 2u);
+  ASSERT_EQ(records[0]->rc, 2);
+  ASSERT_EQ(records[1]->rc, 3);
+  records.clear();
+  recorder.Get("", "", records);
+  ASSERT_EQ(records.size(), 3u);
+  records.clear();
+  recorder.Get("other", "", records);
+  ASSERT_TRUE(records.empty());
+
+  std::string json;
+  recorder.Dump(json);
+  ASSERT_EQ(json.find("{\"requests\":[{"), 0u);
+  ASSERT_NE(json.find("\"graph\":\"g1\""), std::string::npos);
+  ASSERT_NE(json.find("\"latency_us\":200"), std::string::npos);
+  ASSERT_NE(json.find("\"vertex\":\"flight_vertex\""), std::string::npos);
+  ASSERT_NE(json.find("\"matched_cond\":\"$flag==1\""), std::string::npos);
+  ASSERT_NE(json.find("\"rc\":-1,\"code\":-1"), std::string::npos);
+
+  std::string file = testing::TempDir() + "/test_flight_recorder.json";
+  unlink(file.c_str());
+  ASSERT_EQ(recorder.DumpOnSignal(SIGUSR2, file), 0);
+  FlightRecorder other(1);
+  ASSERT_EQ(other.DumpOnSignal(SIGUSR2, file), -1);
+  raise(SIGUSR2);
+  std::string content;
+  for (int i = 0; i < 100 && content.size() < json.size(); i++) {
+    usleep(10000);
+    content = read_file(file);
+  }
+  ASSERT_EQ(content, json);
+}
+
+TEST(FlightRecorder, store) {
+  std::string content = R"(
+name="flight"
+[[graph]]
+name="ok"
+[[graph.vertex]]
+processor = "test_flight_ok"
+[[graph]]
+name="slow"
+[[graph.vertex]]
+processor = "test_flight_slow"
+[[graph]]
+name="fail"
+[[graph.vertex]]
+processor = "test_flight_fail"
+early_exit_graph_if_failed = true
+  )";
+  TestContext ctx(4, [](GraphExecuteOptions& opt) {
+    opt.flight_recorder_size = 2;
+    opt.flight_recorder_slow_ms = 10;
+  });
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 3; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "flight", "ok"), 0);
+    // events tracked for flight recorder are not exposed
+    ASSERT_TRUE(data_ctx->GetEventTracker() == nullptr);
+    ASSERT_EQ(ctx.store->SyncExecute(GraphDataContext::New(), "flight", "slow"), 0);
+  }
+  ASSERT_NE(ctx.store->SyncExecute(GraphDataContext::New(), "flight", "fail"), 0);
+
+  FlightRecorder* recorder = ctx.store->GetFlightRecorder();
+  ASSERT_TRUE(recorder != nullptr);
+  std::vector<FlightRecordPtr> records;
+  recorder->Get("flight", "ok", records);
+  ASSERT_TRUE(records.empty());
+  recorder->Get("flight", "slow", records);
+  ASSERT_EQ(records.size(), 2u);
+  ASSERT_GE(records[0]->end_ustime - records[0]->start_ustime, 10000u);
+  records.clear();
+  recorder->Get("flight", "fail", records);
+  ASSERT_EQ(records.size(), 1u);
+  ASSERT_NE(records[0]->rc, 0);
+  bool found = false;
+  for (const DAGEventRecord& event : records[0]->records) {
+    if (PhaseType::DAG_PHASE_UNKNOWN == event.phase && 0 != event.processor) {
+      ASSERT_EQ(TraceNameTable::Get(event.processor), "test_flight_fail");
+      ASSERT_EQ(event.rc, -3);
+      found = true;
+    }
+  }
+  ASSERT_TRUE(found);
+}
@@ -4,6 +4,7 @@
 #include <benchmark/benchmark.h>
 #include <fmt/core.h>
 #include <stdint.h>
+#include <memory>
 #include <string>
 #include "didagle/processor/api.h"
 #include "didagle/tests/test_common.h"
@@ -101,5 +102,55 @@ processor = "test4"
 }
 // Register the function as a benchmark
 BENCHMARK(BM_test_graph_run);
+
+GRAPH_OP_BEGIN(bench_noop)
+int OnExecute(const Params& args) override { return 0; }
+GRAPH_OP_END
+
+// synthetic layered graph, each vertex depends on its predecessor & a vertex in the previous half
+static std::string gen_large_graph_dsl(int64_t n) {
+  std::string content = R"(
+name = "large"
+strict_dsl = true
+default_context_pool_size = 1
+
+[[graph]]
+name = "large"
+[[graph.vertex]]
+id = "v0"
+processor = "bench_noop"
+start = true
+)";
+  for (int64_t i = 1; i < n; i++) {
+    content.append(fmt::format("[[graph.vertex]]\nid = \"v{}\"\nprocessor = \"bench_noop\"\n", i));
+    if (i > 1) {
+      content.append(fmt::format("deps = [\"v{}\", \"v{}\"]\n", i - 1, i / 2));
+    } else {
+      content.append("deps = [\"v0\"]\n");
+    }
+  }
+  return content;
+}
+
+static void BM_test_graph_load(benchmark::State& state) {
+  std::string content = gen_large_graph_dsl(state.range(0));
+  for (auto _ : state) {
+    // a fresh store for every iteration, reloading unchanged content into the same store is skipped
+    state.PauseTiming();
+    auto ctx = std::make_unique<TestContext>();
+    state.ResumeTiming();
+    auto handle = ctx->store->LoadString(content);
+    if (!handle) {
+      state.SkipWithError("failed to load graph");
+      break;
+    }
+    state.PauseTiming();
+    handle.reset();
+    ctx.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_test_graph_load)->Arg(1000)->Arg(10000)->Arg(50000)->Unit(benchmark::kMillisecond);
 // Run the benchmark
 BENCHMARK_MAIN();
\ No newline at end of file
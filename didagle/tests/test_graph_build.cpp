@@ -0,0 +1,110 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "didagle/graph/graph.h"
+using namespace didagle;
+
+static void add_vertex(Graph& g, const std::string& id, const std::set<std::string>& deps) {
+  Vertex v;
+  v.id = id;
+  v.processor = "not_exist_processor";
+  v.deps = deps;
+  g.vertex.emplace_back(std::move(v));
+}
+
+static std::vector<std::string> get_ids(const std::vector<Vertex*>& vertexs) {
+  std::vector<std::string> ids;
+  for (Vertex* v : vertexs) {
+    ids.emplace_back(v->id);
+  }
+  return ids;
+}
+
+TEST(GraphBuild, topo_order) {
+  GraphCluster cluster;
+  cluster.strict_dsl = false;
+  Graph& g = cluster.graph.emplace_back();
+  g.name = "test";
+  g._cluster = &cluster;
+  add_vertex(g, "a", {});
+  add_vertex(g, "b", {"a"});
+  add_vertex(g, "c", {"a"});
+  add_vertex(g, "d", {"b", "c"});
+  ASSERT_EQ(0, g.Build());
+  std::vector<std::string> order = get_ids(g._topo_order);
+  ASSERT_EQ(order.size(), 4u);
+  ASSERT_EQ(order.front(), "a");
+  ASSERT_EQ(order.back(), "d");
+}
+
+TEST(GraphBuild, circle) {
+  GraphCluster cluster;
+  cluster.strict_dsl = false;
+  Graph& g = cluster.graph.emplace_back();
+  g.name = "test";
+  g._cluster = &cluster;
+  add_vertex(g, "a", {});
+  add_vertex(g, "b", {"a", "d"});
+  add_vertex(g, "c", {"b"});
+  add_vertex(g, "d", {"c"});
+  add_vertex(g, "e", {"d"});
+  ASSERT_NE(0, g.Build());
+
+  std::vector<Vertex*> order;
+  std::vector<Vertex*> circle;
+  ASSERT_EQ(-1, g.TopologicalSort(order, circle));
+  ASSERT_EQ(get_ids(order), std::vector<std::string>{"a"});
+  std::vector<std::string> circle_ids = get_ids(circle);
+  ASSERT_EQ(circle_ids.size(), 3u);
+  // rotate to start from 'b'
+  while (circle_ids[0] != "b") {
+    std::rotate(circle_ids.begin(), circle_ids.begin() + 1, circle_ids.end());
+  }
+  ASSERT_EQ(circle_ids, (std::vector<std::string>{"b", "c", "d"}));
+}
+
+TEST(GraphBuild, self_circle) {
+  GraphCluster cluster;
+  cluster.strict_dsl = false;
+  Graph& g = cluster.graph.emplace_back();
+  g.name = "test";
+  g._cluster = &cluster;
+  add_vertex(g, "a", {"a"});
+  ASSERT_NE(0, g.Build());
+  std::vector<Vertex*> order;
+  std::vector<Vertex*> circle;
+  ASSERT_EQ(-1, g.TopologicalSort(order, circle));
+  ASSERT_EQ(get_ids(circle), std::vector<std::string>{"a"});
+}
+
+TEST(GraphBuild, resume_on) {
+  GraphCluster cluster;
+  cluster.strict_dsl = false;
+  Graph& g = cluster.graph.emplace_back();
+  g.name = "test";
+  g._cluster = &cluster;
+  g.resume_on = "graph";
+  add_vertex(g, "a", {});
+  add_vertex(g, "b", {"a"});
+  g.vertex.back().resume_on = "cpu";
+  ASSERT_EQ(0, g.Build());
+  ASSERT_EQ(g.FindVertexById("a")->_resume_on, V_RESUME_GRAPH);
+  ASSERT_EQ(g.FindVertexById("b")->_resume_on, V_RESUME_CPU);
+}
+
+TEST(GraphBuild, invalid_resume_on) {
+  GraphCluster cluster;
+  cluster.strict_dsl = false;
+  Graph& g = cluster.graph.emplace_back();
+  g.name = "test";
+  g._cluster = &cluster;
+  add_vertex(g, "a", {});
+  g.vertex.back().resume_on = "io";
+  ASSERT_NE(0, g.Build());
+}
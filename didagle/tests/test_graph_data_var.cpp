@@ -0,0 +1,106 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string>
+
+#include "didagle/graph/params.h"
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(test_producer)
+GRAPH_OP_OUTPUT(std::string, produce)
+GRAPH_PARAMS_string(value, "default", "e");
+int OnExecute(const Params& args) override {
+  produce = PARAMS_value.toStdString();
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test_consumer)
+GRAPH_OP_INPUT(std::string, consume)
+GRAPH_OP_OUTPUT(std::string, consume_result)
+int OnExecute(const Params& args) override {
+  if (nullptr == consume) {
+    return -1;
+  }
+  consume_result = *consume + "_consumed";
+  return 0;
+}
+GRAPH_OP_END
+
+TEST(DataVar, bind) {
+  std::string content = R"(
+name="test"
+[[graph]]
+name="test"
+[[graph.vertex]]
+processor = "test_producer"
+output = [{ field = "produce", id = "$vars.data" }]
+args = { value = "shared" }
+start = true
+[[graph.vertex]]
+processor = "test_consumer"
+input = [{ field = "consume", id = "$vars.data" }]
+[[graph.vertex]]
+processor = "test_producer"
+id = "local_producer"
+output = [{ field = "produce", id = "$vars.data2" }]
+args = { value = "local", vars = { data2 = "local_data" } }
+start = true
+  )";
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 4; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ParamsPtr params = Params::New();
+    std::string data_name = "data_" + std::to_string(i % 2);
+    (*params)["vars"]["data"].SetString(data_name);
+    (*params)["vars"]["data2"].SetString("ignored");
+    int rc = ctx.store->SyncExecute(data_ctx, "test", "test", params);
+    ASSERT_EQ(rc, 0);
+    // data name resolved with execute params
+    auto produce = data_ctx->Get<std::string>(data_name);
+    ASSERT_TRUE(produce != nullptr);
+    ASSERT_EQ(*produce, "shared");
+    auto consume_result = data_ctx->Get<std::string>("consume_result");
+    ASSERT_TRUE(consume_result != nullptr);
+    ASSERT_EQ(*consume_result, "shared_consumed");
+    // data name resolved with vertex args
+    auto local_produce = data_ctx->Get<std::string>("local_data");
+    ASSERT_TRUE(local_produce != nullptr);
+    ASSERT_EQ(*local_produce, "local");
+  }
+}
+
+TEST(DataVar, equal_params) {
+  std::string content = R"(
+name="test_equal"
+[[graph]]
+name="test"
+[[graph.vertex]]
+processor = "test_producer"
+output = [{ field = "produce", id = "$vars.data" }]
+start = true
+[[graph.vertex]]
+processor = "test_consumer"
+input = [{ field = "consume", id = "$vars.data" }]
+  )";
+  TestContext ctx(1);
+  ASSERT_TRUE(ctx.store->LoadString(content) != nullptr);
+  for (int i = 0; i < 4; i++) {
+    // params of equal content but released after every request, bindings must not refer to the released one
+    auto data_ctx = GraphDataContext::New();
+    ParamsPtr params = Params::New();
+    (*params)["vars"]["data"].SetString("eq");
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test_equal", "test", params), 0);
+    params.reset();
+    auto consume_result = data_ctx->Get<std::string>("consume_result");
+    ASSERT_TRUE(consume_result != nullptr);
+    ASSERT_EQ(*consume_result, "default_consumed");
+    ASSERT_TRUE(data_ctx->Get<std::string>("eq") != nullptr);
+  }
+}
@@ -4,6 +4,7 @@
 #include <fmt/core.h>
 #include <gtest/gtest.h>
 #include <stdint.h>
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -106,6 +107,150 @@ processor = "test3"
   data_ctx->Reset();
 }
 
+GRAPH_OP_BEGIN(test_fail_setup)
+int OnSetup(const Params& args) override { return -1; }
+int OnExecute(const Params& args) override { return 0; }
+GRAPH_OP_END
+
+TEST(ExpectConfig, setup_failed) {
+  std::string content = R"(
+name="test_setup_failed"
+strict_dsl=false
+[[config_setting]]
+name = "fail"
+processor = "test_fail_setup"
+cond = "$exp.id==1000"
+[[graph]]
+name="test"
+[[graph.vertex]]
+expect_config="fail"
+processor = "test0"
+  )";
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 2; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test_setup_failed", "test"), -1);
+    ASSERT_TRUE(data_ctx->Get<std::string>("test0") == nullptr);
+  }
+}
+
+static std::atomic<int> g_count_cond_evals{0};
+GRAPH_OP_BEGIN(test_count_cond)
+std::string _cond;  // NOLINT
+int OnSetup(const Params& args) override {
+  _cond = args.String().toStdString();
+  return 0;
+}
+int OnExecute(const Params& args) override {
+  g_count_cond_evals.fetch_add(1);
+  return args[_cond].Bool() ? 0 : -1;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test_sub)
+GRAPH_OP_OUTPUT(std::string, test_sub)
+int OnExecute(const Params& args) override {
+  test_sub = "test_sub";
+  return 0;
+}
+GRAPH_OP_END
+
+TEST(ExpectConfig, lazy) {
+  std::string content = R"(
+name="test"
+default_expr_processor="test_count_cond"
+lazy_config_setting=true
+[[config_setting]]
+name = "cfg_a"
+cond = "flag_a"
+[[config_setting]]
+name = "cfg_b"
+cond = "flag_b"
+[[config_setting]]
+name = "cfg_c"
+cond = "flag_c"
+[[graph]]
+name="test"
+[[graph.vertex]]
+id = "test0"
+processor = "test0"
+expect_config="cfg_a"
+start=true
+[[graph.vertex]]
+id = "sub0"
+cluster="."
+graph="sub"
+deps=["test0"]
+[[graph.vertex]]
+id = "sub1"
+cluster="."
+graph="sub"
+deps=["sub0"]
+
+[[graph]]
+name="sub"
+[[graph.vertex]]
+processor = "test_sub"
+expect_config="cfg_a"
+start=true
+  )";
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 4; i++) {
+    bool flag = (i % 2 == 0);
+    auto data_ctx = GraphDataContext::New();
+    ParamsPtr params = Params::New();
+    (*params)["flag_a"].SetBool(flag);
+    int before = g_count_cond_evals.load();
+    int rc = ctx.store->SyncExecute(data_ctx, "test", "test", params);
+    ASSERT_EQ(rc, 0);
+    // only 'cfg_a' is referenced, evaluated once & shared with subgraphs
+    ASSERT_EQ(g_count_cond_evals.load() - before, 1);
+    auto test0 = data_ctx->Get<std::string>("test0");
+    ASSERT_EQ(test0 != nullptr, flag);
+    auto test_sub = data_ctx->Get<std::string>("test_sub");
+    ASSERT_EQ(test_sub != nullptr, flag);
+  }
+}
+
+TEST(ExpectConfig, lazy_referenced_by_expr) {
+  std::string content = R"(
+name="test_lazy_expr"
+default_expr_processor="didagle_expr"
+lazy_config_setting=true
+[[config_setting]]
+name = "with_exp_1000"
+cond = "$exp.id==1000"
+[[config_setting]]
+name = "with_exp_1"
+cond = "$exp.id==1"
+[[graph]]
+name="test"
+[[graph.vertex]]
+id = "check"
+cond = "$with_exp_1000 && $exp.id > 0"
+if = ["test0"]
+[[graph.vertex]]
+processor = "test0"
+  )";
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  // read as '$with_exp_1000' from graph data, so it is evaluated at graph start
+  ASSERT_FALSE(handle->cluster.config_setting[0]._lazy);
+  ASSERT_TRUE(handle->cluster.config_setting[1]._lazy);
+  for (int64_t id : {1000, 1001}) {
+    auto data_ctx = GraphDataContext::New();
+    ParamsPtr params = Params::New();
+    (*params)["exp"]["id"].SetInt(id);
+    ASSERT_EQ(0, ctx.store->SyncExecute(data_ctx, "test_lazy_expr", "test", params));
+    ASSERT_EQ(data_ctx->Get<std::string>("test0") != nullptr, id == 1000);
+  }
+}
+
 // TEST(ExpectConfig, expect_cond) {
 //   std::string content = R"(
 // name="test"
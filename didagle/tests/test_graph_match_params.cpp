@@ -103,3 +103,41 @@ args = { abc = "default", xyz = "zzz" }
   ASSERT_TRUE(test3_1 != nullptr);
   ASSERT_EQ(*test3_1, "bbb");
 }
+
+TEST(ExpectConfig, inherit_default) {
+  std::string content = R"(
+name="test"
+default_expr_processor="didagle_expr"
+[[graph]]
+name="test"
+[[graph.vertex]]
+processor = "test0"
+[[graph.vertex]]
+processor = "test2"
+[[graph.vertex]]
+processor = "test3"
+select_args = [
+    { match = "$exp.id==1000", args = { abc = "hello1" }, inherit_default = true },
+]
+args = { xyz = "zzz" }
+  )";
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+
+  for (int64_t id : {1000, 1001, 1000}) {
+    auto data_ctx = GraphDataContext::New();
+    ParamsPtr paras = Params::New();
+    (*paras)["exp"]["id"].SetInt(id);
+    (*paras)["abc"].SetString("from_exec");
+    int rc = ctx.store->SyncExecute(data_ctx, "test", "test", paras);
+    ASSERT_EQ(rc, 0);
+    auto test3_0 = data_ctx->Get<std::string>("test3_0");
+    ASSERT_TRUE(test3_0 != nullptr);
+    // select args > vertex args > execute params
+    ASSERT_EQ(*test3_0, id == 1000 ? "hello1" : "from_exec");
+    auto test3_1 = data_ctx->Get<std::string>("test3_1");
+    ASSERT_TRUE(test3_1 != nullptr);
+    ASSERT_EQ(*test3_1, "zzz");
+  }
+}
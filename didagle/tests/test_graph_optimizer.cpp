@@ -0,0 +1,343 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+
+#include "didagle/graph/graph.h"
+using namespace didagle;
+
+static Graph& init_test_graph(GraphCluster& cluster, bool optimize = true) {
+  cluster.strict_dsl = false;
+  cluster.default_expr_processor = "expr";
+  ConfigSetting cfg;
+  cfg.name = "with_a";
+  cfg.cond = "$a==1";
+  cluster.config_setting.emplace_back(cfg);
+  Graph& g = cluster.graph.emplace_back();
+  g.name = "main";
+  g.optimize = optimize;
+  return g;
+}
+
+static Vertex& add_vertex(Graph& g, const std::string& id, const std::set<std::string>& deps,
+                          bool side_effect = false) {
+  Vertex& v = g.vertex.emplace_back();
+  v.id = id;
+  v.processor = "not_exist_processor";
+  v.deps = deps;
+  v.side_effect = side_effect;
+  return v;
+}
+
+TEST(GraphOptimizer, config_fold) {
+  GraphCluster cluster;
+  Graph& g = init_test_graph(cluster);
+  add_vertex(g, "a", {});
+  add_vertex(g, "b", {"a"}).expect = "$with_a";
+  add_vertex(g, "c", {"a"}).expect = " ! $with_a";
+  add_vertex(g, "d", {"b", "c"}, true);
+  ASSERT_EQ(0, cluster.Build());
+  ASSERT_EQ(g._nodes.size(), 4u);
+  ASSERT_EQ(g._topo_order.size(), 4u);
+
+  Vertex* b = g.FindVertexById("b");
+  ASSERT_TRUE(b != nullptr);
+  ASSERT_EQ(b->expect_config, "with_a");
+  ASSERT_EQ(b->_deps_idx.size(), 1u);
+  ASSERT_EQ(b->GetDependencyIndex(g.FindVertexById("a")), 0);
+  ASSERT_EQ(g.FindVertexById("c")->expect_config, "!with_a");
+  ASSERT_EQ(g.FindVertexById("a")->_successor_vertex.size(), 2u);
+}
+
+TEST(GraphOptimizer, config_fold_skip_data_cond) {
+  GraphCluster cluster;
+  Graph& g = init_test_graph(cluster);
+  add_vertex(g, "a", {});
+  // '$with_a > 1' is not a plain config setting reference
+  add_vertex(g, "b", {"a"}, true).expect = "$with_a > 1";
+  ASSERT_EQ(0, cluster.Build());
+  ASSERT_EQ(g._nodes.size(), 3u);
+  ASSERT_TRUE(g.FindVertexById("b")->expect_config.empty());
+}
+
+TEST(GraphOptimizer, config_fold_skip_expect_config) {
+  GraphCluster cluster;
+  Graph& g = init_test_graph(cluster);
+  ConfigSetting cfg;
+  cfg.name = "with_b";
+  cfg.cond = "$b==1";
+  cluster.config_setting.emplace_back(cfg);
+  add_vertex(g, "a", {});
+  Vertex& c = add_vertex(g, "c", {"a"});
+  c.processor = "expr";
+  c.cond = "$with_a";
+  c.expect_config = "with_b";
+  add_vertex(g, "d", {"a"}, true).deps_on_ok = {"c"};
+  ASSERT_EQ(0, cluster.Build());
+  ASSERT_EQ(g._nodes.size(), 3u);
+  Vertex* d = g.FindVertexById("d");
+  ASSERT_TRUE(d->expect_config.empty());
+  ASSERT_EQ(d->_deps_expected_results[d->GetDependencyIndex(g.FindVertexById("c"))], V_RESULT_OK);
+}
+
+TEST(GraphOptimizer, cond_dedup) {
+  GraphCluster cluster;
+  Graph& g = init_test_graph(cluster);
+  add_vertex(g, "a", {});
+  Vertex& c1 = add_vertex(g, "c1", {"a"});
+  c1.processor.clear();
+  c1.cond = "$x > 1";
+  Vertex& c2 = add_vertex(g, "c2", {"a"});
+  c2.processor.clear();
+  c2.cond = "$x > 1";
+  add_vertex(g, "d", {}, true).deps_on_ok = {"c1"};
+  add_vertex(g, "e", {}, true).deps_on_ok = {"c2"};
+  ASSERT_EQ(0, cluster.Build());
+  ASSERT_EQ(g._nodes.size(), 4u);
+
+  Vertex* keep = g.FindVertexById("c1");
+  if (nullptr == keep) {
+    keep = g.FindVertexById("c2");
+  }
+  ASSERT_TRUE(keep != nullptr);
+  ASSERT_EQ(keep->_successor_vertex.size(), 2u);
+  for (const char* id : {"d", "e"}) {
+    Vertex* v = g.FindVertexById(id);
+    ASSERT_EQ(v->_deps_idx.size(), 1u);
+    ASSERT_EQ(v->_deps_expected_results[v->GetDependencyIndex(keep)], V_RESULT_OK);
+  }
+}
+
+TEST(GraphOptimizer, cond_dedup_skip_expect_config) {
+  GraphCluster cluster;
+  Graph& g = init_test_graph(cluster);
+  add_vertex(g, "a", {});
+  Vertex& c1 = add_vertex(g, "c1", {"a"});
+  c1.processor.clear();
+  c1.cond = "$x > 1";
+  c1.expect_config = "with_a";
+  Vertex& c2 = add_vertex(g, "c2", {"a"});
+  c2.processor.clear();
+  c2.cond = "$x > 1";
+  c2.expect_config = "!with_a";
+  add_vertex(g, "d", {}, true).deps_on_ok = {"c1"};
+  add_vertex(g, "e", {}, true).deps_on_ok = {"c2"};
+  ASSERT_EQ(0, cluster.Build());
+  ASSERT_EQ(g._nodes.size(), 5u);
+  ASSERT_EQ(g.FindVertexById("d")->GetDependencyIndex(g.FindVertexById("c1")), 0);
+  ASSERT_EQ(g.FindVertexById("e")->GetDependencyIndex(g.FindVertexById("c2")), 0);
+}
+
+TEST(GraphOptimizer, dead_vertex) {
+  GraphCluster cluster;
+  Graph& g = init_test_graph(cluster);
+  add_vertex(g, "a", {});
+  // sink with outputs may be read by the caller
+  GraphData out;
+  out.field = "b_out";
+  add_vertex(g, "b", {"a"}).output.emplace_back(out);
+  add_vertex(g, "c", {"b"});
+  add_vertex(g, "d", {"a"}, true);
+  add_vertex(g, "e", {"a"}).early_exit_graph_if_failed = true;
+  add_vertex(g, "f", {"a"});
+  add_vertex(g, "h", {"f"});
+  ASSERT_EQ(0, cluster.Build());
+  ASSERT_EQ(g._nodes.size(), 4u);
+  ASSERT_TRUE(g.FindVertexById("b") != nullptr);
+  ASSERT_TRUE(g.FindVertexById("c") == nullptr);
+  ASSERT_TRUE(g.FindVertexById("f") == nullptr);
+  ASSERT_TRUE(g.FindVertexById("h") == nullptr);
+  ASSERT_EQ(g._topo_order.size(), 4u);
+  ASSERT_EQ(g.FindVertexById("a")->_successor_vertex.size(), 3u);
+
+  std::string report;
+  cluster.DumpOptimizeReport(report);
+  ASSERT_NE(report.find("--- graph:main vertexs:4 changes:3"), std::string::npos);
+  ASSERT_NE(report.find("- [dead_vertex] c:"), std::string::npos);
+  ASSERT_NE(report.find("- [dead_vertex] f:"), std::string::npos);
+  ASSERT_NE(report.find("- [dead_vertex] h:"), std::string::npos);
+}
+
+TEST(GraphOptimizer, dead_vertex_keep_single_output) {
+  GraphCluster cluster;
+  Graph& g = init_test_graph(cluster);
+  GraphData out;
+  out.field = "a_out";
+  add_vertex(g, "a", {}).output.emplace_back(out);
+  ASSERT_EQ(0, cluster.Build());
+  ASSERT_EQ(g._nodes.size(), 1u);
+  ASSERT_TRUE(g._optimize_actions.empty());
+}
+
+TEST(GraphOptimizer, disabled) {
+  GraphCluster cluster;
+  Graph& g = init_test_graph(cluster, false);
+  add_vertex(g, "a", {});
+  add_vertex(g, "b", {"a"}).expect = "$with_a";
+  ASSERT_EQ(0, cluster.Build());
+  ASSERT_EQ(g._nodes.size(), 3u);
+  ASSERT_TRUE(g._optimize_actions.empty());
+  std::string report;
+  cluster.DumpOptimizeReport(report);
+  ASSERT_TRUE(report.empty());
+}
+
+static Vertex& add_data_vertex(Graph& g, const std::string& id, const std::set<std::string>& deps,
+                               const std::string& input, const std::string& output) {
+  Vertex& v = add_vertex(g, id, deps);
+  if (!input.empty()) {
+    GraphData data;
+    data.field = input;
+    data.is_extern = true;
+    v.input.emplace_back(data);
+  }
+  if (!output.empty()) {
+    GraphData data;
+    data.field = output;
+    v.output.emplace_back(data);
+  }
+  return v;
+}
+
+static Vertex& add_subgraph_vertex(Graph& g, const std::string& id, const std::string& graph,
+                                   const std::set<std::string>& deps) {
+  Vertex& v = g.vertex.emplace_back();
+  v.id = id;
+  v.graph = graph;
+  v.deps = deps;
+  return v;
+}
+
+static void init_sub_graph(GraphCluster& cluster) {
+  cluster._name = "inline.toml";
+  Graph& sub = cluster.graph.emplace_back();
+  sub.name = "sub";
+  add_data_vertex(sub, "a", {}, "", "x").is_start = true;
+  add_data_vertex(sub, "b", {}, "x", "y");
+}
+
+TEST(GraphInline, inline_subgraph) {
+  GraphCluster cluster;
+  Graph& main = init_test_graph(cluster, false);
+  main.inline_subgraph = true;
+  add_vertex(main, "v0", {});
+  add_subgraph_vertex(main, "s", "sub", {"v0"});
+  add_data_vertex(main, "t", {}, "y", "").deps_on_ok = {"s"};
+  init_sub_graph(cluster);
+  ASSERT_EQ(0, cluster.Build());
+
+  Graph* g = cluster.FindGraphByName("main");
+  ASSERT_EQ(g->_nodes.size(), 6u);
+  Vertex* enter = g->FindVertexById("s__ENTER__");
+  Vertex* a = g->FindVertexById("s__a");
+  Vertex* b = g->FindVertexById("s__b");
+  Vertex* s = g->FindVertexById("s");
+  ASSERT_TRUE(enter != nullptr && a != nullptr && b != nullptr && s != nullptr);
+  ASSERT_TRUE(s->graph.empty());
+  ASSERT_EQ(s->processor, "didagle_noop");
+  ASSERT_EQ(enter->GetDependencyIndex(g->FindVertexById("v0")), 0);
+  ASSERT_EQ(a->_deps_expected_results[a->GetDependencyIndex(enter)], V_RESULT_OK);
+  ASSERT_GE(b->GetDependencyIndex(a), 0);
+  ASSERT_GE(s->GetDependencyIndex(b), 0);
+  // data of subgraph becomes an ordinary dependency
+  Vertex* t = g->FindVertexById("t");
+  ASSERT_GE(t->GetDependencyIndex(b), 0);
+  ASSERT_GE(t->GetDependencyIndex(s), 0);
+
+  std::string report;
+  cluster.DumpOptimizeReport(report);
+  ASSERT_NE(report.find("~ [inline_subgraph] s: inlined graph 'sub' with 2 vertexs"), std::string::npos);
+}
+
+TEST(GraphInline, rename_conflict_data) {
+  GraphCluster cluster;
+  Graph& main = init_test_graph(cluster, false);
+  main.inline_subgraph = true;
+  add_vertex(main, "v0", {});
+  add_subgraph_vertex(main, "s1", "sub", {"v0"});
+  add_subgraph_vertex(main, "s2", "sub", {"v0"});
+  add_vertex(main, "t", {"s1", "s2"}, true);
+  init_sub_graph(cluster);
+  ASSERT_EQ(0, cluster.Build());
+
+  Graph* g = cluster.FindGraphByName("main");
+  ASSERT_EQ(g->FindVertexByData("x"), g->FindVertexById("s1__a"));
+  ASSERT_EQ(g->FindVertexByData("s2__x"), g->FindVertexById("s2__a"));
+  ASSERT_EQ(g->FindVertexByData("s2__y"), g->FindVertexById("s2__b"));
+  ASSERT_EQ(g->FindVertexById("s2__b")->input[0].id, "s2__x");
+}
+
+TEST(GraphInline, keep_runtime_subgraph) {
+  GraphCluster cluster;
+  Graph& main = init_test_graph(cluster, false);
+  main.inline_subgraph = true;
+  add_vertex(main, "v0", {});
+  add_subgraph_vertex(main, "s1", "sub", {"v0"}).args.Put("k", "v");
+  Vertex& s2 = add_subgraph_vertex(main, "s2", "sub", {"v0"});
+  s2.cluster = "other.toml";
+  // data 'y' is read by main, can NOT be renamed for the second inlining
+  add_subgraph_vertex(main, "s3", "sub", {"v0"});
+  add_subgraph_vertex(main, "s4", "sub", {"v0"});
+  add_data_vertex(main, "t", {"s1", "s2", "s3", "s4"}, "y", "");
+  init_sub_graph(cluster);
+  ASSERT_EQ(0, cluster.Build());
+
+  Graph* g = cluster.FindGraphByName("main");
+  ASSERT_EQ(g->FindVertexById("s1")->graph, "sub");
+  ASSERT_EQ(g->FindVertexById("s2")->graph, "sub");
+  ASSERT_TRUE(g->FindVertexById("s3")->graph.empty());
+  ASSERT_EQ(g->FindVertexById("s4")->graph, "sub");
+}
+
+TEST(GraphInline, nested) {
+  GraphCluster cluster;
+  Graph& main = init_test_graph(cluster, false);
+  main.inline_subgraph = true;
+  add_vertex(main, "v0", {});
+  add_subgraph_vertex(main, "s", "mid", {"v0"});
+  Graph& mid = cluster.graph.emplace_back();
+  mid.name = "mid";
+  add_subgraph_vertex(mid, "m", "sub", {}).is_start = true;
+  init_sub_graph(cluster);
+  ASSERT_EQ(0, cluster.Build());
+
+  Graph* g = cluster.FindGraphByName("main");
+  ASSERT_TRUE(g->FindVertexById("s__m__a") != nullptr);
+  ASSERT_TRUE(g->FindVertexById("s__m__ENTER__") != nullptr);
+  ASSERT_EQ(g->_nodes.size(), 7u);
+  // 'mid' itself is not inlined
+  ASSERT_EQ(cluster.FindGraphByName("mid")->FindVertexById("m")->graph, "sub");
+}
+
+TEST(GraphInline, retarget_incoming_edges) {
+  GraphCluster cluster;
+  Graph& main = init_test_graph(cluster, false);
+  main.inline_subgraph = true;
+  add_vertex(main, "v0", {}).successor = {"s1"};
+  Vertex& c = add_vertex(main, "c", {"v0"});
+  c.processor.clear();
+  c.cond = "$flag > 1";
+  c.consequent = {"s2"};
+  add_subgraph_vertex(main, "s1", "sub", {});
+  add_subgraph_vertex(main, "s2", "sub", {});
+  add_vertex(main, "t", {"s1", "s2"}, true);
+  init_sub_graph(cluster);
+  ASSERT_EQ(0, cluster.Build());
+
+  Graph* g = cluster.FindGraphByName("main");
+  Vertex* v0 = g->FindVertexById("v0");
+  Vertex* enter1 = g->FindVertexById("s1__ENTER__");
+  ASSERT_TRUE(enter1 != nullptr);
+  ASSERT_GE(enter1->GetDependencyIndex(v0), 0);
+  ASSERT_LT(g->FindVertexById("s1")->GetDependencyIndex(v0), 0);
+  // the inlined body waits on the condition
+  Vertex* cond = g->FindVertexById("c");
+  Vertex* enter2 = g->FindVertexById("s2__ENTER__");
+  ASSERT_TRUE(enter2 != nullptr);
+  int idx = enter2->GetDependencyIndex(cond);
+  ASSERT_GE(idx, 0);
+  ASSERT_EQ(enter2->_deps_expected_results[idx], V_RESULT_OK);
+  ASSERT_LT(g->FindVertexById("s2")->GetDependencyIndex(cond), 0);
+}
@@ -4,6 +4,7 @@
 #include <fmt/core.h>
 #include <gtest/gtest.h>
 #include <stdint.h>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -119,3 +120,152 @@ start = true
     ASSERT_EQ(dv_result->at(i), i + 100.0);
   }
 }
+
+TEST(Params, compiled_key) {
+  Params params;
+  params["i_arg"].SetInt(101);
+  params["s_arg"].SetString("hello");
+  params["nested"]["d_arg"].SetDouble(3.14);
+  params["list"].Add()["b_arg"].SetBool(true);
+  params.Compile();
+  ASSERT_TRUE(params.IsCompiled());
+
+  static const ParamsKey i_key("i_arg");
+  static const ParamsKey s_key("s_arg");
+  static const ParamsKey d_key("d_arg");
+  static const ParamsKey b_key("b_arg");
+  static const ParamsKey missing_key("missing_arg");
+  ASSERT_EQ(ParamsKey("i_arg").id, i_key.id);
+  ASSERT_EQ(params[i_key].Int(), 101);
+  ASSERT_EQ(params[s_key].String(), "hello");
+  ASSERT_EQ(params[ParamsKey("nested")][d_key].Double(), 3.14);
+  ASSERT_TRUE(params[ParamsKey("list")][0][b_key].Bool());
+  ASSERT_FALSE(params[missing_key].Valid());
+
+  // copies keep the compiled form
+  Params copy = params;
+  ASSERT_TRUE(copy.IsCompiled());
+  ASSERT_EQ(copy[i_key].Int(), 101);
+
+  // inserting members drops the index, lookups stay correct
+  copy.Put("missing_arg", static_cast<int64_t>(7));
+  ASSERT_FALSE(copy.IsCompiled());
+  ASSERT_EQ(copy[missing_key].Int(), 7);
+
+  // keys missing in compiled params fall back to parent
+  Params parent;
+  parent["missing_arg"].SetString("from_parent");
+  params.SetParent(&parent);
+  ASSERT_EQ(params[missing_key].String(), "from_parent");
+  params.SetParent(nullptr);
+}
+
+TEST(Params, overlay) {
+  Params exec_params;
+  exec_params["a"].SetString("exec_a");
+  exec_params["b"].SetString("exec_b");
+  exec_params["c"].SetString("exec_c");
+  Params vertex_args;
+  vertex_args["b"].SetString("vertex_b");
+  vertex_args["c"].SetString("vertex_c");
+  vertex_args.Compile();
+  Params select_args;
+  select_args["c"].SetString("select_c");
+
+  Params vertex_view;
+  vertex_view.SetOverlay(&vertex_args, &exec_params);
+  Params select_view;
+  select_view.SetOverlay(&select_args, &vertex_view);
+  ASSERT_EQ(select_view["a"].String(), "exec_a");
+  ASSERT_EQ(select_view["b"].String(), "vertex_b");
+  ASSERT_EQ(select_view[ParamsKey("c")].String(), "select_c");
+  ASSERT_EQ(vertex_view[ParamsKey("c")].String(), "vertex_c");
+  ASSERT_EQ(vertex_view.Size(), 2u);
+  ASSERT_TRUE(select_view.Contains("a"));
+  ASSERT_FALSE(select_view.Contains("d"));
+
+  // layered params are never modified
+  ASSERT_FALSE(vertex_args.Contains("a"));
+  ASSERT_FALSE(select_args.Contains("b"));
+}
+
+TEST(Params, cached_apply) {
+  std::string content = R"(
+name="test"
+[[graph]]
+name="test"
+[[graph.vertex]]
+processor = "test0"
+args = {i_arg = 5}
+start = true
+  )";
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 6; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ParamsPtr params;
+    if (i % 2 == 1) {
+      params = Params::New();
+      (*params)["s_arg"].SetString("round_" + std::to_string(i));
+    }
+    int rc = ctx.store->SyncExecute(data_ctx, "test", "test", params);
+    ASSERT_EQ(rc, 0);
+    auto i_result = data_ctx->Get<int64_t>("i_result");
+    ASSERT_TRUE(i_result != nullptr);
+    ASSERT_EQ(*i_result, 5);
+    auto s_result = data_ctx->Get<std::string>("s_result");
+    ASSERT_TRUE(s_result != nullptr);
+    // params from last execution must not leak into the next one
+    ASSERT_EQ(*s_result, params ? "round_" + std::to_string(i) : std::string("abcde"));
+  }
+}
+
+GRAPH_OP_BEGIN(test_cached_param)
+GRAPH_PARAMS_int(c_arg, 7, "e");
+int OnExecute(const Params& args) override {
+  int rc = static_cast<int>(PARAMS_c_arg);
+  // never do this in real processors, it shows the applied value is kept across executions
+  PARAMS_c_arg = -1;
+  return rc;
+}
+GRAPH_OP_END
+
+TEST(Params, reset) {
+  std::unique_ptr<Processor> p(ProcessorFactory::GetProcessor("test_cached_param"));
+  ASSERT_TRUE(p != nullptr);
+  Params args;
+  args["c_arg"].SetInt(3);
+  p->SetParamsVersion(1);
+  ASSERT_EQ(p->Execute(args), 3);
+  // same key in one execution, setters are skipped
+  p->SetParamsVersion(1);
+  ASSERT_EQ(p->Execute(args), -1);
+  // 'Reset' restores defaults & drops the applied key
+  p->Reset();
+  p->SetParamsVersion(1);
+  ASSERT_EQ(p->Execute(args), 3);
+  // new key, reset to defaults before applying
+  Params empty_args;
+  p->SetParamsVersion(2);
+  ASSERT_EQ(p->Execute(empty_args), 7);
+  // always applied without version
+  ASSERT_EQ(p->Execute(args), 3);
+  ASSERT_EQ(p->Execute(args), 3);
+}
+
+TEST(Params, kept_after_reset) {
+  std::unique_ptr<Processor> p(ProcessorFactory::GetProcessor("test_cached_param"));
+  ASSERT_TRUE(p != nullptr);
+  p->KeepParamsOnReset(true);
+  Params args;
+  args["c_arg"].SetInt(3);
+  p->SetParamsVersion(1);
+  ASSERT_EQ(p->Execute(args), 3);
+  p->Reset();
+  // same key, setters are skipped & 'Reset' does not restore defaults
+  p->SetParamsVersion(1);
+  ASSERT_EQ(p->Execute(args), -1);
+  p->SetParamsVersion(2);
+  ASSERT_EQ(p->Execute(args), 3);
+}
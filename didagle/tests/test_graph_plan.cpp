@@ -0,0 +1,188 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "didagle/graph/graph_plan.h"
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(plan_test0)
+GRAPH_OP_OUTPUT(int, plan_a)
+int OnExecute(const Params& args) override {
+  plan_a = args["v"].Int();
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(plan_test1)
+GRAPH_OP_INPUT(int, plan_a)
+GRAPH_OP_OUTPUT(int, plan_b)
+int OnExecute(const Params& args) override {
+  plan_b = (nullptr == plan_a ? 0 : *plan_a) + 1;
+  return 0;
+}
+GRAPH_OP_END
+
+static void init_test_cluster(GraphCluster& cluster) {
+  cluster.name = "plan";
+  cluster._name = "plan.toml";
+  cluster.desc = "graph plan test";
+  cluster.strict_dsl = false;
+  cluster.default_expr_processor = "expr";
+  cluster.default_context_pool_size = 2;
+  cluster.trace_sample_rate = 0.5;
+  ConfigSetting cfg;
+  cfg.name = "with_a";
+  cfg.cond = "$a==1";
+  cluster.config_setting.emplace_back(cfg);
+
+  Graph& g = cluster.graph.emplace_back();
+  g.name = "main";
+  g.priority = 3;
+  g.early_exit_graph_if_failed = true;
+  g.optimize = true;
+  g.inline_subgraph = true;
+  g.resume_on = "graph";
+  Vertex& v0 = g.vertex.emplace_back();
+  v0.id = "v0";
+  v0.processor = "p0";
+  v0.is_start = true;
+  v0.args.Put("s", "str").Put("i", static_cast<int64_t>(10)).Put("d", 1.5).Put("b", true);
+  v0.args["obj"]["nested"].Add().SetInt(7);
+  GraphData out;
+  out.field = "a";
+  out.id = "a_out";
+  v0.output.emplace_back(out);
+  CondParams select;
+  select.match = "with_a";
+  select.inherit_default = true;
+  select.args.Put("s", "selected");
+  v0.select_args.emplace_back(select);
+
+  Vertex& v1 = g.vertex.emplace_back();
+  v1.id = "v1";
+  v1.processor = "p1";
+  v1.deps_on_ok = {"v0"};
+  v1.successor = {"v2", "v3"};
+  v1.while_async = false;
+  v1.side_effect = true;
+  v1.resume_on = "cpu";
+  GraphData in;
+  in.field = "all";
+  in.aggregate = {"a_out", "b_out"};
+  in.required = true;
+  v1.input.emplace_back(in);
+}
+
+TEST(GraphPlan, round_trip) {
+  GraphCluster cluster;
+  init_test_cluster(cluster);
+  std::string buf;
+  ASSERT_EQ(0, write_graph_plan({&cluster}, buf));
+  auto plan = GraphPlan::LoadBuffer(buf);
+  ASSERT_TRUE(plan != nullptr);
+  ASSERT_EQ(plan->GetClusterCount(), 1u);
+  ASSERT_EQ(plan->GetClusterName(0), "plan.toml");
+
+  GraphCluster loaded;
+  ASSERT_EQ(0, plan->ReadCluster(0, loaded));
+  ASSERT_EQ(loaded.name, "plan");
+  ASSERT_EQ(loaded._name, "plan.toml");
+  ASSERT_EQ(loaded.desc, "graph plan test");
+  ASSERT_FALSE(loaded.strict_dsl);
+  ASSERT_EQ(loaded.default_expr_processor, "expr");
+  ASSERT_EQ(loaded.default_context_pool_size, 2);
+  ASSERT_DOUBLE_EQ(loaded.trace_sample_rate, 0.5);
+  ASSERT_EQ(loaded.config_setting.size(), 1u);
+  ASSERT_EQ(loaded.config_setting[0].cond, "$a==1");
+
+  ASSERT_EQ(loaded.graph.size(), 1u);
+  const Graph& g = loaded.graph[0];
+  ASSERT_EQ(g.name, "main");
+  ASSERT_EQ(g.priority, 3);
+  ASSERT_TRUE(g.early_exit_graph_if_failed);
+  ASSERT_TRUE(g.vertex_skip_as_error);
+  ASSERT_TRUE(g.optimize);
+  ASSERT_TRUE(g.inline_subgraph);
+  ASSERT_EQ(g.resume_on, "graph");
+  ASSERT_EQ(g.vertex.size(), 2u);
+
+  const Vertex& v0 = g.vertex[0];
+  ASSERT_EQ(v0.id, "v0");
+  ASSERT_TRUE(v0.is_start);
+  ASSERT_EQ(v0.args["s"].String(), "str");
+  ASSERT_EQ(v0.args["i"].Int(), 10);
+  ASSERT_DOUBLE_EQ(v0.args["d"].Double(), 1.5);
+  ASSERT_TRUE(v0.args["b"].Bool());
+  ASSERT_EQ(v0.args["obj"]["nested"][0].Int(), 7);
+  ASSERT_EQ(v0.output.size(), 1u);
+  ASSERT_EQ(v0.output[0].id, "a_out");
+  ASSERT_EQ(v0.select_args.size(), 1u);
+  ASSERT_EQ(v0.select_args[0].match, "with_a");
+  ASSERT_TRUE(v0.select_args[0].inherit_default);
+  ASSERT_EQ(v0.select_args[0].args["s"].String(), "selected");
+
+  const Vertex& v1 = g.vertex[1];
+  ASSERT_EQ(v1.deps_on_ok, (std::set<std::string>{"v0"}));
+  ASSERT_EQ(v1.successor, (std::set<std::string>{"v2", "v3"}));
+  ASSERT_TRUE(v1.deps.empty());
+  ASSERT_FALSE(v1.while_async);
+  ASSERT_TRUE(v1.side_effect);
+  ASSERT_FALSE(v0.side_effect);
+  ASSERT_EQ(v1.resume_on, "cpu");
+  ASSERT_TRUE(v0.resume_on.empty());
+  ASSERT_EQ(v1.input.size(), 1u);
+  ASSERT_TRUE(v1.input[0].required);
+  ASSERT_EQ(v1.input[0].aggregate, (std::vector<std::string>{"a_out", "b_out"}));
+}
+
+TEST(GraphPlan, invalid) {
+  GraphCluster cluster;
+  init_test_cluster(cluster);
+  std::string buf;
+  ASSERT_EQ(0, write_graph_plan({&cluster}, buf));
+
+  ASSERT_TRUE(GraphPlan::LoadBuffer(buf.substr(0, buf.size() - 1)) == nullptr);
+  std::string corrupted = buf;
+  corrupted[corrupted.size() - 1] ^= 0x1;
+  ASSERT_TRUE(GraphPlan::LoadBuffer(corrupted) == nullptr);
+  std::string version = buf;
+  version[8] += 1;
+  ASSERT_TRUE(GraphPlan::LoadBuffer(version) == nullptr);
+  ASSERT_TRUE(GraphPlan::Load("/not_exist/plan.bin") == nullptr);
+
+  cluster._builded = true;
+  ASSERT_NE(0, write_graph_plan({&cluster}, buf));
+}
+
+TEST(GraphPlan, store) {
+  std::string content = R"(
+name = "plan_store"
+[[graph]]
+name = "main"
+[[graph.vertex]]
+processor = "plan_test0"
+args = { v = 100 }
+start = true
+[[graph.vertex]]
+processor = "plan_test1"
+  )";
+  GraphCluster cluster;
+  ASSERT_TRUE(kcfg::ParseFromTomlString(content, cluster));
+  cluster._name = cluster.name;
+  std::string file = testing::TempDir() + "/test_graph_plan.bin";
+  ASSERT_EQ(0, write_graph_plan_file({&cluster}, file));
+
+  TestContext ctx;
+  ASSERT_EQ(0, ctx.store->LoadPlan(file));
+  ASSERT_TRUE(ctx.store->Exists("plan_store", "main"));
+  auto data_ctx = GraphDataContext::New();
+  ASSERT_EQ(0, ctx.store->SyncExecute(data_ctx, "plan_store", "main"));
+  auto plan_b = data_ctx->Get<int>("plan_b");
+  ASSERT_TRUE(plan_b != nullptr);
+  ASSERT_EQ(*plan_b, 101);
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <benchmark/benchmark.h>
+#include <fmt/core.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include "didagle/graph/graph_plan.h"
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(plan_bench_noop)
+int OnExecute(const Params& args) override { return 0; }
+GRAPH_OP_END
+
+// same layered graph as 'test_graph_bench', with args to make the TOML parsing cost visible
+static std::string gen_plan_bench_dsl(int64_t n) {
+  std::string content = R"(
+name = "plan_bench"
+strict_dsl = true
+default_context_pool_size = 1
+
+[[graph]]
+name = "large"
+[[graph.vertex]]
+id = "v0"
+processor = "plan_bench_noop"
+start = true
+)";
+  for (int64_t i = 1; i < n; i++) {
+    content.append(fmt::format("[[graph.vertex]]\nid = \"v{}\"\nprocessor = \"plan_bench_noop\"\n", i));
+    content.append(fmt::format("args = {{idx = {}, name = \"v{}\", ratio = 0.5}}\n", i, i));
+    if (i > 1) {
+      content.append(fmt::format("deps = [\"v{}\", \"v{}\"]\n", i - 1, i / 2));
+    } else {
+      content.append("deps = [\"v0\"]\n");
+    }
+  }
+  return content;
+}
+
+// a fresh store for every iteration, reloading unchanged content into the same store is skipped
+static void BM_startup_dsl(benchmark::State& state) {
+  std::string content = gen_plan_bench_dsl(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = std::make_unique<TestContext>();
+    state.ResumeTiming();
+    if (!ctx->store->LoadString(content)) {
+      state.SkipWithError("failed to load graph");
+      break;
+    }
+    state.PauseTiming();
+    ctx.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_startup_dsl)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+static void BM_startup_plan(benchmark::State& state) {
+  GraphCluster cluster;
+  if (!kcfg::ParseFromTomlString(gen_plan_bench_dsl(state.range(0)), cluster)) {
+    state.SkipWithError("failed to parse graph");
+    return;
+  }
+  cluster._name = cluster.name;
+  std::string file = fmt::format("/tmp/didagle_plan_bench_{}.bin", state.range(0));
+  if (0 != write_graph_plan_file({&cluster}, file)) {
+    state.SkipWithError("failed to write graph plan");
+    return;
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = std::make_unique<TestContext>();
+    state.ResumeTiming();
+    if (0 != ctx->store->LoadPlan(file)) {
+      state.SkipWithError("failed to load graph plan");
+      break;
+    }
+    state.PauseTiming();
+    ctx.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  unlink(file.c_str());
+}
+BENCHMARK(BM_startup_plan)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+// Run the benchmark
+BENCHMARK_MAIN();
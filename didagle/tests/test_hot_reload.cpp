@@ -0,0 +1,198 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "didagle/graph/graph_plan.h"
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(reload_test0)
+GRAPH_OP_OUTPUT(int, reload_a)
+int OnExecute(const Params& args) override {
+  reload_a = args["v"].Int();
+  return 0;
+}
+GRAPH_OP_END
+
+static std::string get_reload_dsl(int v) {
+  return fmt::format(R"(
+name = "reload"
+default_context_pool_size = 2
+[[graph]]
+name = "main"
+[[graph.vertex]]
+processor = "reload_test0"
+args = {{ v = {} }}
+start = true
+  )",
+                     v);
+}
+
+static int execute_reload(TestContext& ctx) {
+  auto data_ctx = GraphDataContext::New();
+  if (0 != ctx.store->SyncExecute(data_ctx, "reload", "main")) {
+    return -1;
+  }
+  auto a = data_ctx->Get<int>("reload_a");
+  return nullptr == a ? -1 : *a;
+}
+
+TEST(HotReload, unchanged) {
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(get_reload_dsl(1));
+  ASSERT_TRUE(handle != nullptr);
+  ASSERT_EQ(handle->created_contexts.load(), 2);
+  auto reloaded = ctx.store->LoadString(get_reload_dsl(1));
+  ASSERT_EQ(handle.get(), reloaded.get());
+  ASSERT_EQ(handle.get(), ctx.store->FindGraphClusterByName("reload").get());
+  ASSERT_EQ(execute_reload(ctx), 1);
+}
+
+TEST(HotReload, changed) {
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(get_reload_dsl(1));
+  ASSERT_TRUE(handle != nullptr);
+  // grow the pool of current version beyond the default size
+  std::vector<GraphClusterContext*> busy;
+  for (int i = 0; i < 5; i++) {
+    busy.emplace_back(ctx.store->GetGraphClusterContext("reload"));
+  }
+  ASSERT_EQ(handle->created_contexts.load(), 5);
+
+  auto reloaded = ctx.store->LoadString(get_reload_dsl(2));
+  ASSERT_TRUE(reloaded != nullptr);
+  ASSERT_NE(handle.get(), reloaded.get());
+  ASSERT_EQ(reloaded->created_contexts.load(), 5);
+  ASSERT_EQ(execute_reload(ctx), 2);
+  // no context is created on demand after the swap
+  ASSERT_EQ(reloaded->created_contexts.load(), 5);
+
+  for (GraphClusterContext* c : busy) {
+    c->GetRunningCluster()->ReleaseContext(c);
+  }
+}
+
+TEST(HotReload, generation) {
+  TestContext ctx;
+  uint64_t generation = ctx.store->GetClusterGeneration();
+  ASSERT_TRUE(ctx.store->LoadString(get_reload_dsl(1)) != nullptr);
+  uint64_t loaded_generation = ctx.store->GetClusterGeneration();
+  ASSERT_NE(generation, loaded_generation);
+  ASSERT_TRUE(ctx.store->LoadString(get_reload_dsl(1)) != nullptr);
+  ASSERT_EQ(loaded_generation, ctx.store->GetClusterGeneration());
+  ASSERT_TRUE(ctx.store->LoadString(get_reload_dsl(2)) != nullptr);
+  ASSERT_NE(loaded_generation, ctx.store->GetClusterGeneration());
+}
+
+TEST(HotReload, subgraph_cache) {
+  TestContext ctx;
+  ASSERT_TRUE(ctx.store->LoadString(get_reload_dsl(1)) != nullptr);
+  ASSERT_TRUE(ctx.store->LoadString(R"(
+name = "reload_parent"
+default_context_pool_size = 1
+[[graph]]
+name = "main"
+[[graph.vertex]]
+cluster = "reload"
+graph = "main"
+start = true
+  )") != nullptr);
+  auto execute_parent = [&]() {
+    auto data_ctx = GraphDataContext::New();
+    if (0 != ctx.store->SyncExecute(data_ctx, "reload_parent", "main")) {
+      return -1;
+    }
+    auto a = data_ctx->Get<int>("reload_a");
+    return nullptr == a ? -1 : *a;
+  };
+  ASSERT_EQ(execute_parent(), 1);
+  ASSERT_EQ(execute_parent(), 1);
+  // cached subgraph cluster is resolved again after reload
+  ASSERT_TRUE(ctx.store->LoadString(get_reload_dsl(3)) != nullptr);
+  ASSERT_EQ(execute_parent(), 3);
+}
+
+TEST(HotReload, concurrent_lookup) {
+  TestContext ctx;
+  ASSERT_TRUE(ctx.store->LoadString(get_reload_dsl(0)) != nullptr);
+  std::atomic<bool> stop{false};
+  std::atomic<int> missing{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&]() {
+      while (!stop.load()) {
+        if (!ctx.store->FindGraphClusterByName("reload")) {
+          missing++;
+        }
+      }
+    });
+  }
+  for (int i = 1; i <= 20; i++) {
+    ASSERT_TRUE(ctx.store->LoadString(get_reload_dsl(i)) != nullptr);
+  }
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  ASSERT_EQ(missing.load(), 0);
+  ASSERT_EQ(execute_reload(ctx), 20);
+}
+
+TEST(HotReload, batch) {
+  std::string file = testing::TempDir() + "/reload.toml";
+  auto write_dsl = [&](int v) {
+    FILE* fp = fopen(file.c_str(), "w");
+    ASSERT_TRUE(fp != nullptr);
+    std::string content = get_reload_dsl(v);
+    fwrite(content.data(), 1, content.size(), fp);
+    fclose(fp);
+  };
+  TestContext ctx;
+  std::vector<ClusterLoadResult> results;
+  write_dsl(1);
+  ASSERT_EQ(0, ctx.store->LoadBatch({file}, results));
+  auto handle = ctx.store->FindGraphClusterByName("reload.toml");
+  ASSERT_TRUE(handle != nullptr);
+  ASSERT_NE(handle->content_hash, 0u);
+  uint64_t generation = ctx.store->GetClusterGeneration();
+  ASSERT_EQ(0, ctx.store->LoadBatch({file}, results));
+  ASSERT_EQ(handle.get(), ctx.store->FindGraphClusterByName("reload.toml").get());
+  ASSERT_EQ(generation, ctx.store->GetClusterGeneration());
+
+  write_dsl(2);
+  ASSERT_EQ(0, ctx.store->LoadBatch({file}, results));
+  auto reloaded = ctx.store->FindGraphClusterByName("reload.toml");
+  ASSERT_NE(handle.get(), reloaded.get());
+  ASSERT_EQ(reloaded->created_contexts.load(), 2);
+}
+
+TEST(HotReload, plan) {
+  std::string file = testing::TempDir() + "/reload_plan.bin";
+  auto write_plan = [&](int v) {
+    GraphCluster cluster;
+    ASSERT_TRUE(kcfg::ParseFromTomlString(get_reload_dsl(v), cluster));
+    cluster._name = cluster.name;
+    ASSERT_EQ(0, write_graph_plan_file({&cluster}, file));
+  };
+  TestContext ctx;
+  write_plan(1);
+  ASSERT_EQ(0, ctx.store->LoadPlan(file));
+  auto handle = ctx.store->FindGraphClusterByName("reload");
+  ASSERT_TRUE(handle != nullptr);
+  ASSERT_EQ(0, ctx.store->LoadPlan(file));
+  ASSERT_EQ(handle.get(), ctx.store->FindGraphClusterByName("reload").get());
+  ASSERT_EQ(execute_reload(ctx), 1);
+
+  write_plan(2);
+  ASSERT_EQ(0, ctx.store->LoadPlan(file));
+  ASSERT_NE(handle.get(), ctx.store->FindGraphClusterByName("reload").get());
+  ASSERT_EQ(execute_reload(ctx), 2);
+}
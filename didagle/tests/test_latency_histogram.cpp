@@ -0,0 +1,156 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+#include "didagle/trace/histogram.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(test_sleep0)
+GRAPH_OP_OUTPUT(int64_t, sleep_result0)
+int OnExecute(const Params& args) override {
+  usleep(2000);
+  sleep_result0 = 1;
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(test_sleep1)
+GRAPH_OP_INPUT(int64_t, sleep_result0)
+GRAPH_OP_OUTPUT(int64_t, sleep_result1)
+int OnExecute(const Params& args) override {
+  sleep_result1 = 2;
+  return 0;
+}
+GRAPH_OP_END
+
+TEST(LatencyHistogram, buckets) {
+  uint32_t last_idx = 0;
+  for (uint64_t v = 0; v < 100000; v++) {
+    uint32_t idx = LatencyHistogram::BucketIndex(v);
+    ASSERT_GE(idx, last_idx);
+    ASSERT_LE(LatencyHistogram::BucketLowerBound(idx), v);
+    ASSERT_GT(LatencyHistogram::BucketLowerBound(idx + 1), v);
+    last_idx = idx;
+  }
+  ASSERT_EQ(LatencyHistogram::BucketIndex(UINT64_MAX), LatencyHistogram::kBucketNum - 1);
+}
+
+TEST(LatencyHistogram, snapshot) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&histogram]() {
+      for (uint64_t v = 1; v <= 1000; v++) {
+        histogram.Record(v);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  HistogramSnapshot snapshot = histogram.Snapshot();
+  ASSERT_EQ(snapshot.count, 4000u);
+  ASSERT_EQ(snapshot.sum, 4u * 500500);
+  ASSERT_EQ(snapshot.max, 1000u);
+  ASSERT_DOUBLE_EQ(snapshot.Mean(), 500.5);
+  // relative error of log-linear buckets is below 12.5%
+  ASSERT_NEAR(snapshot.Percentile(50), 500, 500 * 0.125);
+  ASSERT_NEAR(snapshot.Percentile(99), 990, 990 * 0.125);
+  ASSERT_EQ(snapshot.Percentile(100), 1000u);
+
+  HistogramSnapshot merged = snapshot;
+  merged.Merge(snapshot);
+  ASSERT_EQ(merged.count, 8000u);
+  ASSERT_EQ(merged.Percentile(50), snapshot.Percentile(50));
+}
+
+TEST(LatencyHistogram, empty) {
+  LatencyHistogram histogram;
+  HistogramSnapshot snapshot = histogram.Snapshot();
+  ASSERT_EQ(snapshot.count, 0u);
+  ASSERT_EQ(snapshot.buckets.size(), LatencyHistogram::kBucketNum);
+  ASSERT_EQ(snapshot.Percentile(50), 0u);
+  histogram.Record(5);
+  snapshot = histogram.Snapshot();
+  ASSERT_EQ(snapshot.count, 1u);
+  ASSERT_EQ(snapshot.Percentile(50), 5u);
+}
+
+TEST(LatencyHistogram, vertex_stats) {
+  std::string content = R"(
+name="test"
+[[graph]]
+name="test"
+[[graph.vertex]]
+processor = "test_sleep0"
+[[graph.vertex]]
+processor = "test_sleep1"
+  )";
+  TestContext ctx(4, [](GraphExecuteOptions& opt) { opt.vertex_latency_stats = true; });
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 10; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test", "test"), 0);
+  }
+  std::vector<VertexLatencySnapshot> snapshots;
+  ASSERT_EQ(ctx.store->GetVertexLatencyStats("test", snapshots), 0);
+  ASSERT_EQ(snapshots.size(), 2u);
+  for (const auto& snapshot : snapshots) {
+    ASSERT_EQ(snapshot.cluster, "test");
+    ASSERT_EQ(snapshot.graph, "test");
+    ASSERT_EQ(snapshot.phases[VERTEX_LATENCY_EXECUTE].count, 10u);
+    ASSERT_EQ(snapshot.phases[VERTEX_LATENCY_PREPARE].count, 10u);
+    ASSERT_EQ(snapshot.phases[VERTEX_LATENCY_READY_WAIT].count, 10u);
+    if (snapshot.vertex == "test_sleep0") {
+      ASSERT_GE(snapshot.phases[VERTEX_LATENCY_EXECUTE].Percentile(50), 1500u);
+    }
+  }
+}
+
+TEST(LatencyHistogram, ready_wait) {
+  std::string content = R"(
+name="test_ready"
+[[graph]]
+name="test"
+[[graph.vertex]]
+id = "v0"
+processor = "test_sleep0"
+[[graph.vertex]]
+id = "v1"
+processor = "test_sleep0"
+[[graph.vertex]]
+id = "v2"
+processor = "test_sleep0"
+  )";
+  TestContext ctx(4, [](GraphExecuteOptions& opt) {
+    opt.vertex_latency_stats = true;
+    opt.executor_queue_depth = []() -> int64_t { return 3; };
+  });
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+  for (int i = 0; i < 10; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test_ready", "test"), 0);
+  }
+  std::vector<VertexLatencySnapshot> snapshots;
+  ASSERT_EQ(ctx.store->GetVertexLatencyStats("test_ready", snapshots), 0);
+  ASSERT_EQ(snapshots.size(), 3u);
+  VertexLatencySnapshot merged;
+  for (const auto& snapshot : snapshots) {
+    ASSERT_EQ(snapshot.phases[VERTEX_LATENCY_READY_WAIT].count, 10u);
+    merged.Merge(snapshot);
+  }
+  // one of the start vertexs runs inplace, others are dispatched to executor
+  ASSERT_EQ(merged.phases[VERTEX_LATENCY_QUEUE_WAIT].count, 20u);
+  ASSERT_EQ(merged.dispatch_queue_depth.count, 20u);
+  ASSERT_EQ(merged.dispatch_queue_depth.max, 3u);
+}
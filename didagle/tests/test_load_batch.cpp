@@ -0,0 +1,144 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(batch_test0)
+GRAPH_OP_OUTPUT(int, batch_a)
+int OnExecute(const Params& args) override {
+  batch_a = 10;
+  return 0;
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(batch_test1)
+GRAPH_OP_INPUT(int, batch_a)
+GRAPH_OP_OUTPUT(int, batch_b)
+int OnExecute(const Params& args) override {
+  batch_b = (nullptr == batch_a ? 0 : *batch_a) + 1;
+  return 0;
+}
+GRAPH_OP_END
+
+static void write_file(const std::string& file, const std::string& content) {
+  FILE* fp = fopen(file.c_str(), "w");
+  ASSERT_TRUE(fp != nullptr);
+  fwrite(content.data(), 1, content.size(), fp);
+  fclose(fp);
+}
+
+TEST(LoadBatch, directory) {
+  std::string dir = testing::TempDir() + "/test_load_batch";
+  mkdir(dir.c_str(), 0755);
+  // 'main' references graph of 'sub' which is loaded in the same batch
+  write_file(dir + "/main.toml", R"(
+name = "main"
+[[graph]]
+name = "main"
+[[graph.vertex]]
+processor = "batch_test0"
+successor = ["sub"]
+[[graph.vertex]]
+id = "sub"
+cluster = "sub.toml"
+graph = "sub"
+  )");
+  write_file(dir + "/sub.toml", R"(
+name = "sub"
+[[graph]]
+name = "sub"
+[[graph.vertex]]
+processor = "batch_test1"
+start = true
+input = [{ field = "batch_a", extern = true }]
+  )");
+  write_file(dir + "/broken.toml", R"(
+name = "broken"
+[[graph]]
+name = "broken"
+[[graph.vertex]]
+id = "missing"
+cluster = "missing.toml"
+graph = "missing"
+start = true
+  )");
+  write_file(dir + "/ignored.txt", "not a DSL");
+
+  TestContext ctx;
+  std::vector<ClusterLoadResult> results;
+  ASSERT_NE(0, ctx.store->LoadDirectory(dir, results, 2));
+  ASSERT_EQ(results.size(), 3u);
+  ASSERT_EQ(results[0].cluster, "broken.toml");
+  ASSERT_NE(results[0].rc, 0);
+  ASSERT_FALSE(results[0].error.empty());
+  ASSERT_EQ(results[1].cluster, "main.toml");
+  ASSERT_EQ(results[1].rc, 0);
+  ASSERT_EQ(results[2].cluster, "sub.toml");
+  ASSERT_EQ(results[2].rc, 0);
+
+  ASSERT_FALSE(ctx.store->Exists("broken.toml", "broken"));
+  ASSERT_TRUE(ctx.store->Exists("main.toml", "main"));
+  ASSERT_TRUE(ctx.store->Exists("sub.toml", "sub"));
+  auto data_ctx = GraphDataContext::New();
+  ASSERT_EQ(0, ctx.store->SyncExecute(data_ctx, "main.toml", "main"));
+  auto batch_b = data_ctx->Get<int>("batch_b");
+  ASSERT_TRUE(batch_b != nullptr);
+  ASSERT_EQ(*batch_b, 11);
+}
+
+TEST(LoadBatch, parse_error) {
+  std::string file = testing::TempDir() + "/test_load_batch_invalid.toml";
+  write_file(file, "name = ");
+  TestContext ctx;
+  std::vector<ClusterLoadResult> results;
+  ASSERT_NE(0, ctx.store->LoadBatch({file, testing::TempDir() + "/not_exist.toml"}, results));
+  ASSERT_EQ(results.size(), 2u);
+  ASSERT_NE(results[0].rc, 0);
+  ASSERT_NE(results[1].rc, 0);
+}
+
+TEST(LoadBatch, transitive_failure) {
+  std::string dir = testing::TempDir() + "/test_load_batch_chain";
+  mkdir(dir.c_str(), 0755);
+  // 'a_top' -> 'b_mid' -> missing, 'a_top' is checked before 'b_mid' is dropped
+  write_file(dir + "/a_top.toml", R"(
+name = "a_top"
+[[graph]]
+name = "top"
+[[graph.vertex]]
+id = "mid"
+cluster = "b_mid.toml"
+graph = "mid"
+start = true
+  )");
+  write_file(dir + "/b_mid.toml", R"(
+name = "b_mid"
+[[graph]]
+name = "mid"
+[[graph.vertex]]
+id = "missing"
+cluster = "missing.toml"
+graph = "missing"
+start = true
+  )");
+
+  TestContext ctx;
+  std::vector<ClusterLoadResult> results;
+  ASSERT_NE(0, ctx.store->LoadDirectory(dir, results, 1));
+  ASSERT_EQ(results.size(), 2u);
+  ASSERT_EQ(results[0].cluster, "a_top.toml");
+  ASSERT_NE(results[0].rc, 0);
+  ASSERT_NE(results[0].error.find("b_mid.toml"), std::string::npos);
+  ASSERT_EQ(results[1].cluster, "b_mid.toml");
+  ASSERT_NE(results[1].rc, 0);
+  ASSERT_FALSE(ctx.store->Exists("a_top.toml", "top"));
+  ASSERT_FALSE(ctx.store->Exists("b_mid.toml", "mid"));
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+// strip debug statements of this file at compile time
+#define DIDAGLE_MIN_LOG_LEVEL SPDLOG_LEVEL_INFO
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "didagle/log/async_logger.h"
+#include "didagle/log/log.h"
+using namespace didagle;
+
+namespace {
+struct CaptureLogger : public Logger {
+  std::mutex mutex;
+  std::vector<std::string> msgs;
+  bool ShouldLog(spdlog::level::level_enum log_level) override { return true; }
+  void Log(spdlog::source_loc loc, spdlog::level::level_enum lvl, std::string_view msg) override {
+    std::lock_guard<std::mutex> guard(mutex);
+    msgs.emplace_back(msg);
+  }
+};
+
+int count_eval(int& n) {
+  n++;
+  return n;
+}
+}  // namespace
+
+TEST(Logger, level) {
+  auto capture = std::make_shared<CaptureLogger>();
+  Logger::SetLogger(capture);
+  int eval = 0;
+  DIDAGLE_INFO("info {}", count_eval(eval));
+  ASSERT_EQ(eval, 1);
+  ASSERT_EQ(capture->msgs.size(), 1u);
+  ASSERT_EQ(capture->msgs[0], "info 1");
+
+  Logger::SetLevel(spdlog::level::warn);
+  DIDAGLE_INFO("info {}", count_eval(eval));
+  ASSERT_EQ(eval, 1);
+  DIDAGLE_WARN("warn {}", count_eval(eval));
+  ASSERT_EQ(eval, 2);
+
+  // removed at compile time even if enabled at runtime
+  Logger::SetLevel(spdlog::level::debug);
+  DIDAGLE_DEBUG("debug {}", count_eval(eval));
+  ASSERT_EQ(eval, 2);
+  ASSERT_EQ(capture->msgs.size(), 2u);
+  DIDAGLE_LOG(spdlog::level::debug, "debug {}", count_eval(eval));
+  ASSERT_EQ(eval, 2);
+
+  Logger::SetLevel(spdlog::level::trace);
+  Logger::SetLogger(nullptr);
+}
+
+TEST(Logger, async) {
+  auto capture = std::make_shared<CaptureLogger>();
+  {
+    auto logger = std::make_shared<AsyncLogger>(capture);
+    Logger::SetLogger(logger);
+    for (int i = 0; i < 1000; i++) {
+      DIDAGLE_ERROR("error {}", i);
+    }
+    Logger::SetLogger(nullptr);
+    ASSERT_EQ(logger->GetDroppedCount(), 0u);
+  }
+  ASSERT_EQ(capture->msgs.size(), 1000u);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(capture->msgs[i], "error " + std::to_string(i));
+  }
+
+  AsyncLogger dropping(capture, 0);
+  dropping.Log(spdlog::source_loc{}, spdlog::level::err, "dropped");
+  ASSERT_EQ(dropping.GetDroppedCount(), 1u);
+}
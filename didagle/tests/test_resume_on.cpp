@@ -0,0 +1,107 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "folly/executors/CPUThreadPoolExecutor.h"
+#include "folly/futures/Future.h"
+#include "folly/system/ThreadName.h"
+
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+#include "didagle/trace/histogram.h"
+using namespace didagle;
+
+static folly::CPUThreadPoolExecutor* get_io_executor() {
+  static folly::CPUThreadPoolExecutor executor(2, std::make_shared<folly::NamedThreadFactory>("resume_io"));
+  return &executor;
+}
+static std::string g_resume_thread;
+
+GRAPH_FUTURE_OP_BEGIN(resume_future)
+GRAPH_OP_OUTPUT(int, resume_a)
+folly::Future<int> OnFutureExecute(const Params& args) override {
+  return folly::via(get_io_executor(), [this]() {
+    resume_a = 1;
+    return 0;
+  });
+}
+GRAPH_OP_END
+
+GRAPH_OP_BEGIN(resume_sink)
+GRAPH_OP_INPUT(int, resume_a)
+GRAPH_OP_OUTPUT(int, resume_b)
+int OnExecute(const Params& args) override {
+  resume_b = nullptr != resume_a ? *resume_a + 1 : -1;
+  g_resume_thread = folly::getCurrentThreadName().value_or("");
+  return 0;
+}
+GRAPH_OP_END
+
+static std::string get_resume_graph(const std::string& cluster, const std::string& resume_on) {
+  return R"(
+name=")" + cluster + R"("
+[[graph]]
+name="test"
+resume_on=")" + resume_on + R"("
+[[graph.vertex]]
+id = "future"
+processor = "resume_future"
+[[graph.vertex]]
+id = "sink"
+processor = "resume_sink"
+  )";
+}
+
+static uint64_t get_resume_hop_count(TestContext& ctx, const std::string& cluster) {
+  std::vector<VertexLatencySnapshot> snapshots;
+  ctx.store->GetVertexLatencyStats(cluster, snapshots);
+  for (const auto& snapshot : snapshots) {
+    if (snapshot.vertex == "future") {
+      return snapshot.phases[VERTEX_LATENCY_RESUME_HOP].count;
+    }
+  }
+  return 0;
+}
+
+TEST(ResumeOn, inline) {
+  TestContext ctx(4, [](GraphExecuteOptions& opt) { opt.vertex_latency_stats = true; });
+  ASSERT_TRUE(ctx.store->LoadString(get_resume_graph("test_inline", "inline")) != nullptr);
+  for (int i = 0; i < 10; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test_inline", "test"), 0);
+    ASSERT_EQ(*data_ctx->Get<int>("resume_b"), 2);
+    ASSERT_EQ(g_resume_thread.rfind("resume_io", 0), 0u);
+  }
+  ASSERT_EQ(get_resume_hop_count(ctx, "test_inline"), 0u);
+}
+
+TEST(ResumeOn, cpu) {
+  folly::CPUThreadPoolExecutor cpu_executor(2, std::make_shared<folly::NamedThreadFactory>("resume_cpu"));
+  TestContext ctx(4, [&](GraphExecuteOptions& opt) {
+    opt.vertex_latency_stats = true;
+    opt.cpu_executor = [&](AnyClosure&& r) { cpu_executor.add(std::move(r)); };
+  });
+  ASSERT_TRUE(ctx.store->LoadString(get_resume_graph("test_cpu", "cpu")) != nullptr);
+  for (int i = 0; i < 10; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test_cpu", "test"), 0);
+    ASSERT_EQ(*data_ctx->Get<int>("resume_b"), 2);
+    ASSERT_EQ(g_resume_thread.rfind("resume_cpu", 0), 0u);
+  }
+  ASSERT_EQ(get_resume_hop_count(ctx, "test_cpu"), 10u);
+}
+
+TEST(ResumeOn, graph) {
+  TestContext ctx(4, [](GraphExecuteOptions& opt) { opt.vertex_latency_stats = true; });
+  ASSERT_TRUE(ctx.store->LoadString(get_resume_graph("test_graph", "graph")) != nullptr);
+  for (int i = 0; i < 10; i++) {
+    auto data_ctx = GraphDataContext::New();
+    ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test_graph", "test"), 0);
+    ASSERT_EQ(g_resume_thread.rfind("didagle_test", 0), 0u);
+  }
+  ASSERT_EQ(get_resume_hop_count(ctx, "test_graph"), 10u);
+}
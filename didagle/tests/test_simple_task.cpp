@@ -29,6 +29,7 @@
 ** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <gtest/gtest.h>
+#include <unistd.h>
 #include <vector>
 
 #include "didagle/tests/test_common.h"
@@ -128,3 +129,120 @@ TEST(Task, if_else) {
   ASSERT_EQ(rc, 0);
   ASSERT_EQ(counter, 100);
 }
+
+static TaskGroupPtr new_chain_group(int& counter, int step) {
+  auto group = TaskGroup::New();
+  auto a = group->Add([&counter, step](const Params& args) -> int {
+    counter += step;
+    return 0;
+  });
+  auto sub = TaskGroup::New();
+  sub->Add([&counter, step](const Params& args) -> int {
+    counter += step * 10;
+    return 0;
+  });
+  auto b = group->Add(sub);
+  a->Precede(b);
+  return group;
+}
+
+TEST(Task, cached_structure) {
+  TestContext ctx;
+  int counter0 = 0;
+  int counter1 = 0;
+  auto group0 = new_chain_group(counter0, 1);
+  auto group1 = new_chain_group(counter1, 2);
+  ASSERT_EQ(group0->ClusterId(), group1->ClusterId());
+  ASSERT_NE(group0->Id(), group1->Id());
+
+  ASSERT_EQ(0, ctx.store->SyncExecute(group0));
+  auto cluster = ctx.store->FindGraphClusterByName(group0->ClusterId());
+  ASSERT_TRUE(cluster != nullptr);
+  ASSERT_EQ(0, ctx.store->SyncExecute(group1));
+  // compiled once, functions are bound per execution
+  ASSERT_EQ(cluster.get(), ctx.store->FindGraphClusterByName(group1->ClusterId()).get());
+  ASSERT_EQ(counter0, 11);
+  ASSERT_EQ(counter1, 22);
+
+  auto group2 = new_chain_group(counter0, 1);
+  group2->Add([](const Params& args) -> int { return 0; });
+  ASSERT_NE(group0->ClusterId(), group2->ClusterId());
+}
+
+TEST(Task, bind_params) {
+  TestContext ctx;
+  auto group = TaskGroup::New();
+  int64_t value = 0;
+  group->Add([&](const Params& args) -> int {
+    value = args["k"].Int();
+    return 0;
+  });
+  auto params = std::make_shared<Params>();
+  params->Put("k", static_cast<int64_t>(7));
+  ASSERT_EQ(0, ctx.store->SyncExecute(group, GraphDataContext::New(), params));
+  ASSERT_EQ(value, 7);
+}
+
+TEST(Task, cluster_limit) {
+  TestContext ctx(4, [](GraphExecuteOptions& opt) { opt.task_group_cluster_limit = 2; });
+  int counter = 0;
+  // groups with 0, 1 & 2 extra tasks have different structures
+  auto new_group = [&](int extra) {
+    auto group = new_chain_group(counter, 1);
+    for (int i = 0; i < extra; i++) {
+      group->Add([](const Params& args) -> int { return 0; });
+    }
+    return group;
+  };
+  auto group0 = new_group(0);
+  auto group1 = new_group(1);
+  auto group2 = new_group(2);
+  ASSERT_EQ(0, ctx.store->SyncExecute(group0));
+  ASSERT_EQ(0, ctx.store->SyncExecute(group1));
+  // 'group0' is used more recently than 'group1'
+  usleep(1000);
+  ASSERT_EQ(0, ctx.store->SyncExecute(group0));
+  ASSERT_EQ(0, ctx.store->SyncExecute(group2));
+
+  TaskGroupClusterStats stats;
+  ctx.store->GetTaskGroupClusterStats(stats);
+  ASSERT_EQ(stats.clusters, 2u);
+  ASSERT_EQ(stats.compiled, 3u);
+  ASSERT_EQ(stats.evicted, 1u);
+  ASSERT_TRUE(ctx.store->FindGraphClusterByName(group0->ClusterId()) != nullptr);
+  ASSERT_TRUE(ctx.store->FindGraphClusterByName(group1->ClusterId()) == nullptr);
+  ASSERT_TRUE(ctx.store->FindGraphClusterByName(group2->ClusterId()) != nullptr);
+
+  // evicted structure is compiled again on demand
+  counter = 0;
+  ASSERT_EQ(0, ctx.store->SyncExecute(group1));
+  ASSERT_EQ(counter, 11);
+  ctx.store->GetTaskGroupClusterStats(stats);
+  ASSERT_EQ(stats.clusters, 2u);
+  ASSERT_EQ(stats.compiled, 4u);
+  ASSERT_EQ(stats.evicted, 2u);
+}
+
+TEST(Task, clone_from_other_group) {
+  TestContext ctx;
+  int counter = 0;
+  auto group0 = TaskGroup::New();
+  group0->Add([&](const Params& args) -> int {
+    counter += 1;
+    return 0;
+  });
+  auto b = group0->Add([&](const Params& args) -> int {
+    counter += 10;
+    return 0;
+  });
+  auto group1 = TaskGroup::New();
+  auto c = group1->Add([&](const Params& args) -> int {
+    counter += 100;
+    return 0;
+  });
+  // runs the function of 'b', not the one at the same index of 'group1'
+  auto d = group1->Clone(b);
+  c->Precede(d);
+  ASSERT_EQ(0, ctx.store->SyncExecute(group1));
+  ASSERT_EQ(counter, 110);
+}
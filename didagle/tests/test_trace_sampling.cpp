@@ -0,0 +1,75 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string>
+
+#include "didagle/processor/api.h"
+#include "didagle/tests/test_common.h"
+using namespace didagle;
+
+GRAPH_OP_BEGIN(test_sleep)
+GRAPH_OP_OUTPUT(int64_t, sleep_result)
+GRAPH_PARAMS_int(sleep_ms, 0, "e");
+int OnExecute(const Params& args) override {
+  if (PARAMS_sleep_ms > 0) {
+    usleep(PARAMS_sleep_ms * 1000);
+  }
+  sleep_result = PARAMS_sleep_ms;
+  return 0;
+}
+GRAPH_OP_END
+
+TEST(TraceSampling, simple) {
+  std::string content = R"(
+name="test"
+trace_slow_threshold_ms = 5
+[[graph]]
+name="sampled"
+trace_sample_rate = 1.0
+[[graph.vertex]]
+processor = "test_sleep"
+start = true
+[[graph]]
+name="fast"
+[[graph.vertex]]
+processor = "test_sleep"
+start = true
+[[graph]]
+name="slow"
+[[graph.vertex]]
+processor = "test_sleep"
+args = { sleep_ms = 20 }
+start = true
+  )";
+  TestContext ctx;
+  auto handle = ctx.store->LoadString(content);
+  ASSERT_TRUE(handle != nullptr);
+
+  auto data_ctx = GraphDataContext::New();
+  ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test", "sampled"), 0);
+  ASSERT_TRUE(data_ctx->GetEventTracker() != nullptr);
+  ASSERT_EQ(data_ctx->GetEventTracker()->sample_reason, SAMPLE_BY_RATE);
+  size_t events = 0;
+  data_ctx->GetEventTracker()->Visit([&](const DAGEvent& event) { events++; });
+  ASSERT_GT(events, 0u);
+
+  // buffered events of fast requests are dropped
+  data_ctx = GraphDataContext::New();
+  ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test", "fast"), 0);
+  ASSERT_TRUE(data_ctx->GetEventTracker() == nullptr);
+
+  data_ctx = GraphDataContext::New();
+  ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test", "slow"), 0);
+  ASSERT_TRUE(data_ctx->GetEventTracker() != nullptr);
+  ASSERT_EQ(data_ctx->GetEventTracker()->sample_reason, SAMPLE_BY_LATENCY);
+
+  // tracker enabled by caller is left as it is
+  data_ctx = GraphDataContext::New();
+  data_ctx->EnableEventTracker();
+  ASSERT_EQ(ctx.store->SyncExecute(data_ctx, "test", "fast"), 0);
+  ASSERT_TRUE(data_ctx->GetEventTracker() != nullptr);
+  ASSERT_EQ(data_ctx->GetEventTracker()->sample_reason, SAMPLE_BY_CALLER);
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include <stdio.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "didagle/graph/graph_plan.h"
+#include "didagle/store/graph_store.h"
+
+using namespace didagle;
+
+static std::string get_basename(const std::string& filename) {
+  std::string::size_type pos = filename.rfind('/');
+  if (pos != std::string::npos) {
+    return filename.substr(pos + 1);
+  }
+  return filename;
+}
+
+// usage: graph_compile <plan_file> <toml_file>...
+// link with all processors used by the DSL files, every DSL is parsed once & the written plan is validated by a
+// full load of all its clusters.
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("Usage: %s <plan_file> <toml_file>...\n", argv[0]);
+    return -1;
+  }
+  std::string plan_file = argv[1];
+  std::vector<std::unique_ptr<GraphCluster>> clusters;
+  std::vector<const GraphCluster*> cluster_refs;
+  for (int i = 2; i < argc; i++) {
+    std::string file = argv[i];
+    auto cluster = std::make_unique<GraphCluster>();
+    if (!kcfg::ParseFromTomlFile(file, *cluster)) {
+      printf("[ERROR]Failed to parse DSL file:%s\n", file.c_str());
+      return -1;
+    }
+    cluster->_name = get_basename(file);
+    cluster_refs.emplace_back(cluster.get());
+    clusters.emplace_back(std::move(cluster));
+  }
+  if (0 != write_graph_plan_file(cluster_refs, plan_file)) {
+    printf("[ERROR]Failed to write graph plan file:%s\n", plan_file.c_str());
+    return -1;
+  }
+  GraphExecuteOptions options;
+  GraphStore store(options);
+  if (0 != store.LoadPlan(plan_file)) {
+    printf("[ERROR]Failed to load graph plan file:%s\n", plan_file.c_str());
+    unlink(plan_file.c_str());
+    return -1;
+  }
+  printf("Compiled %zu clusters into graph plan:%s\n", cluster_refs.size(), plan_file.c_str());
+  return 0;
+}
@@ -0,0 +1,355 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include "didagle/trace/chrome_trace.h"
+#include <stdio.h>
+#include <algorithm>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace didagle {
+static constexpr int kThreadsPid = 1;
+static constexpr int kGraphPid = 2;
+
+void append_json_string(std::string& json, std::string_view s) {
+  json.push_back('"');
+  for (char c : s) {
+    switch (c) {
+      case '"': {
+        json.append("\\\"");
+        break;
+      }
+      case '\\': {
+        json.append("\\\\");
+        break;
+      }
+      case '\n': {
+        json.append("\\n");
+        break;
+      }
+      case '\t': {
+        json.append("\\t");
+        break;
+      }
+      default: {
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          json.append(buf);
+        } else {
+          json.push_back(c);
+        }
+        break;
+      }
+    }
+  }
+  json.push_back('"');
+}
+
+namespace {
+class ChromeTraceWriter {
+ public:
+  ChromeTraceWriter(std::string& json, uint64_t base_ustime) : _json(json), _base_ustime(base_ustime) {}
+  void Begin() { _json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["); }
+  void End() { _json.append("]}\n"); }
+
+  void Meta(std::string_view name, int pid, uint32_t tid, std::string_view value) {
+    Open("M", name, {}, pid, tid);
+    _json.append(",\"args\":{\"name\":");
+    append_json_string(_json, value);
+    _json.append("}}");
+  }
+  void Slice(const DAGEventRecord& record, int pid, uint32_t tid) {
+    Open("X", SliceName(record), get_dag_phase_name(record.phase), pid, tid);
+    Time("ts", record.start_ustime - _base_ustime);
+    Time("dur", record.end_ustime - record.start_ustime);
+    _json.append(",\"args\":{");
+    bool first = true;
+    auto arg = [&](std::string_view key, uint32_t name_id) {
+      if (0 == name_id) {
+        return;
+      }
+      if (!first) {
+        _json.push_back(',');
+      }
+      first = false;
+      append_json_string(_json, key);
+      _json.push_back(':');
+      append_json_string(_json, TraceNameTable::Get(name_id));
+    };
+    arg("vertex", record.vertex);
+    arg("cluster", record.cluster);
+    arg("graph", record.graph);
+    arg("matched_cond", record.matched_cond);
+    if (PhaseType::DAG_PHASE_UNKNOWN == record.phase) {
+      _json.append(first ? "" : ",").append("\"rc\":").append(std::to_string(record.rc));
+      _json.append(",\"code\":").append(std::to_string(record.code));
+    }
+    _json.append("}}");
+  }
+  void Instant(std::string_view name, std::string_view cat, int pid, uint32_t tid, uint64_t ustime) {
+    Open("X", name, cat, pid, tid);
+    Time("ts", ustime - _base_ustime);
+    Time("dur", 0);
+    _json.push_back('}');
+  }
+  void Async(const DAGEventRecord& record, uint64_t id) {
+    std::string_view vertex = TraceNameTable::Get(record.vertex);
+    std::string_view cat = get_dag_phase_name(record.phase);
+    Open("b", vertex, cat, kThreadsPid, record.thread_id);
+    Time("ts", record.start_ustime - _base_ustime);
+    _json.append(",\"id\":").append(std::to_string(id));
+    _json.append(",\"args\":{\"queue_depth\":").append(std::to_string(record.queue_depth)).append("}}");
+    Open("e", vertex, cat, kThreadsPid, record.thread_id);
+    Time("ts", record.end_ustime - _base_ustime);
+    _json.append(",\"id\":").append(std::to_string(id)).push_back('}');
+  }
+  void Flow(std::string_view ph, uint64_t id, uint32_t tid, uint64_t ustime) {
+    Open(ph, "dispatch", "dispatch", kThreadsPid, tid);
+    Time("ts", ustime - _base_ustime);
+    _json.append(",\"id\":").append(std::to_string(id)).push_back('}');
+  }
+
+ private:
+  std::string& _json;
+  uint64_t _base_ustime = 0;
+  bool _first = true;
+
+  static std::string_view SliceName(const DAGEventRecord& record) {
+    if (0 != record.processor) {
+      return TraceNameTable::Get(record.processor);
+    }
+    if (0 != record.full_graph_name) {
+      return TraceNameTable::Get(record.full_graph_name);
+    }
+    return get_dag_phase_name(record.phase);
+  }
+  void Open(std::string_view ph, std::string_view name, std::string_view cat, int pid, uint32_t tid) {
+    if (!_first) {
+      _json.push_back(',');
+    }
+    _first = false;
+    _json.append("{\"ph\":");
+    append_json_string(_json, ph);
+    _json.append(",\"name\":");
+    append_json_string(_json, name);
+    if (!cat.empty()) {
+      _json.append(",\"cat\":");
+      append_json_string(_json, cat);
+    }
+    _json.append(",\"pid\":").append(std::to_string(pid));
+    _json.append(",\"tid\":").append(std::to_string(tid));
+  }
+  void Time(std::string_view key, uint64_t ustime) {
+    _json.append(",\"").append(key).append("\":").append(std::to_string(ustime));
+  }
+};
+
+struct LaneNode {
+  const DAGEventRecord* record = nullptr;
+  LaneNode* parent = nullptr;
+  std::vector<LaneNode*> children;
+  size_t lane = 0;
+  bool visited = false;
+};
+
+size_t mark_lane_nodes(LaneNode* node) {
+  size_t n = 1;
+  node->visited = true;
+  for (LaneNode* child : node->children) {
+    n += mark_lane_nodes(child);
+  }
+  return n;
+}
+
+// packs sibling nodes into lanes by time, every node takes as many lanes as its children need & the lanes of
+// children are relative to their parent, returns the number of lanes used
+size_t pack_lanes(std::vector<LaneNode*>& siblings) {
+  std::stable_sort(siblings.begin(), siblings.end(), [](const LaneNode* a, const LaneNode* b) {
+    if (a->record->start_ustime != b->record->start_ustime) {
+      return a->record->start_ustime < b->record->start_ustime;
+    }
+    return a->record->end_ustime > b->record->end_ustime;
+  });
+  // end time of the last node placed on every lane
+  std::vector<uint64_t> lane_ends;
+  std::vector<size_t> heights(siblings.size());
+  for (size_t i = 0; i < siblings.size(); i++) {
+    heights[i] = std::max<size_t>(1, pack_lanes(siblings[i]->children));
+  }
+  for (size_t i = 0; i < siblings.size(); i++) {
+    LaneNode* node = siblings[i];
+    size_t lane = 0;
+    for (;; lane++) {
+      size_t end = std::min(lane + heights[i], lane_ends.size());
+      bool free = true;
+      for (size_t j = lane; j < end; j++) {
+        if (lane_ends[j] > node->record->start_ustime) {
+          free = false;
+          break;
+        }
+      }
+      if (free) {
+        break;
+      }
+    }
+    if (lane_ends.size() < lane + heights[i]) {
+      lane_ends.resize(lane + heights[i], 0);
+    }
+    for (size_t j = lane; j < lane + heights[i]; j++) {
+      lane_ends[j] = node->record->end_ustime;
+    }
+    node->lane = lane;
+  }
+  return lane_ends.size();
+}
+
+// children were packed relative to lane 0, move them under the lane of their parent
+void offset_lanes(LaneNode* node) {
+  for (LaneNode* child : node->children) {
+    child->lane += node->lane;
+    offset_lanes(child);
+  }
+}
+}  // namespace
+
+void write_chrome_trace(const DAGEventTracker& tracker, std::string& json) {
+  std::vector<DAGEventRecord> records;
+  uint64_t base_ustime = UINT64_MAX;
+  tracker.VisitRecords([&](const DAGEventRecord& record) {
+    // vertexs skipped before execution have no start time
+    if (0 == record.start_ustime || record.end_ustime < record.start_ustime) {
+      return;
+    }
+    records.emplace_back(record);
+    base_ustime = std::min(base_ustime, record.start_ustime);
+  });
+  ChromeTraceWriter writer(json, records.empty() ? 0 : base_ustime);
+  writer.Begin();
+  writer.Meta("process_name", kThreadsPid, 0, "threads");
+  std::set<uint32_t> threads;
+  for (const DAGEventRecord& record : records) {
+    threads.insert(record.thread_id);
+    if (0 != record.dispatch_thread_id) {
+      threads.insert(record.dispatch_thread_id);
+    }
+  }
+  for (uint32_t tid : threads) {
+    writer.Meta("thread_name", kThreadsPid, tid, "thread-" + std::to_string(tid));
+  }
+
+  std::set<std::pair<uint32_t, uint64_t>> dispatches;
+  uint64_t flow_id = 0;
+  uint64_t async_id = 0;
+  for (const DAGEventRecord& record : records) {
+    if (PhaseType::DAG_PHASE_VERTEX_READY_WAIT == record.phase ||
+        PhaseType::DAG_PHASE_OP_RESUME_HOP == record.phase) {
+      // waiting is not bound to any thread, show it as async slice
+      writer.Async(record, ++async_id);
+      continue;
+    }
+    if (PhaseType::DAG_PHASE_CONCURRENT_SCHED != record.phase) {
+      writer.Slice(record, kThreadsPid, record.thread_id);
+      continue;
+    }
+    if (0 == record.dispatch_thread_id) {
+      continue;
+    }
+    // flow start binds to the enclosing slice, add a zero length slice at every dispatch point
+    if (dispatches.emplace(record.dispatch_thread_id, record.start_ustime).second) {
+      writer.Instant("dispatch", get_dag_phase_name(record.phase), kThreadsPid, record.dispatch_thread_id,
+                     record.start_ustime);
+    }
+    // flow end binds to the next slice on the target thread, which is the prepare/execute of the vertex
+    flow_id++;
+    writer.Flow("s", flow_id, record.dispatch_thread_id, record.start_ustime);
+    writer.Flow("f", flow_id, record.thread_id, record.end_ustime);
+  }
+
+  // vertex executions laid out as a tree by 'child_scope' -> 'scope', a subgraph vertex reserves as many lanes as its
+  // subgraph needs and vertexs of the subgraph nest under it, time is only used to pack siblings into lanes
+  std::vector<LaneNode> nodes;
+  for (const DAGEventRecord& record : records) {
+    if (PhaseType::DAG_PHASE_UNKNOWN == record.phase) {
+      nodes.emplace_back();
+      nodes.back().record = &record;
+    }
+  }
+  std::unordered_map<uint64_t, std::vector<LaneNode*>> subgraph_vertexs;
+  for (LaneNode& node : nodes) {
+    if (0 != node.record->child_scope) {
+      subgraph_vertexs[node.record->child_scope].emplace_back(&node);
+    }
+  }
+  for (LaneNode& node : nodes) {
+    auto found = subgraph_vertexs.find(node.record->scope);
+    if (found == subgraph_vertexs.end()) {
+      continue;
+    }
+    // a subgraph context may run more than once in a request, pick the run enclosing the vertex
+    LaneNode* parent = found->second[0];
+    for (LaneNode* candidate : found->second) {
+      if (candidate->record->start_ustime <= node.record->start_ustime &&
+          candidate->record->end_ustime >= node.record->start_ustime) {
+        parent = candidate;
+        break;
+      }
+    }
+    if (parent != &node) {
+      node.parent = parent;
+      parent->children.emplace_back(&node);
+    }
+  }
+  std::vector<LaneNode*> roots;
+  for (LaneNode& node : nodes) {
+    if (nullptr == node.parent) {
+      roots.emplace_back(&node);
+    }
+  }
+  // scopes are addresses of pooled contexts, break any cycle so that every vertex is reachable from roots
+  size_t visited = 0;
+  for (LaneNode* root : roots) {
+    visited += mark_lane_nodes(root);
+  }
+  for (LaneNode& node : nodes) {
+    if (visited == nodes.size()) {
+      break;
+    }
+    if (node.visited) {
+      continue;
+    }
+    auto& siblings = node.parent->children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), &node));
+    node.parent = nullptr;
+    roots.emplace_back(&node);
+    visited += mark_lane_nodes(&node);
+  }
+  size_t lane_count = pack_lanes(roots);
+  for (LaneNode* root : roots) {
+    offset_lanes(root);
+  }
+  writer.Meta("process_name", kGraphPid, 0, "graph");
+  for (size_t lane = 0; lane < lane_count; lane++) {
+    writer.Meta("thread_name", kGraphPid, static_cast<uint32_t>(lane + 1), "lane-" + std::to_string(lane));
+  }
+  for (const LaneNode& node : nodes) {
+    writer.Slice(*node.record, kGraphPid, static_cast<uint32_t>(node.lane + 1));
+  }
+  writer.End();
+}
+
+int write_chrome_trace_file(const DAGEventTracker& tracker, const std::string& file) {
+  std::string json;
+  write_chrome_trace(tracker, json);
+  FILE* fp = fopen(file.c_str(), "w");
+  if (nullptr == fp) {
+    return -1;
+  }
+  size_t n = fwrite(json.data(), 1, json.size(), fp);
+  int rc = fclose(fp);
+  return (n == json.size() && 0 == rc) ? 0 : -1;
+}
+
+}  // namespace didagle
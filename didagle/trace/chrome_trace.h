@@ -0,0 +1,32 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#pragma once
+#include <string>
+#include <string_view>
+
+#include "didagle/trace/event.h"
+
+namespace didagle {
+
+/**
+ * @brief Append 's' as quoted & escaped JSON string.
+ */
+void append_json_string(std::string& json, std::string_view s);
+
+/**
+ * @brief Render records of a request as Chrome Trace Event JSON, which could be opened by 'chrome://tracing'
+ * or 'ui.perfetto.dev'.
+ * Process 'threads' shows every phase on the thread it ran, with flow arrows from the dispatching thread to
+ * concurrently scheduled vertexs and async slices for ready to start waits; process 'graph' lays out vertex
+ * executions on nested lanes so that vertexs of a subgraph(matched by 'child_scope' -> 'scope') are sliced under the
+ * subgraph vertex, time is only used to pack siblings of the same graph into lanes.
+ * Events added by the legacy 'DAGEventTracker::Add(std::unique_ptr<DAGEvent>&&)' are not included.
+ */
+void write_chrome_trace(const DAGEventTracker& tracker, std::string& json);
+
+/**
+ * @brief Same as 'write_chrome_trace' while writing into local file, return -1 if the file could not be written.
+ */
+int write_chrome_trace_file(const DAGEventTracker& tracker, const std::string& file);
+
+}  // namespace didagle
@@ -28,6 +28,10 @@
  */
 #include "didagle/trace/event.h"
 #include <array>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 namespace didagle {
 template <size_t N>
 static constexpr std::string_view sv(const char (&literal)[N]) {
@@ -40,8 +44,155 @@ static constexpr std::array<std::string_view, sizeof...(N)> sva(const char (&...
 }
 
 constexpr auto kPhases =
-    sva("unknown", "concurrency_sched", "prepare_execute", "post_execute", "graph_reset", "graph_prepare_execute");
+    sva("unknown", "concurrency_sched", "prepare_execute", "post_execute", "graph_reset", "graph_prepare_execute",
+        "ready_wait", "resume_hop");
 
 std::string_view get_dag_phase_name(PhaseType phase) { return kPhases[static_cast<int>(phase)]; }
 
+namespace {
+struct TraceNames {
+  std::shared_mutex mutex;
+  std::unordered_map<std::string_view, uint32_t> ids;
+  std::deque<std::string> names;
+};
+// never destroyed since records may be exported during static destruction
+TraceNames& GetTraceNames() {
+  static TraceNames* names = new TraceNames;
+  return *names;
+}
+
+struct DAGEventChunkPool {
+  static constexpr size_t kMaxCachedChunks = 32;
+  std::vector<DAGEventChunk*> chunks;
+  ~DAGEventChunkPool() {
+    for (DAGEventChunk* chunk : chunks) {
+      delete chunk;
+    }
+  }
+};
+thread_local DAGEventChunkPool tls_chunk_pool;
+}  // namespace
+
+uint32_t get_trace_thread_id() {
+  static std::atomic<uint32_t> next_id{1};
+  thread_local uint32_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+
+uint32_t TraceNameTable::Intern(std::string_view name) {
+  if (name.empty()) {
+    return 0;
+  }
+  TraceNames& table = GetTraceNames();
+  {
+    std::shared_lock<std::shared_mutex> guard(table.mutex);
+    auto found = table.ids.find(name);
+    if (found != table.ids.end()) {
+      return found->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> guard(table.mutex);
+  auto found = table.ids.find(name);
+  if (found != table.ids.end()) {
+    return found->second;
+  }
+  table.names.emplace_back(name);
+  uint32_t id = static_cast<uint32_t>(table.names.size());
+  table.ids.emplace(table.names.back(), id);
+  return id;
+}
+std::string_view TraceNameTable::Get(uint32_t id) {
+  if (0 == id) {
+    return {};
+  }
+  TraceNames& table = GetTraceNames();
+  std::shared_lock<std::shared_mutex> guard(table.mutex);
+  if (id > table.names.size()) {
+    return {};
+  }
+  return table.names[id - 1];
+}
+
+DAGEventChunk* DAGEventChunk::Acquire() {
+  std::vector<DAGEventChunk*>& cached = tls_chunk_pool.chunks;
+  DAGEventChunk* chunk = nullptr;
+  if (!cached.empty()) {
+    chunk = cached.back();
+    cached.pop_back();
+  } else {
+    chunk = new DAGEventChunk;
+  }
+  chunk->claimed.store(0, std::memory_order_relaxed);
+  chunk->next = nullptr;
+  for (auto& ready : chunk->ready) {
+    ready.store(0, std::memory_order_relaxed);
+  }
+  return chunk;
+}
+void DAGEventChunk::Release(DAGEventChunk* chunk) {
+  std::vector<DAGEventChunk*>& cached = tls_chunk_pool.chunks;
+  if (cached.size() < DAGEventChunkPool::kMaxCachedChunks) {
+    cached.emplace_back(chunk);
+  } else {
+    delete chunk;
+  }
+}
+
+DAGEventChunk* DAGEventTracker::NewChunk(DAGEventChunk* current) {
+  DAGEventChunk* chunk = DAGEventChunk::Acquire();
+  chunk->next = current;
+  if (_chunks.compare_exchange_strong(current, chunk, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    return chunk;
+  }
+  // another thread installed a new chunk, 'current' is updated to it
+  DAGEventChunk::Release(chunk);
+  return current;
+}
+void DAGEventTracker::ReleaseChunks() {
+  DAGEventChunk* chunk = _chunks.exchange(nullptr, std::memory_order_acq_rel);
+  while (nullptr != chunk) {
+    DAGEventChunk* next = chunk->next;
+    DAGEventChunk::Release(chunk);
+    chunk = next;
+  }
+}
+void DAGEventTracker::ToDAGEvent(const DAGEventRecord& record, DAGEvent& event) {
+  event.processor = TraceNameTable::Get(record.processor);
+  event.cluster = TraceNameTable::Get(record.cluster);
+  event.graph = TraceNameTable::Get(record.graph);
+  event.full_graph_name = TraceNameTable::Get(record.full_graph_name);
+  event.matched_cond = TraceNameTable::Get(record.matched_cond);
+  event.vertex = TraceNameTable::Get(record.vertex);
+  event.thread_id = record.thread_id;
+  event.dispatch_thread_id = record.dispatch_thread_id;
+  event.scope = record.scope;
+  event.child_scope = record.child_scope;
+  event.phase = record.phase;
+  event.start_ustime = record.start_ustime;
+  event.end_ustime = record.end_ustime;
+  event.rc = record.rc;
+  event.code = record.code;
+  event.queue_depth = record.queue_depth;
+}
+void DAGEventTracker::Sweep(SweepFunc&& f) {
+  VisitRecords([&](const DAGEventRecord& record) {
+    auto event = std::make_unique<DAGEvent>();
+    ToDAGEvent(record, *event);
+    if (f(event.get()) == STATUS_KEEP) {
+      event.release();
+    }
+  });
+  ReleaseChunks();
+  events.sweep([f = std::move(f)](DAGEvent* event) {
+    auto status = f(event);
+    if (status != STATUS_KEEP) {
+      delete event;
+    }
+  });
+}
+DAGEventTracker::~DAGEventTracker() {
+  ReleaseChunks();
+  events.sweep([](DAGEvent* event) { delete event; });
+}
+
 }  // namespace didagle
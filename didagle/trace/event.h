@@ -47,6 +47,10 @@ enum class PhaseType {
   DAG_PHASE_OP_POST_EXECUTE,
   DAG_PHASE_GRAPH_ASYNC_RESET,
   DAG_GRAPH_GRAPH_PREPARE_EXECUTE,
+  // from all dependencies of a vertex done to the vertex started
+  DAG_PHASE_VERTEX_READY_WAIT,
+  // from the future of an async processor fulfilled to the vertex resumed on the executor of 'resume_on'
+  DAG_PHASE_OP_RESUME_HOP,
 };
 
 struct DAGEvent {
@@ -55,38 +59,167 @@ struct DAGEvent {
   std::string_view graph;
   std::string_view full_graph_name;
   std::string_view matched_cond;
+  std::string_view vertex;
 
   PhaseType phase{PhaseType::DAG_PHASE_UNKNOWN};
   uint64_t start_ustime = 0;
   uint64_t end_ustime = 0;
   int rc = -1;
+  // code of vertex after applying 'ignore_processor_execute_error', 0 for success
+  int code = 0;
+  // queue depth of 'async_executor' when the vertex was dispatched, -1 if not sampled
+  int32_t queue_depth = -1;
+  // ids from 'get_trace_thread_id', 'dispatch_thread_id' is the thread scheduled a concurrent vertex
+  uint32_t thread_id = 0;
+  uint32_t dispatch_thread_id = 0;
+  // opaque id of the running graph, 'child_scope' is the scope of the subgraph executed by a vertex
+  uint64_t scope = 0;
+  uint64_t child_scope = 0;
 
   folly::AtomicIntrusiveLinkedListHook<DAGEvent> _hook;
   using List = folly::AtomicIntrusiveLinkedList<DAGEvent, &DAGEvent::_hook>;
 };
 
+/**
+ * @brief Process wide registry of names referenced by trace records, ids are stable & never released.
+ * Names are interned at setup time, and only resolved back when events are exported.
+ */
+class TraceNameTable {
+ public:
+  static uint32_t Intern(std::string_view name);
+  static std::string_view Get(uint32_t id);
+};
+
+/**
+ * @brief Fixed size binary form of DAGEvent, names are referenced by TraceNameTable ids(0 for empty).
+ */
+struct DAGEventRecord {
+  uint64_t start_ustime = 0;
+  uint64_t end_ustime = 0;
+  uint64_t scope = 0;
+  uint64_t child_scope = 0;
+  int32_t rc = -1;
+  int32_t code = 0;
+  int32_t queue_depth = -1;
+  uint32_t processor = 0;
+  uint32_t cluster = 0;
+  uint32_t graph = 0;
+  uint32_t full_graph_name = 0;
+  uint32_t matched_cond = 0;
+  uint32_t vertex = 0;
+  uint32_t thread_id = 0;  // filled by 'DAGEventTracker::Add' if not set
+  uint32_t dispatch_thread_id = 0;
+  PhaseType phase{PhaseType::DAG_PHASE_UNKNOWN};
+};
+
+/**
+ * @brief Small sequential id of current thread(start from 1), used to lay out trace events by thread.
+ */
+uint32_t get_trace_thread_id();
+
+/**
+ * @brief Preallocated block of trace records, blocks are recycled through a per thread pool.
+ */
+struct DAGEventChunk {
+  static constexpr uint32_t kCapacity = 64;
+  std::atomic<uint32_t> claimed{0};
+  DAGEventChunk* next = nullptr;
+  std::atomic<uint8_t> ready[kCapacity];
+  DAGEventRecord records[kCapacity];
+
+  static DAGEventChunk* Acquire();
+  static void Release(DAGEventChunk* chunk);
+};
+
 enum EventReportStatus {
   STATUS_NORMAL = 0,
   STATUS_KEEP,  // keep by event reporter
 };
 
+enum EventSampleReason {
+  SAMPLE_BY_CALLER = 0,  // enabled by caller via 'EnableEventTracker'
+  SAMPLE_BY_RATE,
+  SAMPLE_BY_LATENCY,  // unsampled request kept since it's slower than 'trace_slow_threshold_ms'
+  SAMPLE_BY_FLIGHT_RECORDER,  // enabled for 'GraphExecuteOptions::flight_recorder_size', dropped after execution
+};
+
 struct DAGEventTracker {
   using SweepFunc = std::function<EventReportStatus(DAGEvent*)>;
   DAGEvent::List events;
+  EventSampleReason sample_reason = SAMPLE_BY_CALLER;
   DAGEventTracker() {}
   inline void Add(std::unique_ptr<DAGEvent>&& event) { events.insertHead(event.release()); }
-  inline void Sweep(SweepFunc&& f) {
-    events.sweep([f = std::move(f)](DAGEvent* event) {
-      auto status = f(event);
-      if (status != STATUS_KEEP) {
-        delete event;
+  /**
+   * @brief copy record into the preallocated chunks, lock free & no allocation unless the chunk pool is empty.
+   */
+  inline void Add(const DAGEventRecord& record) {
+    DAGEventChunk* chunk = _chunks.load(std::memory_order_acquire);
+    while (true) {
+      if (nullptr != chunk) {
+        uint32_t idx = chunk->claimed.fetch_add(1, std::memory_order_relaxed);
+        if (idx < DAGEventChunk::kCapacity) {
+          DAGEventRecord& slot = chunk->records[idx];
+          slot = record;
+          if (0 == slot.thread_id) {
+            slot.thread_id = get_trace_thread_id();
+          }
+          chunk->ready[idx].store(1, std::memory_order_release);
+          return;
+        }
       }
-    });
+      chunk = NewChunk(chunk);
+    }
   }
-  ~DAGEventTracker() {
-    events.sweep([](DAGEvent* event) { delete event; });
+  /**
+   * @brief visit all records in insertion order of chunks, events added by legacy 'Add' are not included.
+   */
+  template <typename F>
+  void VisitRecords(F&& f) const;
+  /**
+   * @brief same as VisitRecords with names resolved, the event passed to 'f' is only valid during the call.
+   */
+  template <typename F>
+  void Visit(F&& f) const {
+    DAGEvent event;
+    VisitRecords([&](const DAGEventRecord& record) {
+      ToDAGEvent(record, event);
+      f(static_cast<const DAGEvent&>(event));
+    });
   }
+  /**
+   * @brief visit & release all events, records are materialized into heap events so that they could be kept.
+   */
+  void Sweep(SweepFunc&& f);
+  static void ToDAGEvent(const DAGEventRecord& record, DAGEvent& event);
+  ~DAGEventTracker();
+
+ private:
+  std::atomic<DAGEventChunk*> _chunks{nullptr};
+  DAGEventChunk* NewChunk(DAGEventChunk* current);
+  void ReleaseChunks();
 };
 
+template <typename F>
+void DAGEventTracker::VisitRecords(F&& f) const {
+  // chunks are linked from newest to oldest
+  std::vector<const DAGEventChunk*> chunks;
+  for (const DAGEventChunk* chunk = _chunks.load(std::memory_order_acquire); nullptr != chunk; chunk = chunk->next) {
+    chunks.emplace_back(chunk);
+  }
+  for (auto it = chunks.rbegin(); it != chunks.rend(); it++) {
+    const DAGEventChunk* chunk = *it;
+    uint32_t n = chunk->claimed.load(std::memory_order_acquire);
+    if (n > DAGEventChunk::kCapacity) {
+      n = DAGEventChunk::kCapacity;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+      if (0 == chunk->ready[i].load(std::memory_order_acquire)) {
+        continue;
+      }
+      f(chunk->records[i]);
+    }
+  }
+}
+
 std::string_view get_dag_phase_name(PhaseType phase);
-}  // namespace didagle
\ No newline at end of file
+}  // namespace didagle
@@ -0,0 +1,143 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#include "didagle/trace/histogram.h"
+#include <math.h>
+#include <algorithm>
+#include <string_view>
+
+namespace didagle {
+static uint32_t get_histogram_shard() {
+  static std::atomic<uint32_t> next_shard{0};
+  thread_local uint32_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % LatencyHistogram::kShardNum;
+  return shard;
+}
+
+LatencyHistogram::~LatencyHistogram() { delete[] _shards.load(std::memory_order_acquire); }
+
+LatencyHistogram::Shard* LatencyHistogram::GetShards() {
+  Shard* shards = _shards.load(std::memory_order_acquire);
+  if (nullptr != shards) {
+    return shards;
+  }
+  std::unique_ptr<Shard[]> created(new Shard[kShardNum]);
+  for (uint32_t i = 0; i < kShardNum; i++) {
+    Shard& shard = created[i];
+    shard.count.store(0, std::memory_order_relaxed);
+    shard.sum.store(0, std::memory_order_relaxed);
+    shard.max.store(0, std::memory_order_relaxed);
+    for (auto& bucket : shard.buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+  // the loser of a concurrent first record frees its shards
+  if (_shards.compare_exchange_strong(shards, created.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+    return created.release();
+  }
+  return shards;
+}
+
+uint32_t LatencyHistogram::BucketIndex(uint64_t value) {
+  if (value < kSubBucketNum) {
+    return static_cast<uint32_t>(value);
+  }
+  uint32_t exponent = 63 - __builtin_clzll(value);
+  if (exponent >= kMaxValueBits) {
+    return kBucketNum - 1;
+  }
+  uint32_t group = exponent - kSubBucketBits + 1;
+  uint32_t sub = static_cast<uint32_t>(value >> (exponent - kSubBucketBits)) & (kSubBucketNum - 1);
+  return group * kSubBucketNum + sub;
+}
+uint64_t LatencyHistogram::BucketLowerBound(uint32_t idx) {
+  uint32_t group = idx / kSubBucketNum;
+  uint64_t sub = idx % kSubBucketNum;
+  if (0 == group) {
+    return sub;
+  }
+  return (kSubBucketNum + sub) << (group - 1);
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+  Shard& shard = GetShards()[get_histogram_shard()];
+  shard.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  shard.count.fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max = shard.max.load(std::memory_order_relaxed);
+  while (value > max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot() const {
+  HistogramSnapshot snapshot;
+  snapshot.buckets.resize(kBucketNum);
+  const Shard* shards = _shards.load(std::memory_order_acquire);
+  if (nullptr == shards) {
+    return snapshot;
+  }
+  for (uint32_t i = 0; i < kShardNum; i++) {
+    const Shard& shard = shards[i];
+    snapshot.count += shard.count.load(std::memory_order_relaxed);
+    snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    snapshot.max = std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+    for (uint32_t j = 0; j < kBucketNum; j++) {
+      snapshot.buckets[j] += shard.buckets[j].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot& other) {
+  count += other.count;
+  sum += other.sum;
+  max = std::max(max, other.max);
+  if (buckets.size() < other.buckets.size()) {
+    buckets.resize(other.buckets.size());
+  }
+  for (size_t i = 0; i < other.buckets.size(); i++) {
+    buckets[i] += other.buckets[i];
+  }
+}
+double HistogramSnapshot::Mean() const {
+  if (0 == count) {
+    return 0;
+  }
+  return static_cast<double>(sum) / count;
+}
+uint64_t HistogramSnapshot::Percentile(double p) const {
+  if (0 == count) {
+    return 0;
+  }
+  // bucket counts are loaded after 'count' of each shard, use their own total
+  uint64_t total = 0;
+  for (uint64_t n : buckets) {
+    total += n;
+  }
+  uint64_t rank = static_cast<uint64_t>(ceil(std::clamp(p, 0.0, 100.0) / 100.0 * total));
+  if (0 == rank) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      uint64_t upper = LatencyHistogram::BucketLowerBound(static_cast<uint32_t>(i + 1)) - 1;
+      return std::min(upper, max);
+    }
+  }
+  return max;
+}
+
+void VertexLatencySnapshot::Merge(const VertexLatencySnapshot& other) {
+  for (int i = 0; i < VERTEX_LATENCY_PHASE_NUM; i++) {
+    phases[i].Merge(other.phases[i]);
+  }
+  dispatch_queue_depth.Merge(other.dispatch_queue_depth);
+}
+
+std::string_view get_vertex_latency_phase_name(VertexLatencyPhase phase) {
+  static constexpr std::string_view kNames[] = {"prepare", "execute", "post_execute", "queue_wait", "ready_wait",
+                                                "resume_hop"};
+  return kNames[phase];
+}
+
+}  // namespace didagle
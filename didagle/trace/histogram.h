@@ -0,0 +1,97 @@
+// Copyright (c) 2024, Tencent Inc.
+// All rights reserved.
+#pragma once
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace didagle {
+
+/**
+ * @brief Merged view of a LatencyHistogram, snapshots from different shards/processes could be merged.
+ */
+struct HistogramSnapshot {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+  std::vector<uint64_t> buckets;
+
+  void Merge(const HistogramSnapshot& other);
+  double Mean() const;
+  /**
+   * @brief estimated value at percentile 'p' in [0, 100], upper bound of the bucket clamped by 'max'.
+   */
+  uint64_t Percentile(double p) const;
+};
+
+/**
+ * @brief Log-linear histogram of microsecond values, each power of 2 range is split into 8 linear
+ * sub buckets(relative error < 12.5%). Recording is lock free & wait free except the 'max' update,
+ * writers are spread over cache line aligned shards by thread. The shards(about 9KB) are allocated
+ * on the first 'Record', so an unused histogram only costs a pointer.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t kSubBucketBits = 3;
+  static constexpr uint32_t kSubBucketNum = 1 << kSubBucketBits;
+  static constexpr uint32_t kMaxValueBits = 36;
+  static constexpr uint32_t kBucketNum = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketNum;
+  static constexpr uint32_t kShardNum = 4;
+
+  LatencyHistogram() = default;
+  ~LatencyHistogram();
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+  void Record(uint64_t value);
+  HistogramSnapshot Snapshot() const;
+
+  static uint32_t BucketIndex(uint64_t value);
+  static uint64_t BucketLowerBound(uint32_t idx);
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+    std::atomic<uint64_t> buckets[kBucketNum];
+  };
+  Shard* GetShards();
+  std::atomic<Shard*> _shards{nullptr};
+};
+
+enum VertexLatencyPhase {
+  VERTEX_LATENCY_PREPARE = 0,
+  VERTEX_LATENCY_EXECUTE,
+  VERTEX_LATENCY_POST_EXECUTE,
+  VERTEX_LATENCY_QUEUE_WAIT,
+  VERTEX_LATENCY_READY_WAIT,
+  VERTEX_LATENCY_RESUME_HOP,
+  VERTEX_LATENCY_PHASE_NUM,
+};
+
+struct VertexLatencyStats {
+  LatencyHistogram phases[VERTEX_LATENCY_PHASE_NUM];
+  // queue depth of executor sampled when the vertex is dispatched
+  LatencyHistogram dispatch_queue_depth;
+  inline void Record(VertexLatencyPhase phase, uint64_t start_ustime, uint64_t end_ustime) {
+    phases[phase].Record(end_ustime > start_ustime ? end_ustime - start_ustime : 0);
+  }
+};
+
+struct VertexLatencySnapshot {
+  std::string cluster;
+  std::string graph;
+  std::string vertex;
+  HistogramSnapshot phases[VERTEX_LATENCY_PHASE_NUM];
+  HistogramSnapshot dispatch_queue_depth;
+
+  void Merge(const VertexLatencySnapshot& other);
+};
+
+std::string_view get_vertex_latency_phase_name(VertexLatencyPhase phase);
+
+}  // namespace didagle